@@ -7,6 +7,10 @@ WALLPIN_DIR="/home/kalytheos/Documents/Proyectos/WallPin"
 LOG_FILE="/tmp/wallpin.log"
 PID_DIR="/tmp/wallpin_pids"
 DEFAULT_FPS=60
+EXTRA_ARGS=""   # Flags sin valor que se pasan tal cual a wallpin-wallpaper (ej: --low-power)
+NO_SHARD=""     # --no-shard: todos los monitores muestran la colección completa
+SHARD_PARAM=""  # --shard i/n del monitor que se está iniciando (lo rellena start_all)
+SPAN=""         # --span: start-all lanza un solo proceso con un lienzo continuo (PID "span")
 
 # Crear directorio para PIDs si no existe
 mkdir -p "$PID_DIR"
@@ -25,12 +29,25 @@ show_help() {
     echo "  restart-all [-f fps] [-s speed] [-c mode] [-t tolerance]       - Restart on all monitors"
     echo "  status                                                         - Show the status of all monitors"
     echo "  list-monitors                                                  - List available monitors"
+    echo "  set [monitor] [action] [value]                                 - Change a running instance live"
+    echo "  set-all [action] [value]                                       - Change all running instances live"
+    echo ""
+    echo "Live actions (no restart, no rescan):"
+    echo "  speed [1.0-100.0] | fps [30-500|auto] | pause | resume"
+    echo "  reorder [sorted|reverse|shuffle] | color-mode [1-5] | color-tolerance [10-100]"
+    echo "  reload [directory]               - Only this one rescans and decodes again"
+    echo "  swap [directory] | swap-cut [directory] - Rescan in the background, then switch (crossfade / cut)"
     echo ""
     echo "Options:"
-    echo "  -f, --fps [30-500]               - Set FPS (default: 60)"
+    echo "  -f, --fps [30-500|auto]          - Set FPS (default: 60; auto = adaptive)"
     echo "  -s, --speed [1.0-100.0]          - Set speed in px/s (default: 18.0)"
     echo "  -c, --color-mode [1-5]           - Color organization mode (default: 1)"
     echo "  -t, --color-tolerance [10-100]   - Color tolerance (default: 50)"
+    echo "  --stats                          - Record frame timing stats (shown by 'status')"
+    echo "  --low-power                      - Pre-composited columns, minimal CPU per frame"
+    echo "  --baked-tiles                    - Corners and shadow baked into tile pixels"
+    echo "  --no-shard                       - start-all: every monitor shows the whole collection"
+    echo "  --span                           - start-all: one process, one canvas across all monitors"
     echo ""
     echo "Color Modes:"
     echo "  1 - Normal (no color grouping)"
@@ -65,6 +82,8 @@ show_help() {
     echo "  $0 start HDMI-A-1 -c 2 -t 60            # Dominant color mode, tolerance 60"
     echo "  $0 start-all -c 4 -t 30 -f 120          # Hue mode, strict tolerance, 120 FPS"
     echo "  $0 start HDMI-A-1 120 25.0              # Also supports positional syntax"
+    echo "  $0 set HDMI-A-1 speed 30                # Live speed change"
+    echo "  $0 set-all color-mode 4                 # Live re-sort by hue on every monitor"
     echo ""
 }
 
@@ -90,8 +109,13 @@ check_monitor_status() {
     local monitor="$1"
     local pid_file="$PID_DIR/wallpin_${monitor}.pid"
     
+    local stats_file="$PID_DIR/wallpin_${monitor}.stats"
+    
     if [[ -f "$pid_file" ]] && kill -0 "$(cat "$pid_file")" 2>/dev/null; then
         echo "$monitor: WallPin ejecutándose (PID: $(cat "$pid_file"))"
+        if [[ -f "$stats_file" ]]; then
+            show_monitor_stats "$stats_file"
+        fi
         return 0
     else
         echo "$monitor: WallPin no está ejecutándose"
@@ -100,6 +124,17 @@ check_monitor_status() {
     fi
 }
 
+# Función para mostrar las estadísticas de frames escritas por --stats-file
+show_monitor_stats() {
+    local stats_file="$1"
+    awk -F= '
+        { v[$1] = $2 }
+        END {
+            printf "    %s fps | wakeups: %s/s | vblanks perdidos: %s (total %s)\n", v["fps"], v["wakeups_per_sec"], v["missed_vblanks"], v["total_missed_vblanks"]
+            printf "    frame p50/p99: %s/%s ms | tick->present p50/p99: %s/%s ms\n", v["frame_p50_ms"], v["frame_p99_ms"], v["tick_to_present_p50_ms"], v["tick_to_present_p99_ms"]
+        }' "$stats_file"
+}
+
 # Función para verificar estado de todos los monitores
 check_status() {
     echo "Estado de WallPin en todos los monitores:"
@@ -114,6 +149,73 @@ check_status() {
     while IFS= read -r monitor; do
         check_monitor_status "$monitor"
     done <<< "$monitors"
+    if [[ -f "$PID_DIR/wallpin_span.pid" ]]; then
+        check_monitor_status "span"
+    fi
+}
+
+# Función para enviar una acción en caliente a una instancia (acciones GApplication por D-Bus)
+control_monitor() {
+    local monitor="$1"
+    local action="$2"
+    local value="$3"
+    local pid_file="$PID_DIR/wallpin_${monitor}.pid"
+    local app_id="org.gtk.wallpin.wallpaper_${monitor//[-:]/_}"
+    local param=""
+    
+    if [[ ! -f "$pid_file" ]] || ! kill -0 "$(cat "$pid_file")" 2>/dev/null; then
+        echo "$monitor: WallPin no está ejecutándose"
+        return 1
+    fi
+    
+    case "$action" in
+        speed)
+            if [[ ! "$value" =~ ^[0-9]+\.?[0-9]*$ ]]; then
+                echo "Error: speed requiere un número (1.0-100.0)"
+                return 1
+            fi
+            # GVariant necesita punto decimal para un double
+            [[ "$value" == *.* ]] || value="$value.0"
+            param="$value"
+            ;;
+        fps|color-mode|color-tolerance)
+            [[ "$action" == "fps" && "$value" == "auto" ]] && value=0
+            if [[ ! "$value" =~ ^[0-9]+$ ]]; then
+                echo "Error: $action requiere un número entero"
+                return 1
+            fi
+            param="$value"
+            ;;
+        reorder|reload|swap|swap-cut)
+            # Cadena GVariant entre comillas simples: \ y ' dentro de la ruta van escapados
+            local quoted="${value//\\/\\\\}"
+            quoted="${quoted//\'/\\\'}"
+            param="'$quoted'"
+            ;;
+        pause|resume)
+            ;;
+        *)
+            echo "Error: acción desconocida '$action'"
+            return 1
+            ;;
+    esac
+    
+    if [[ -n "$param" ]]; then
+        gapplication action "$app_id" "$action" "$param"
+    else
+        gapplication action "$app_id" "$action"
+    fi && echo "$monitor: $action $value"
+}
+
+# Función para enviar una acción en caliente a todas las instancias
+control_all() {
+    for pid_file in "$PID_DIR"/wallpin_*.pid; do
+        if [[ -f "$pid_file" ]]; then
+            local monitor
+            monitor=$(basename "$pid_file" .pid | sed 's/wallpin_//')
+            control_monitor "$monitor" "$@"
+        fi
+    done
 }
 
 # Función para iniciar wallpaper en un monitor específico
@@ -123,7 +225,9 @@ start_monitor() {
     local speed="$3"
     local color_mode="$4"
     local color_tolerance="$5"
+    local stats="$6"
     local pid_file="$PID_DIR/wallpin_${monitor}.pid"
+    local stats_file="$PID_DIR/wallpin_${monitor}.stats"
     
     # Usar FPS por defecto si no se especifica
     if [[ -z "$fps" ]]; then
@@ -131,7 +235,9 @@ start_monitor() {
     fi
     
     # Validar FPS
-    if [[ ! "$fps" =~ ^[0-9]+$ ]] || [[ "$fps" -lt 30 ]] || [[ "$fps" -gt 500 ]]; then
+    if [[ "$fps" == "auto" ]]; then
+        :
+    elif [[ ! "$fps" =~ ^[0-9]+$ ]] || [[ "$fps" -lt 30 ]] || [[ "$fps" -gt 500 ]]; then
         echo "Error: FPS debe ser un número entre 30 y 500. Usando $DEFAULT_FPS FPS"
         fps="$DEFAULT_FPS"
     fi
@@ -174,6 +280,12 @@ start_monitor() {
         fi
     fi
     
+    # Estadísticas de frames para 'status'
+    local stats_param=""
+    if [[ -n "$stats" ]]; then
+        stats_param="--stats-file $stats_file"
+    fi
+    
     # Verificar si ya está ejecutándose
     if [[ -f "$pid_file" ]] && kill -0 "$(cat "$pid_file")" 2>/dev/null; then
         echo "WallPin ya está ejecutándose en $monitor"
@@ -211,7 +323,11 @@ start_monitor() {
     echo "=== WallPin iniciado en $monitor con $config_msg $(date) ===" >> "$LOG_FILE"
     
     # Ejecutar wallpaper en background para el monitor específico
-    nohup ./build/wallpin-wallpaper --monitor "$monitor" --fps "$fps" $speed_param $color_param $tolerance_param >> "$LOG_FILE" 2>&1 &
+    local target_param=(--monitor "$monitor")
+    if [[ "$monitor" == "span" ]]; then
+        target_param=(--span)   # Un solo proceso para todos los monitores
+    fi
+    nohup ./build/wallpin-wallpaper "${target_param[@]}" --fps "$fps" $speed_param $color_param $tolerance_param $stats_param $SHARD_PARAM $EXTRA_ARGS >> "$LOG_FILE" 2>&1 &
     
     # Guardar PID
     echo $! > "$pid_file"
@@ -236,6 +352,7 @@ start_all() {
     local speed="$2"
     local color_mode="$3"
     local color_tolerance="$4"
+    local stats="$5"
     echo " Iniciando WallPin en todos los monitores..."
     local monitors
     monitors=$(get_monitors)
@@ -245,8 +362,23 @@ start_all() {
         return 1
     fi
     
+    # Lienzo continuo: un proceso con una ventana por monitor, sin reparto de la colección
+    if [[ -n "$SPAN" ]]; then
+        start_monitor "span" "$fps" "$speed" "$color_mode" "$color_tolerance" "$stats"
+        return
+    fi
+
+    # Con varios monitores cada uno se queda con una parte de la colección: menos trabajo
+    # y memoria por proceso, y paredes distintas en cada pantalla
+    local count index=0
+    count=$(wc -l <<< "$monitors")
     while IFS= read -r monitor; do
-        start_monitor "$monitor" "$fps" "$speed" "$color_mode" "$color_tolerance"
+        if [[ -z "$NO_SHARD" && "$count" -gt 1 ]]; then
+            SHARD_PARAM="--shard $index/$count"
+        fi
+        start_monitor "$monitor" "$fps" "$speed" "$color_mode" "$color_tolerance" "$stats"
+        SHARD_PARAM=""
+        index=$((index + 1))
         sleep 1  # Pequeña pausa entre monitores
     done <<< "$monitors"
 }
@@ -266,7 +398,7 @@ stop_monitor() {
         else
             echo "  Proceso no encontrado, limpiando PID file"
         fi
-        rm -f "$pid_file"
+        rm -f "$pid_file" "$PID_DIR/wallpin_${monitor}.stats"
     else
         echo " WallPin no estaba ejecutándose en $monitor"
     fi
@@ -297,9 +429,10 @@ restart_monitor() {
     local speed="$3"
     local color_mode="$4"
     local color_tolerance="$5"
+    local stats="$6"
     stop_monitor "$monitor"
     sleep 1
-    start_monitor "$monitor" "$fps" "$speed" "$color_mode" "$color_tolerance"
+    start_monitor "$monitor" "$fps" "$speed" "$color_mode" "$color_tolerance" "$stats"
 }
 
 # Función para reiniciar todos
@@ -308,9 +441,10 @@ restart_all() {
     local speed="$2"
     local color_mode="$3"
     local color_tolerance="$4"
+    local stats="$5"
     stop_all
     sleep 2
-    start_all "$fps" "$speed" "$color_mode" "$color_tolerance"
+    start_all "$fps" "$speed" "$color_mode" "$color_tolerance" "$stats"
 }
 
 # Función para parsear argumentos con flags
@@ -322,6 +456,7 @@ parse_args() {
     local speed=""
     local color_mode=""
     local color_tolerance=""
+    local stats=""
     local monitor=""
     local remaining_args=()
     
@@ -344,6 +479,26 @@ parse_args() {
                 color_tolerance="$2"
                 shift 2
                 ;;
+            --stats)
+                stats="1"
+                shift
+                ;;
+            --low-power)
+                EXTRA_ARGS="$EXTRA_ARGS --low-power"
+                shift
+                ;;
+            --baked-tiles)
+                EXTRA_ARGS="$EXTRA_ARGS --baked-tiles"
+                shift
+                ;;
+            --no-shard)
+                NO_SHARD="1"
+                shift
+                ;;
+            --span)
+                SPAN="1"
+                shift
+                ;;
             *)
                 remaining_args+=("$1")
                 shift
@@ -374,7 +529,7 @@ parse_args() {
     case "$command" in
         "start")
             if [[ -n "$monitor" ]]; then
-                start_monitor "$monitor" "$fps" "$speed" "$color_mode" "$color_tolerance"
+                start_monitor "$monitor" "$fps" "$speed" "$color_mode" "$color_tolerance" "$stats"
             else
                 echo " Error: Especifica un monitor"
                 echo "Uso: $0 start <monitor> [-f fps] [-s speed] [-c mode] [-t tolerance]"
@@ -384,11 +539,11 @@ parse_args() {
             fi
             ;;
         "start-all")
-            start_all "$fps" "$speed" "$color_mode" "$color_tolerance"
+            start_all "$fps" "$speed" "$color_mode" "$color_tolerance" "$stats"
             ;;
         "restart")
             if [[ -n "$monitor" ]]; then
-                restart_monitor "$monitor" "$fps" "$speed" "$color_mode" "$color_tolerance"
+                restart_monitor "$monitor" "$fps" "$speed" "$color_mode" "$color_tolerance" "$stats"
             else
                 echo " Error: Especifica un monitor"
                 echo "Uso: $0 restart <monitor> [-f fps] [-s speed] [-c mode] [-t tolerance]"
@@ -396,7 +551,7 @@ parse_args() {
             fi
             ;;
         "restart-all")
-            restart_all "$fps" "$speed" "$color_mode" "$color_tolerance"
+            restart_all "$fps" "$speed" "$color_mode" "$color_tolerance" "$stats"
             ;;
     esac
 }
@@ -433,6 +588,24 @@ case "$1" in
     "list-monitors")
         list_monitors
         ;;
+    "set")
+        if [[ -n "$2" && -n "$3" ]]; then
+            control_monitor "$2" "$3" "$4"
+        else
+            echo " Error: Especifica un monitor y una acción"
+            echo "Uso: $0 set <monitor> <acción> [valor]"
+            exit 1
+        fi
+        ;;
+    "set-all")
+        if [[ -n "$2" ]]; then
+            control_all "$2" "$3"
+        else
+            echo " Error: Especifica una acción"
+            echo "Uso: $0 set-all <acción> [valor]"
+            exit 1
+        fi
+        ;;
     "help" | "--help" | "-h")
         show_help
         ;;
@@ -0,0 +1,135 @@
+#include "alloc_stats.h"
+#include <stdio.h>
+#include <unistd.h>
+
+gboolean alloc_stats_enabled = FALSE;
+
+typedef struct {
+    gint64 live;
+    gint64 peak;
+    guint64 allocations;
+    guint64 allocated_bytes;
+    // Al último volcado, para el ritmo y la variación
+    gint64 dumped_live;
+    guint64 dumped_allocations;
+    guint64 dumped_bytes;
+} AllocCounters;
+
+typedef struct {
+    AllocSubsystem subsystem;
+    gsize bytes;
+} TrackedObject;
+
+static const char *subsystem_names[ALLOC_SUBSYSTEMS] = {
+    "scan", "layout", "color", "decode", "textures", "widgets"
+};
+
+static struct {
+    GMutex lock;               // Los hilos de decodificación y prefetch también anotan
+    AllocCounters counters[ALLOC_SUBSYSTEMS];
+    gint64 dumped_at;
+    guint timer_id;
+} alloc;
+
+void alloc_stats_add(AllocSubsystem subsystem, gssize bytes) {
+    g_mutex_lock(&alloc.lock);
+    AllocCounters *counters = &alloc.counters[subsystem];
+    counters->live += bytes;
+    if (bytes > 0) {
+        counters->allocations++;
+        counters->allocated_bytes += bytes;
+        counters->peak = MAX(counters->peak, counters->live);
+    }
+    g_mutex_unlock(&alloc.lock);
+}
+
+static void on_object_finalized(gpointer data, G_GNUC_UNUSED GObject *where_the_object_was) {
+    TrackedObject *tracked = data;
+    alloc_stats_add(tracked->subsystem, -(gssize)tracked->bytes);
+    g_free(tracked);
+}
+
+void alloc_stats_track_object(AllocSubsystem subsystem, GObject *object, gsize bytes) {
+    if (!object || bytes == 0) return;
+
+    TrackedObject *tracked = g_new(TrackedObject, 1);
+    tracked->subsystem = subsystem;
+    tracked->bytes = bytes;
+    alloc_stats_add(subsystem, (gssize)bytes);
+    g_object_weak_ref(object, on_object_finalized, tracked);
+}
+
+gsize alloc_stats_instance_size(gpointer object) {
+    GTypeQuery query;
+    g_type_query(G_OBJECT_TYPE(object), &query);
+    return query.instance_size;
+}
+
+// RSS del proceso, para comparar con lo contabilizado
+static double resident_mb(void) {
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (!file) return 0.0;
+
+    unsigned long size = 0, resident = 0;
+    int read = fscanf(file, "%lu %lu", &size, &resident);
+    fclose(file);
+    return read == 2 ? resident * (double)sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0) : 0.0;
+}
+
+void alloc_stats_print(const char *reason) {
+    if (!alloc_stats_enabled) {
+        g_print("📊 Contabilidad de memoria desactivada (usa --stats)\n");
+        return;
+    }
+
+    g_mutex_lock(&alloc.lock);
+    gint64 now = g_get_monotonic_time();
+    double seconds = MAX((now - alloc.dumped_at) / (double)G_USEC_PER_SEC, 1e-3);
+    double total_mb = 0.0;
+
+    g_print("📊 Memoria por subsistema (%s):\n", reason);
+    g_print("   %-9s %10s %10s %10s %12s %10s\n", "", "vivo MB", "pico MB", "Δ MB", "asign./s", "MB/s");
+    for (int i = 0; i < ALLOC_SUBSYSTEMS; i++) {
+        AllocCounters *c = &alloc.counters[i];
+        g_print("   %-9s %10.2f %10.2f %+10.2f %12.1f %10.2f\n", subsystem_names[i],
+                c->live / (1024.0 * 1024.0), c->peak / (1024.0 * 1024.0),
+                (c->live - c->dumped_live) / (1024.0 * 1024.0),
+                (c->allocations - c->dumped_allocations) / seconds,
+                (c->allocated_bytes - c->dumped_bytes) / (1024.0 * 1024.0) / seconds);
+        total_mb += c->live / (1024.0 * 1024.0);
+
+        c->dumped_live = c->live;
+        c->dumped_allocations = c->allocations;
+        c->dumped_bytes = c->allocated_bytes;
+    }
+    alloc.dumped_at = now;
+    g_mutex_unlock(&alloc.lock);
+
+    g_print("   Total contabilizado %.2f MB | RSS %.1f MB\n", total_mb, resident_mb());
+}
+
+static gboolean alloc_stats_tick(G_GNUC_UNUSED gpointer user_data) {
+    alloc_stats_print("periódico");
+    return G_SOURCE_CONTINUE;
+}
+
+void alloc_stats_enable(gboolean print_periodically) {
+    if (alloc_stats_enabled) return;
+
+    alloc.dumped_at = g_get_monotonic_time();
+    if (print_periodically) {
+        alloc.timer_id = g_timeout_add_seconds(ALLOC_STATS_INTERVAL_SECONDS, alloc_stats_tick, NULL);
+    }
+    alloc_stats_enabled = TRUE;
+}
+
+void alloc_stats_shutdown(void) {
+    if (!alloc_stats_enabled) return;
+
+    if (alloc.timer_id > 0) {
+        g_source_remove(alloc.timer_id);
+        alloc.timer_id = 0;
+    }
+    // Con todo liberado, lo que quede vivo es una fuga (o algo sin anotar al soltarlo)
+    alloc_stats_print("al salir");
+}
@@ -0,0 +1,42 @@
+#ifndef ALLOC_STATS_H
+#define ALLOC_STATS_H
+
+#include <glib-object.h>
+
+// Contabilidad de memoria por subsistema: bytes vivos, pico, asignaciones por segundo y
+// variación entre volcados. Se anota en los puntos donde cada subsistema toma o suelta
+// la propiedad de algo (no es un malloc interpuesto), así que cuenta lo que el programa
+// retiene, no la fragmentación del heap. Desactivada por defecto (--stats); volcado
+// periódico con --stats, a demanda con SIGUSR1 y al salir, ya todo liberado, para ver fugas.
+typedef enum {
+    ALLOC_SCAN,        // Rutas en lotes del scanner
+    ALLOC_LAYOUT,      // ImageInfo, rutas y nodos del layout
+    ALLOC_COLOR,       // Cachés de color y de hash perceptual
+    ALLOC_DECODE,      // Bytes leídos por adelantado y miniaturas de la ingesta
+    ALLOC_TEXTURES,    // Píxeles de GdkTexture vivas (tiles y segmentos del strip)
+    ALLOC_WIDGETS,     // Instancias de widgets de tile
+    ALLOC_SUBSYSTEMS
+} AllocSubsystem;
+
+#define ALLOC_STATS_INTERVAL_SECONDS 60
+
+extern gboolean alloc_stats_enabled;
+
+// Único coste en el camino caliente cuando está desactivada: una rama
+#define ALLOC_STATS_ADD(subsystem, bytes) \
+    do { if (G_UNLIKELY(alloc_stats_enabled)) alloc_stats_add((subsystem), (gssize)(bytes)); } while (0)
+#define ALLOC_STATS_SUB(subsystem, bytes) \
+    do { if (G_UNLIKELY(alloc_stats_enabled)) alloc_stats_add((subsystem), -(gssize)(bytes)); } while (0)
+// Cuenta bytes hasta que el objeto se finaliza (desde cualquier hilo)
+#define ALLOC_STATS_TRACK(subsystem, object, bytes) \
+    do { if (G_UNLIKELY(alloc_stats_enabled)) alloc_stats_track_object((subsystem), G_OBJECT(object), (bytes)); } while (0)
+
+void alloc_stats_enable(gboolean print_periodically);
+void alloc_stats_add(AllocSubsystem subsystem, gssize bytes);
+void alloc_stats_track_object(AllocSubsystem subsystem, GObject *object, gsize bytes);
+// Tamaño de la instancia (sin datos privados ni hijos): estimación mínima para widgets
+gsize alloc_stats_instance_size(gpointer object);
+void alloc_stats_print(const char *reason);
+void alloc_stats_shutdown(void);
+
+#endif // ALLOC_STATS_H
@@ -0,0 +1,173 @@
+#include "bench_corpus.h"
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+#define OUTLIER_WIDTH 7680
+#define OUTLIER_HEIGHT 4320
+#define CORPUS_STAMP ".corpus-complete"
+
+// Proporciones mezcladas: verticales, cuadradas, horizontales y panorámicas
+static const double corpus_aspect_ratios[] = {
+    9.0 / 16.0, 2.0 / 3.0, 3.0 / 4.0, 1.0, 4.0 / 3.0, 3.0 / 2.0, 16.0 / 9.0, 21.0 / 9.0
+};
+
+// Lado largo de las imágenes normales (la mayoría pequeñas para que 100k quepan en disco)
+static const int corpus_long_edges[] = { 480, 640, 960, 1280, 1920 };
+
+static void fill_synthetic_pixels(GdkPixbuf *pixbuf, GRand *rand) {
+    int width = gdk_pixbuf_get_width(pixbuf);
+    int height = gdk_pixbuf_get_height(pixbuf);
+    int channels = gdk_pixbuf_get_n_channels(pixbuf);
+    int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+    guchar *pixels = gdk_pixbuf_get_pixels(pixbuf);
+
+    // Degradado vertical entre dos colores aleatorios
+    guchar top[3], bottom[3];
+    for (int c = 0; c < 3; c++) {
+        top[c] = g_rand_int_range(rand, 0, 256);
+        bottom[c] = g_rand_int_range(rand, 0, 256);
+    }
+
+    for (int y = 0; y < height; y++) {
+        double t = height > 1 ? (double)y / (height - 1) : 0.0;
+        guchar *row = pixels + (gsize)y * rowstride;
+        for (int x = 0; x < width; x++) {
+            guchar *p = row + x * channels;
+            // Algo de textura horizontal para que el JPEG no sea trivial
+            int ripple = ((x * 7 + y * 3) & 31) - 16;
+            for (int c = 0; c < 3; c++) {
+                int v = (int)(top[c] + (bottom[c] - top[c]) * t) + ripple;
+                p[c] = CLAMP(v, 0, 255);
+            }
+        }
+    }
+
+    // Bloques de color para dar un color dominante variado
+    int blocks = g_rand_int_range(rand, 2, 6);
+    for (int b = 0; b < blocks; b++) {
+        int bw = g_rand_int_range(rand, width / 8 + 1, width / 2 + 2);
+        int bh = g_rand_int_range(rand, height / 8 + 1, height / 2 + 2);
+        int bx = g_rand_int_range(rand, 0, MAX(1, width - bw));
+        int by = g_rand_int_range(rand, 0, MAX(1, height - bh));
+        guchar color[3] = {
+            g_rand_int_range(rand, 0, 256),
+            g_rand_int_range(rand, 0, 256),
+            g_rand_int_range(rand, 0, 256)
+        };
+        for (int y = by; y < MIN(height, by + bh); y++) {
+            guchar *row = pixels + (gsize)y * rowstride;
+            for (int x = bx; x < MIN(width, bx + bw); x++) {
+                memcpy(row + x * channels, color, 3);
+            }
+        }
+    }
+}
+
+static gboolean write_synthetic_image(const char *path, int width, int height,
+                                      gboolean png, GRand *rand, GError **error) {
+    GdkPixbuf *pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, width, height);
+    if (!pixbuf) {
+        g_set_error(error, g_quark_from_static_string("bench-corpus"), 0,
+                    "No se pudo reservar %dx%d", width, height);
+        return FALSE;
+    }
+
+    fill_synthetic_pixels(pixbuf, rand);
+
+    gboolean ok = png
+        ? gdk_pixbuf_save(pixbuf, path, "png", error, "compression", "3", NULL)
+        : gdk_pixbuf_save(pixbuf, path, "jpeg", error, "quality", "85", NULL);
+    g_object_unref(pixbuf);
+    return ok;
+}
+
+static gboolean corpus_is_complete(const char *dir, const BenchCorpusSpec *spec) {
+    char *stamp_path = g_build_filename(dir, CORPUS_STAMP, NULL);
+    char *contents = NULL;
+    gboolean complete = FALSE;
+
+    if (g_file_get_contents(stamp_path, &contents, NULL, NULL)) {
+        char *expected = g_strdup_printf("%d %d %.3f %u\n", spec->file_count,
+                                         spec->outlier_count, spec->png_ratio, spec->seed);
+        complete = g_strcmp0(contents, expected) == 0;
+        g_free(expected);
+        g_free(contents);
+    }
+
+    g_free(stamp_path);
+    return complete;
+}
+
+char *bench_corpus_ensure(const char *base_dir, const BenchCorpusSpec *spec) {
+    char *name = g_strdup_printf("n%d-o%d-s%u", spec->file_count, spec->outlier_count, spec->seed);
+    char *dir = g_build_filename(base_dir, name, NULL);
+    g_free(name);
+
+    if (corpus_is_complete(dir, spec)) {
+        g_printerr("♻️  Reutilizando corpus %s\n", dir);
+        return dir;
+    }
+
+    if (g_mkdir_with_parents(dir, 0755) != 0) {
+        g_printerr("Error creando directorio de corpus: %s\n", dir);
+        g_free(dir);
+        return NULL;
+    }
+
+    g_printerr("🧪 Generando corpus sintético: %d imágenes (%d outliers 8K) en %s\n",
+               spec->file_count, spec->outlier_count, dir);
+
+    GRand *rand = g_rand_new_with_seed(spec->seed);
+    // Los outliers se reparten por la colección en vez de ir todos al final
+    int outlier_stride = spec->outlier_count > 0 ? MAX(1, spec->file_count / spec->outlier_count) : 0;
+    int outliers_written = 0;
+
+    for (int i = 0; i < spec->file_count; i++) {
+        gboolean png = g_rand_double(rand) < spec->png_ratio;
+        int width, height;
+
+        if (outlier_stride > 0 && outliers_written < spec->outlier_count && i % outlier_stride == outlier_stride / 2) {
+            width = OUTLIER_WIDTH;
+            height = OUTLIER_HEIGHT;
+            outliers_written++;
+        } else {
+            double ratio = corpus_aspect_ratios[g_rand_int_range(rand, 0, G_N_ELEMENTS(corpus_aspect_ratios))];
+            int long_edge = corpus_long_edges[g_rand_int_range(rand, 0, G_N_ELEMENTS(corpus_long_edges))];
+            if (ratio >= 1.0) {
+                width = long_edge;
+                height = MAX(1, (int)(long_edge / ratio + 0.5));
+            } else {
+                height = long_edge;
+                width = MAX(1, (int)(long_edge * ratio + 0.5));
+            }
+        }
+
+        char file_name[64];
+        snprintf(file_name, sizeof(file_name), "wall_%06d.%s", i + 1, png ? "png" : "jpg");
+        char *path = g_build_filename(dir, file_name, NULL);
+
+        GError *error = NULL;
+        if (!write_synthetic_image(path, width, height, png, rand, &error)) {
+            g_printerr("Error escribiendo %s: %s\n", path, error ? error->message : "desconocido");
+            g_clear_error(&error);
+            g_free(path);
+            g_rand_free(rand);
+            g_free(dir);
+            return NULL;
+        }
+        g_free(path);
+
+        if ((i + 1) % 1000 == 0 || i + 1 == spec->file_count) {
+            g_printerr("   Generadas: %d/%d\n", i + 1, spec->file_count);
+        }
+    }
+    g_rand_free(rand);
+
+    char *stamp_path = g_build_filename(dir, CORPUS_STAMP, NULL);
+    char *stamp = g_strdup_printf("%d %d %.3f %u\n", spec->file_count,
+                                  spec->outlier_count, spec->png_ratio, spec->seed);
+    g_file_set_contents(stamp_path, stamp, -1, NULL);
+    g_free(stamp);
+    g_free(stamp_path);
+
+    return dir;
+}
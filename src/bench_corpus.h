@@ -0,0 +1,18 @@
+#ifndef BENCH_CORPUS_H
+#define BENCH_CORPUS_H
+
+#include <glib.h>
+
+// Generador de colecciones sintéticas para los benchmarks (sin display)
+typedef struct {
+    int file_count;      // Número total de archivos
+    int outlier_count;   // Imágenes 8K incluidas en el total
+    double png_ratio;    // Fracción de archivos PNG (el resto JPEG)
+    guint32 seed;        // Semilla para que el corpus sea reproducible
+} BenchCorpusSpec;
+
+// Crea (o reutiliza si ya está completo) el corpus en base_dir.
+// Devuelve la ruta del directorio generado o NULL si hubo error.
+char *bench_corpus_ensure(const char *base_dir, const BenchCorpusSpec *spec);
+
+#endif // BENCH_CORPUS_H
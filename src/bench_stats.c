@@ -0,0 +1,84 @@
+#include "bench_stats.h"
+#include <math.h>
+
+BenchSamples *bench_samples_new(const char *name) {
+    BenchSamples *samples = g_new0(BenchSamples, 1);
+    samples->name = g_strdup(name);
+    samples->values = g_array_new(FALSE, FALSE, sizeof(double));
+    samples->sorted = TRUE;
+    return samples;
+}
+
+void bench_samples_add(BenchSamples *samples, double value_us) {
+    g_array_append_val(samples->values, value_us);
+    samples->sorted = FALSE;
+}
+
+void bench_samples_add_since(BenchSamples *samples, gint64 start_us) {
+    bench_samples_add(samples, (double)(g_get_monotonic_time() - start_us));
+}
+
+void bench_samples_reset(BenchSamples *samples) {
+    g_array_set_size(samples->values, 0);
+    samples->sorted = TRUE;
+}
+
+static gint compare_doubles(gconstpointer a, gconstpointer b) {
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+// Percentil con interpolación lineal entre rangos vecinos (percentile en 0-100)
+double bench_samples_percentile(BenchSamples *samples, double percentile) {
+    guint n = samples->values->len;
+    if (n == 0) return 0.0;
+
+    if (!samples->sorted) {
+        g_array_sort(samples->values, compare_doubles);
+        samples->sorted = TRUE;
+    }
+
+    double rank = CLAMP(percentile, 0.0, 100.0) / 100.0 * (n - 1);
+    guint lower = (guint)floor(rank);
+    guint upper = MIN(lower + 1, n - 1);
+    double fraction = rank - lower;
+    double lo = g_array_index(samples->values, double, lower);
+    double hi = g_array_index(samples->values, double, upper);
+    return lo + (hi - lo) * fraction;
+}
+
+double bench_samples_total(BenchSamples *samples) {
+    double total = 0.0;
+    for (guint i = 0; i < samples->values->len; i++) {
+        total += g_array_index(samples->values, double, i);
+    }
+    return total;
+}
+
+double bench_samples_mean(BenchSamples *samples) {
+    if (samples->values->len == 0) return 0.0;
+    return bench_samples_total(samples) / samples->values->len;
+}
+
+void bench_samples_append_json(BenchSamples *samples, GString *out, const char *indent) {
+    g_string_append_printf(out,
+        "%s\"%s\": {\"count\": %u, \"min\": %.1f, \"p50\": %.1f, \"p90\": %.1f, "
+        "\"p99\": %.1f, \"max\": %.1f, \"mean\": %.1f, \"total\": %.1f}",
+        indent, samples->name, samples->values->len,
+        bench_samples_percentile(samples, 0.0),
+        bench_samples_percentile(samples, 50.0),
+        bench_samples_percentile(samples, 90.0),
+        bench_samples_percentile(samples, 99.0),
+        bench_samples_percentile(samples, 100.0),
+        bench_samples_mean(samples),
+        bench_samples_total(samples));
+}
+
+void bench_samples_free(BenchSamples *samples) {
+    if (samples) {
+        g_array_free(samples->values, TRUE);
+        g_free(samples->name);
+        g_free(samples);
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef BENCH_STATS_H
+#define BENCH_STATS_H
+
+#include <glib.h>
+
+// Colección de muestras de tiempo (en microsegundos) para una etapa del benchmark
+typedef struct {
+    char *name;
+    GArray *values;     // double, microsegundos
+    gboolean sorted;
+} BenchSamples;
+
+BenchSamples *bench_samples_new(const char *name);
+void bench_samples_add(BenchSamples *samples, double value_us);
+void bench_samples_add_since(BenchSamples *samples, gint64 start_us);
+void bench_samples_reset(BenchSamples *samples);
+double bench_samples_percentile(BenchSamples *samples, double percentile);
+double bench_samples_mean(BenchSamples *samples);
+double bench_samples_total(BenchSamples *samples);
+void bench_samples_append_json(BenchSamples *samples, GString *out, const char *indent);
+void bench_samples_free(BenchSamples *samples);
+
+#endif // BENCH_STATS_H
@@ -1,4 +1,6 @@
 #include "color_analysis.h"
+#include "decode_budget.h"
+#include "jpeg_decode.h"
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
@@ -78,13 +80,36 @@ Color get_average_color(GdkPixbuf *pixbuf) {
     return color;
 }
 
+// JPEG por libjpeg-turbo: basta la menor escala DCT que cubre 100×100 para el promedio
+static gboolean extract_jpeg_color(const char *image_path, Color *color) {
+    const char *ext = strrchr(image_path, '.');
+    if (!jpeg_decode_available() || !ext ||
+        (g_ascii_strcasecmp(ext, ".jpg") != 0 && g_ascii_strcasecmp(ext, ".jpeg") != 0)) {
+        return FALSE;
+    }
+
+    GMappedFile *mapped = g_mapped_file_new(image_path, FALSE, NULL);
+    if (!mapped) return FALSE;
+    GBytes *bytes = g_mapped_file_get_bytes(mapped);
+    GdkPixbuf *view = jpeg_decode_view(bytes, 100, 100, NULL, NULL);
+    g_bytes_unref(bytes);
+    g_mapped_file_unref(mapped);
+    if (!view) return FALSE;
+
+    *color = get_average_color(view);
+    g_object_unref(view);
+    return TRUE;
+}
+
 // Extraer color dominante de una imagen
 Color extract_dominant_color(const char *image_path) {
     GError *error = NULL;
     Color default_color = {128, 128, 128, 0, 0, 0.5}; // Gris por defecto
+    Color jpeg_color;
+    if (extract_jpeg_color(image_path, &jpeg_color)) return jpeg_color;
     
     // Cargar imagen con tamaño reducido para eficiencia
-    GdkPixbuf *pixbuf = gdk_pixbuf_new_from_file_at_scale(image_path, 100, 100, TRUE, &error);
+    GdkPixbuf *pixbuf = decode_budget_load_file_at_scale(image_path, 100, 100, TRUE, &error);
     
     if (error) {
         g_warning("Error loading image for color analysis %s: %s", image_path, error->message);
@@ -170,46 +195,67 @@ void free_color_group(ColorGroup *group) {
     }
 }
 
-// Agrupar imágenes por color
-GList* group_images_by_color(GList *image_paths, ColorMode mode, int tolerance) {
-    GList *color_groups = NULL;
-    
-    g_print("🎨 Analizando colores de %d imágenes (modo: %d)...\n", g_list_length(image_paths), mode);
-    
-    int processed = 0;
-    int total = g_list_length(image_paths);
-    
-    for (GList *l = image_paths; l != NULL; l = l->next) {
+// Agrupar imágenes con colores ya extraídos (colors[i] corresponde al i-ésimo path)
+// Grupos en una GQueue y rutas con prepend (invertidas al final): nada recorre una lista
+// entera por imagen
+GList* group_images_by_precomputed_colors(GList *image_paths, const Color *colors, int tolerance) {
+    GQueue color_groups = G_QUEUE_INIT;
+    int index = 0;
+
+    for (GList *l = image_paths; l != NULL; l = l->next, index++) {
         const char *image_path = (const char *)l->data;
-        Color image_color = extract_dominant_color(image_path);
-        
-        processed++;
-        if (processed % 10 == 0 || processed == total) {
-            g_print("   Procesadas: %d/%d (%.1f%%)\n", processed, total, (processed * 100.0) / total);
-        }
-        
+        Color image_color = colors[index];
+
         // Buscar grupo existente con color similar
         ColorGroup *target_group = NULL;
-        for (GList *g = color_groups; g != NULL; g = g->next) {
+        for (GList *g = color_groups.head; g != NULL; g = g->next) {
             ColorGroup *group = (ColorGroup *)g->data;
             if (colors_similar(image_color, group->dominant_color, tolerance)) {
                 target_group = group;
                 break;
             }
         }
-        
+
         // Si no se encontró grupo similar, crear uno nuevo
         if (!target_group) {
             target_group = create_color_group(image_color);
-            color_groups = g_list_append(color_groups, target_group);
+            g_queue_push_tail(&color_groups, target_group);
         }
-        
+
         // Agregar imagen al grupo
-        target_group->image_paths = g_list_append(target_group->image_paths, g_strdup(image_path));
+        target_group->image_paths = g_list_prepend(target_group->image_paths, g_strdup(image_path));
     }
-    
+
+    for (GList *g = color_groups.head; g != NULL; g = g->next) {
+        ColorGroup *group = g->data;
+        group->image_paths = g_list_reverse(group->image_paths);
+    }
+    return color_groups.head;
+}
+
+// Agrupar imágenes por color
+GList* group_images_by_color(GList *image_paths, ColorMode mode, int tolerance) {
+    g_print("🎨 Analizando colores de %d imágenes (modo: %d)...\n", g_list_length(image_paths), mode);
+
+    int processed = 0;
+    int total = g_list_length(image_paths);
+    Color *colors = g_new(Color, MAX(total, 1));
+
+    for (GList *l = image_paths; l != NULL; l = l->next) {
+        const char *image_path = (const char *)l->data;
+        colors[processed] = extract_dominant_color(image_path);
+
+        processed++;
+        if (processed % 10 == 0 || processed == total) {
+            g_print("   Procesadas: %d/%d (%.1f%%)\n", processed, total, (processed * 100.0) / total);
+        }
+    }
+
+    GList *color_groups = group_images_by_precomputed_colors(image_paths, colors, tolerance);
+    g_free(colors);
+
     g_print("✅ Análisis completado: %d grupos de colores creados\n", g_list_length(color_groups));
-    
+
     return color_groups;
 }
 
@@ -35,6 +35,7 @@ char* get_color_name(Color color);
 ColorGroup* create_color_group(Color color);
 void free_color_group(ColorGroup *group);
 GList* group_images_by_color(GList *image_paths, ColorMode mode, int tolerance);
+GList* group_images_by_precomputed_colors(GList *image_paths, const Color *colors, int tolerance);
 void print_color_analysis(GList *color_groups);
 
 // Funciones de utilidad
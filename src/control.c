@@ -0,0 +1,95 @@
+#include "control.h"
+#include <string.h>
+
+static const WallpinControlOps *control_ops = NULL;
+
+static void on_speed(G_GNUC_UNUSED GSimpleAction *action, GVariant *parameter, G_GNUC_UNUSED gpointer user_data) {
+    double speed = g_variant_get_double(parameter);
+    g_print("🎛️  Control: speed %.1f\n", speed);
+    control_ops->set_speed(speed);
+}
+
+static void on_fps(G_GNUC_UNUSED GSimpleAction *action, GVariant *parameter, G_GNUC_UNUSED gpointer user_data) {
+    int fps = g_variant_get_int32(parameter);
+    g_print("🎛️  Control: fps %d\n", fps);
+    control_ops->set_fps(fps);
+}
+
+static void on_pause(G_GNUC_UNUSED GSimpleAction *action, G_GNUC_UNUSED GVariant *parameter, G_GNUC_UNUSED gpointer user_data) {
+    g_print("🎛️  Control: pause\n");
+    control_ops->set_paused(TRUE);
+}
+
+static void on_resume(G_GNUC_UNUSED GSimpleAction *action, G_GNUC_UNUSED GVariant *parameter, G_GNUC_UNUSED gpointer user_data) {
+    g_print("🎛️  Control: resume\n");
+    control_ops->set_paused(FALSE);
+}
+
+static void on_reorder(G_GNUC_UNUSED GSimpleAction *action, GVariant *parameter, G_GNUC_UNUSED gpointer user_data) {
+    const char *order = g_variant_get_string(parameter, NULL);
+    if (strcmp(order, "sorted") != 0 && strcmp(order, "reverse") != 0 && strcmp(order, "shuffle") != 0) {
+        g_print("⚠️  Control: orden desconocido '%s' (sorted, reverse, shuffle)\n", order);
+        return;
+    }
+    g_print("🎛️  Control: reorder %s\n", order);
+    control_ops->reorder(order);
+}
+
+static void on_color_mode(G_GNUC_UNUSED GSimpleAction *action, GVariant *parameter, G_GNUC_UNUSED gpointer user_data) {
+    int mode = g_variant_get_int32(parameter);
+    if (mode < 1 || mode > 5) {
+        g_print("⚠️  Control: modo de color fuera de rango (1-5): %d\n", mode);
+        return;
+    }
+    g_print("🎛️  Control: color-mode %d\n", mode);
+    control_ops->set_color_mode(mode, -1);
+}
+
+static void on_color_tolerance(G_GNUC_UNUSED GSimpleAction *action, GVariant *parameter, G_GNUC_UNUSED gpointer user_data) {
+    int tolerance = g_variant_get_int32(parameter);
+    if (tolerance < 10 || tolerance > 100) {
+        g_print("⚠️  Control: tolerancia fuera de rango (10-100): %d\n", tolerance);
+        return;
+    }
+    g_print("🎛️  Control: color-tolerance %d\n", tolerance);
+    control_ops->set_color_mode(-1, tolerance);
+}
+
+static void on_reload(G_GNUC_UNUSED GSimpleAction *action, GVariant *parameter, G_GNUC_UNUSED gpointer user_data) {
+    const char *directory = g_variant_get_string(parameter, NULL);
+    g_print("🎛️  Control: reload %s\n", directory[0] ? directory : "(mismo directorio)");
+    control_ops->reload(directory);
+}
+
+static void swap_collection(const char *action, GVariant *parameter, gboolean crossfade) {
+    const char *directory = g_variant_get_string(parameter, NULL);
+    g_print("🎛️  Control: %s %s\n", action, directory[0] ? directory : "(mismo directorio)");
+    control_ops->swap(directory, crossfade);
+}
+
+static void on_swap(G_GNUC_UNUSED GSimpleAction *action, GVariant *parameter, G_GNUC_UNUSED gpointer user_data) {
+    swap_collection("swap", parameter, TRUE);
+}
+
+static void on_swap_cut(G_GNUC_UNUSED GSimpleAction *action, GVariant *parameter, G_GNUC_UNUSED gpointer user_data) {
+    swap_collection("swap-cut", parameter, FALSE);
+}
+
+static const GActionEntry control_actions[] = {
+    { "speed", on_speed, "d", NULL, NULL, { 0 } },
+    { "fps", on_fps, "i", NULL, NULL, { 0 } },
+    { "pause", on_pause, NULL, NULL, NULL, { 0 } },
+    { "resume", on_resume, NULL, NULL, NULL, { 0 } },
+    { "reorder", on_reorder, "s", NULL, NULL, { 0 } },
+    { "color-mode", on_color_mode, "i", NULL, NULL, { 0 } },
+    { "color-tolerance", on_color_tolerance, "i", NULL, NULL, { 0 } },
+    { "reload", on_reload, "s", NULL, NULL, { 0 } },
+    { "swap", on_swap, "s", NULL, NULL, { 0 } },
+    { "swap-cut", on_swap_cut, "s", NULL, NULL, { 0 } },
+};
+
+void control_install(GApplication *app, const WallpinControlOps *ops) {
+    control_ops = ops;
+    g_action_map_add_action_entries(G_ACTION_MAP(app), control_actions,
+                                    G_N_ELEMENTS(control_actions), NULL);
+}
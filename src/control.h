@@ -0,0 +1,20 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <gio/gio.h>
+
+// Canal de control en tiempo de ejecución: acciones de GApplication exportadas por D-Bus.
+// Uso: gapplication action <application-id> speed 25.0
+typedef struct {
+    void (*set_speed)(double speed_per_second);
+    void (*set_fps)(int fps);
+    void (*set_paused)(gboolean paused);
+    void (*reorder)(const char *order);                   // "sorted", "reverse", "shuffle"
+    void (*set_color_mode)(int mode, int tolerance);      // -1 = mantener el valor actual
+    void (*reload)(const char *directory);                // "" = mismo directorio
+    void (*swap)(const char *directory, gboolean crossfade);   // Recarga sin dejar la pantalla vacía
+} WallpinControlOps;
+
+void control_install(GApplication *app, const WallpinControlOps *ops);
+
+#endif // CONTROL_H
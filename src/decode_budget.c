@@ -0,0 +1,173 @@
+#include "decode_budget.h"
+
+static struct {
+    GMutex lock;
+    GCond released;
+    gint64 max_pixels;
+    gsize in_flight_limit;
+    gsize in_flight;       // Bytes reservados por decodificaciones en curso
+} budget = { .max_pixels = DECODE_BUDGET_MAX_PIXELS, .in_flight_limit = DECODE_BUDGET_IN_FLIGHT_BYTES };
+
+typedef struct {
+    DecodeTargetFunc target;
+    gpointer user_data;
+    int source_width;
+    int source_height;
+    gsize reserved;        // Bytes tomados del presupuesto (se devuelven al soltar el loader)
+    gboolean rejected;     // Pasa del límite por decodificación: no se sigue alimentando
+} BudgetedLoad;
+
+typedef struct {
+    int width;
+    int height;
+    gboolean preserve_aspect;
+} ScaleTarget;
+
+void decode_budget_configure(gint64 max_pixels, gint64 in_flight_bytes) {
+    g_mutex_lock(&budget.lock);
+    if (max_pixels > 0) budget.max_pixels = max_pixels;
+    if (in_flight_bytes > 0) budget.in_flight_limit = (gsize)in_flight_bytes;
+    g_mutex_unlock(&budget.lock);
+}
+
+gint64 decode_budget_max_pixels(void) {
+    g_mutex_lock(&budget.lock);
+    gint64 max_pixels = budget.max_pixels;
+    g_mutex_unlock(&budget.lock);
+    return max_pixels;
+}
+
+// Dueño del contexto por defecto: el hilo de GTK mientras corre el main loop
+static gboolean on_main_thread(void) {
+    return g_main_context_is_owner(g_main_context_default());
+}
+
+gboolean decode_budget_acquire(gint64 pixels, gsize bytes) {
+    g_mutex_lock(&budget.lock);
+    if (pixels > budget.max_pixels) {
+        g_mutex_unlock(&budget.lock);
+        return FALSE;
+    }
+    // Una sola decodificación siempre avanza, aunque sola ya pase del presupuesto. El hilo
+    // de GTK no espera nunca a los hilos: entra aunque no quepa (solo tiene una en curso,
+    // así que el techo es el presupuesto más esa)
+    gboolean may_wait = !on_main_thread();
+    while (may_wait && budget.in_flight > 0 && budget.in_flight + bytes > budget.in_flight_limit) {
+        g_cond_wait(&budget.released, &budget.lock);
+    }
+    budget.in_flight += bytes;
+    g_mutex_unlock(&budget.lock);
+    return TRUE;
+}
+
+void decode_budget_release(gsize bytes) {
+    g_mutex_lock(&budget.lock);
+    budget.in_flight -= MIN(bytes, budget.in_flight);
+    g_cond_broadcast(&budget.released);
+    g_mutex_unlock(&budget.lock);
+}
+
+// Píxeles que el loader materializa de verdad: el de JPEG decodifica a 1/2, 1/4 o 1/8
+// si con eso sigue cubriendo lo pedido; los demás formatos, la imagen entera
+static gint64 decoded_pixels(GdkPixbufLoader *loader, int source_width, int source_height, int width, int height) {
+    GdkPixbufFormat *format = gdk_pixbuf_loader_get_format(loader);
+    char *name = format ? gdk_pixbuf_format_get_name(format) : NULL;
+    int denominator = 1;
+    if (g_strcmp0(name, "jpeg") == 0) {
+        while (denominator < 8 && source_width / (denominator * 2) >= width &&
+               source_height / (denominator * 2) >= height) {
+            denominator *= 2;
+        }
+    }
+    g_free(name);
+    return (gint64)((source_width + denominator - 1) / denominator) * ((source_height + denominator - 1) / denominator);
+}
+
+static void on_size_prepared(GdkPixbufLoader *loader, int source_width, int source_height, gpointer user_data) {
+    BudgetedLoad *load = user_data;
+    if (load->reserved > 0 || load->rejected || source_width <= 0 || source_height <= 0) return;
+    load->source_width = source_width;
+    load->source_height = source_height;
+
+    int width = source_width;
+    int height = source_height;
+    if (load->target) load->target(source_width, source_height, &width, &height, load->user_data);
+    gboolean scaled = width != source_width || height != source_height;
+
+    // RGBA decodificado y, si se escala, la copia escalada que devuelve el loader
+    gint64 pixels = decoded_pixels(loader, source_width, source_height, width, height);
+    gsize bytes = (gsize)pixels * 4 + (scaled ? (gsize)width * height * 4 : 0);
+    if (!decode_budget_acquire(pixels, bytes)) {
+        load->rejected = TRUE;
+        return;
+    }
+    load->reserved = bytes;
+    if (scaled) gdk_pixbuf_loader_set_size(loader, width, height);
+}
+
+GdkPixbuf *decode_budget_load(GBytes *bytes, DecodeTargetFunc target, gpointer user_data, GError **error) {
+    BudgetedLoad load = { target, user_data, 0, 0, 0, FALSE };
+    GdkPixbufLoader *loader = gdk_pixbuf_loader_new();
+    g_signal_connect(loader, "size-prepared", G_CALLBACK(on_size_prepared), &load);
+
+    // A trozos: tras la cabecera ya se sabe si cabe, y un rechazo no decodifica el resto
+    gsize size = 0;
+    const guchar *data = g_bytes_get_data(bytes, &size);
+    gboolean ok = TRUE;
+    for (gsize offset = 0; ok && !load.rejected && offset < size; offset += DECODE_BUDGET_CHUNK_BYTES) {
+        ok = gdk_pixbuf_loader_write(loader, data + offset, MIN(DECODE_BUDGET_CHUNK_BYTES, size - offset), error);
+    }
+    // close siempre, también tras un error o un rechazo, para liberar el estado del loader
+    gboolean closed = gdk_pixbuf_loader_close(loader, ok && !load.rejected ? error : NULL);
+
+    GdkPixbuf *pixbuf = NULL;
+    if (load.rejected) {
+        if (ok) {
+            g_set_error(error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_INSUFFICIENT_MEMORY,
+                        "%dx%d pasa del límite de %.0f MP por decodificación", load.source_width,
+                        load.source_height, decode_budget_max_pixels() / 1e6);
+        }
+    } else if (ok && closed) {
+        pixbuf = gdk_pixbuf_loader_get_pixbuf(loader);
+        if (pixbuf) {
+            g_object_ref(pixbuf);
+        } else {
+            g_set_error(error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_CORRUPT_IMAGE, "El loader no produjo imagen");
+        }
+    }
+
+    g_object_unref(loader);
+    if (load.reserved > 0) decode_budget_release(load.reserved);
+    return pixbuf;
+}
+
+// Mismo tamaño que gdk_pixbuf_new_from_file_at_scale
+static void scale_target(int source_width, int source_height, int *width, int *height, gpointer user_data) {
+    const ScaleTarget *target = user_data;
+    int target_width = target->width > 0 ? target->width : source_width;
+    int target_height = target->height > 0 ? target->height : source_height;
+
+    if (target->preserve_aspect) {
+        if ((double)source_height * target_width > (double)source_width * target_height) {
+            target_width = (int)(0.5 + (double)source_width * target_height / source_height);
+        } else {
+            target_height = (int)(0.5 + (double)source_height * target_width / source_width);
+        }
+    }
+    *width = MAX(target_width, 1);
+    *height = MAX(target_height, 1);
+}
+
+GdkPixbuf *decode_budget_load_file_at_scale(const char *path, int width, int height, gboolean preserve_aspect,
+                                            GError **error) {
+    // Mapeado en vez de leído: el archivo no ocupa memoria anónima aparte
+    GMappedFile *mapped = g_mapped_file_new(path, FALSE, error);
+    if (!mapped) return NULL;
+
+    ScaleTarget target = { width, height, preserve_aspect };
+    GBytes *bytes = g_mapped_file_get_bytes(mapped);
+    GdkPixbuf *pixbuf = decode_budget_load(bytes, scale_target, &target, error);
+    g_bytes_unref(bytes);
+    g_mapped_file_unref(mapped);
+    return pixbuf;
+}
@@ -0,0 +1,41 @@
+#ifndef DECODE_BUDGET_H
+#define DECODE_BUDGET_H
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+// Memoria acotada al decodificar, sea cual sea la imagen que haya en la carpeta.
+// Cada decodificación declara los bytes que va a materializar en cuanto conoce las
+// dimensiones (el loader JPEG reduce en el dominio DCT; PNG y el resto decodifican a
+// tamaño completo y escalan después) y:
+//  - si pasa de max_pixels se aborta antes de decodificar el resto del archivo;
+//  - si no, espera en un semáforo global hasta que quepa en in_flight_bytes junto a
+//    las que ya están en curso (una sola siempre puede avanzar). Solo esperan los hilos
+//    de trabajo: desde el hilo de GTK la reserva nunca bloquea.
+// El loader se alimenta por trozos, así que el tamaño se conoce tras la cabecera.
+#define DECODE_BUDGET_MAX_PIXELS (64 * 1000 * 1000)             // 8K (33 MP) con margen
+#define DECODE_BUDGET_IN_FLIGHT_BYTES (384 * 1024 * 1024)
+#define DECODE_BUDGET_CHUNK_BYTES (64 * 1024)
+
+// max_pixels/in_flight_bytes <= 0: mantener el valor actual. Antes de lanzar hilos
+void decode_budget_configure(gint64 max_pixels, gint64 in_flight_bytes);
+gint64 decode_budget_max_pixels(void);
+
+// Reserva bytes del presupuesto global (en un hilo de trabajo, bloquea hasta que quepan;
+// en el de GTK entra sin esperar); FALSE si la imagen de width × height pasa del límite
+// por decodificación y no hay que decodificarla
+gboolean decode_budget_acquire(gint64 pixels, gsize bytes);
+void decode_budget_release(gsize bytes);
+
+// Tamaño que se pide al loader para una imagen de source_width × source_height;
+// dejar width/height sin tocar = resolución completa
+typedef void (*DecodeTargetFunc)(int source_width, int source_height, int *width, int *height,
+                                 gpointer user_data);
+
+// Decodifica bytes con GdkPixbufLoader, a trozos y dentro del presupuesto. Devuelve el
+// pixbuf del loader (referencia nueva) sin aplicar la orientación EXIF
+GdkPixbuf *decode_budget_load(GBytes *bytes, DecodeTargetFunc target, gpointer user_data, GError **error);
+// Como gdk_pixbuf_new_from_file_at_scale, pero dentro del presupuesto
+GdkPixbuf *decode_budget_load_file_at_scale(const char *path, int width, int height, gboolean preserve_aspect,
+                                            GError **error);
+
+#endif // DECODE_BUDGET_H
@@ -0,0 +1,603 @@
+#include "decode_scheduler.h"
+#include "image_loader.h"
+#include "prefetch.h"
+#include "trace.h"
+#include "bench_stats.h"
+#include "alloc_stats.h"
+#include "tile_bake.h"
+#include "frame_stats.h"
+#include <math.h>
+
+#define DECODE_TIME_SMOOTHING 0.1      // Peso de cada medida en la media móvil del tiempo por tile
+#define DECODE_LATE_GROWTH 1.5         // Un tile tarde amplía el lookahead...
+#define DECODE_EARLY_DECAY 0.98        // ...y uno decodificado con mucha holgura lo reduce
+
+typedef struct {
+    char *path;
+    int width;
+    int height;
+    double bake_scale;         // > 0: esquinas y sombra horneadas, width × height ya incluye el margen
+    gint64 deadline;           // Monotónico (µs)
+    gboolean had_slack;        // Se pidió con tiempo: si llega tarde, el lookahead se quedó corto
+    GSequenceIter *iter;       // Posición en la cola; NULL si ya lo tomó un hilo
+    gboolean cancelled;        // Fuera de la tabla: lo libera quien termine con él
+} DecodeJob;
+
+typedef struct {
+    GPtrArray *paths;
+    IngestResult **results;
+    int thumbnail_width;
+    double ratio;              // > 0: solo el candidato de proporción más parecida (ver ingest_closest)
+    IngestReadyFunc on_ready;
+    gpointer owner;
+    gboolean cancelled;        // Con el lock: el hilo deja de ingerir y nadie lo entrega
+} IngestJob;
+
+// job o ingest, según sea un tile o un lote de ingesta
+typedef struct DecodeResult {
+    DecodeJob *job;
+    IngestJob *ingest;
+    GdkTexture *texture;
+    gint64 finished;               // Fin de la decodificación, para la latencia hasta el commit
+    struct DecodeResult *next;     // Enlace en la pila de entrada
+} DecodeResult;
+
+static struct {
+    GThreadPool *pool;
+    GThreadPool *ingest_pool;
+    GPtrArray *ingests;        // IngestJob* en curso o por entregar (con el lock)
+    GMutex lock;
+    GSequence *queue;          // DecodeJob* ordenados por plazo
+    GHashTable *jobs;          // path -> DecodeJob (en cola, decodificando o por entregar)
+    int running;
+    double decode_seconds;     // Media móvil del tiempo de lectura + decodificación por tile
+    double lookahead;
+    double bake_scale;         // Ver decode_scheduler_set_bake_scale
+    DecodeReadyFunc on_ready;
+    gpointer user_data;
+    guint64 decoded, late, cancelled;
+
+    // Entrega (ver DECODE_COMMIT_BUDGET_US)
+    DecodeResult *inbox;       // Pila MPSC: push con CAS desde los hilos, el principal se la lleva entera
+    GPtrArray *pending;        // Solo hilo principal: DecodeResult* aún sin entregar
+    guint commit_id;           // Timeout hasta la próxima ventana (0 = ninguno)
+    gint64 window_start;
+    gint64 window_spent;
+    guint max_pending;
+    guint64 deferred;          // Pasadas que agotaron el presupuesto
+    // Solo con --stats/--stats-file, por ventana del informe periódico (ver report_commit_stats)
+    BenchSamples *commit_latency;
+    guint window_max_pending;
+    guint window_deferred;
+} scheduler;
+
+static void free_job(DecodeJob *job) {
+    g_free(job->path);
+    g_free(job);
+}
+
+static int compare_deadlines(gconstpointer a, gconstpointer b, G_GNUC_UNUSED gpointer user_data) {
+    const DecodeJob *ja = a, *jb = b;
+    return (ja->deadline > jb->deadline) - (ja->deadline < jb->deadline);
+}
+
+// Ajuste del lookahead tras cada tile (con el lock tomado). Nunca por debajo de lo que
+// tarda en vaciarse la cola actual: si no, lo que se pide ahora ya llegaría tarde
+static void update_lookahead(gint64 finished, const DecodeJob *job) {
+    if (job->had_slack && finished > job->deadline) {
+        scheduler.lookahead *= DECODE_LATE_GROWTH;
+        scheduler.late++;
+    } else if ((job->deadline - finished) / (double)G_USEC_PER_SEC > scheduler.lookahead / 2) {
+        scheduler.lookahead *= DECODE_EARLY_DECAY;
+    }
+
+    double backlog = g_sequence_get_length(scheduler.queue) + scheduler.running;
+    double drain = scheduler.decode_seconds * backlog / DECODE_THREADS;
+    scheduler.lookahead = CLAMP(MAX(scheduler.lookahead, DECODE_LOOKAHEAD_SAFETY * drain),
+                                DECODE_LOOKAHEAD_MIN, DECODE_LOOKAHEAD_MAX);
+}
+
+static void free_ingest_job(IngestJob *ingest) {
+    for (guint i = 0; i < ingest->paths->len; i++) {
+        if (!ingest->results[i]) continue;
+        ingest_result_clear(ingest->results[i]);
+        g_free(ingest->results[i]);
+    }
+    g_free(ingest->results);
+    g_ptr_array_unref(ingest->paths);
+    g_free(ingest);
+}
+
+static void free_result(DecodeResult *result) {
+    g_clear_object(&result->texture);
+    if (result->job) free_job(result->job);
+    if (result->ingest) free_ingest_job(result->ingest);
+    g_free(result);
+}
+
+static void deliver_ingest(DecodeResult *result) {
+    IngestJob *ingest = result->ingest;
+
+    g_mutex_lock(&scheduler.lock);
+    gboolean current = !ingest->cancelled && scheduler.ingests;
+    if (current) g_ptr_array_remove_fast(scheduler.ingests, ingest);
+    g_mutex_unlock(&scheduler.lock);
+
+    if (current) {
+        TRACE_BEGIN(deliver_start);
+        ingest->on_ready(ingest->paths, ingest->results, ingest->owner);
+        TRACE_END(deliver_start, "ingest_commit", NULL);
+    }
+    free_result(result);
+}
+
+static void deliver_result(DecodeResult *result) {
+    if (result->ingest) {
+        deliver_ingest(result);
+        return;
+    }
+    DecodeJob *job = result->job;
+
+    g_mutex_lock(&scheduler.lock);
+    gboolean current = !job->cancelled && scheduler.jobs;
+    if (current) g_hash_table_steal(scheduler.jobs, job->path);
+    g_mutex_unlock(&scheduler.lock);
+
+    if (current && scheduler.on_ready) {
+        scheduler.on_ready(job->path, result->texture, scheduler.user_data);
+        if (scheduler.commit_latency) bench_samples_add_since(scheduler.commit_latency, result->finished);
+    }
+
+    free_result(result);
+}
+
+// Toda la pila de entrada, en orden de llegada
+static DecodeResult *take_inbox(void) {
+    DecodeResult *head;
+    do {
+        head = g_atomic_pointer_get(&scheduler.inbox);
+    } while (head && !g_atomic_pointer_compare_and_exchange(&scheduler.inbox, head, NULL));
+
+    DecodeResult *reversed = NULL;
+    while (head) {
+        DecodeResult *next = head->next;
+        head->next = reversed;
+        reversed = head;
+        head = next;
+    }
+    return reversed;
+}
+
+// Los lotes de ingesta, detrás de los tiles (estos tienen plazo) y en orden de llegada
+static int compare_result_deadlines(gconstpointer a, gconstpointer b) {
+    const DecodeResult *ra = *(DecodeResult * const *)a, *rb = *(DecodeResult * const *)b;
+    gint64 da = ra->job ? ra->job->deadline : G_MAXINT64;
+    gint64 db = rb->job ? rb->job->deadline : G_MAXINT64;
+    return (da > db) - (da < db);
+}
+
+// Hilo principal. from_timer: es el timeout de la ventana siguiente; si no, un aviso de
+// que la pila dejó de estar vacía, que se ignora mientras haya un timeout en espera
+static gboolean commit_results(gpointer user_data) {
+    if (GPOINTER_TO_INT(user_data)) {
+        scheduler.commit_id = 0;
+    } else if (scheduler.commit_id > 0 || !scheduler.pending) {
+        return G_SOURCE_REMOVE;
+    }
+
+    for (DecodeResult *result = take_inbox(); result; result = result->next) {
+        g_ptr_array_add(scheduler.pending, result);
+    }
+    if (scheduler.pending->len == 0) return G_SOURCE_REMOVE;
+    scheduler.max_pending = MAX(scheduler.max_pending, scheduler.pending->len);
+    scheduler.window_max_pending = MAX(scheduler.window_max_pending, scheduler.pending->len);
+    g_ptr_array_sort(scheduler.pending, compare_result_deadlines);
+
+    gint64 now = g_get_monotonic_time();
+    if (now - scheduler.window_start >= DECODE_COMMIT_WINDOW_US) {
+        scheduler.window_start = now;
+        scheduler.window_spent = 0;
+    }
+
+    TRACE_BEGIN(commit_start);
+    guint committed = 0;
+    while (committed < scheduler.pending->len && scheduler.window_spent < DECODE_COMMIT_BUDGET_US) {
+        deliver_result(g_ptr_array_index(scheduler.pending, committed++));
+        gint64 after = g_get_monotonic_time();
+        scheduler.window_spent += after - now;
+        now = after;
+    }
+    g_ptr_array_remove_range(scheduler.pending, 0, committed);
+    TRACE_END(commit_start, "commit", NULL);
+
+    if (scheduler.pending->len > 0) {
+        // Presupuesto agotado: el resto, cuando empiece la siguiente ventana
+        gint64 wait_us = scheduler.window_start + DECODE_COMMIT_WINDOW_US - now;
+        scheduler.commit_id = g_timeout_add(MAX(1, (guint)((wait_us + 999) / 1000)), commit_results, GINT_TO_POINTER(TRUE));
+        scheduler.deferred++;
+        scheduler.window_deferred++;
+    }
+    return G_SOURCE_REMOVE;
+}
+
+// Desde cualquier hilo. Solo quien encuentra la pila vacía despierta al hilo principal
+static void push_result(DecodeResult *result) {
+    DecodeResult *head;
+    do {
+        head = g_atomic_pointer_get(&scheduler.inbox);
+        result->next = head;
+    } while (!g_atomic_pointer_compare_and_exchange(&scheduler.inbox, head, result));
+
+    if (!head) {
+        // Prioridad alta: lo visible queda listo para el próximo frame
+        g_idle_add_full(G_PRIORITY_HIGH_IDLE, commit_results, GINT_TO_POINTER(FALSE), NULL);
+    }
+}
+
+// Cada push al pool es un "turno": el hilo toma el trabajo de plazo más próximo en ese
+// momento, no el que provocó el push
+// Tile a width × height; horneado, la imagen ocupa lo que deja el margen de la sombra
+static GdkPixbuf *load_tile(const DecodeJob *job, GError **error) {
+    if (job->bake_scale <= 0) return image_loader_load_cover(job->path, job->width, job->height, error);
+
+    int pad = tile_bake_padding(job->bake_scale);
+    GdkPixbuf *cover = image_loader_load_cover(job->path, MAX(1, job->width - 2 * pad),
+                                               MAX(1, job->height - 2 * pad), error);
+    if (!cover) return NULL;
+
+    gint64 start = g_get_monotonic_time();
+    GdkPixbuf *baked = tile_bake(cover, job->bake_scale);
+    TRACE_END(start, "bake", job->path);
+    g_object_unref(cover);
+    return baked;
+}
+
+static void decode_worker(G_GNUC_UNUSED gpointer data, G_GNUC_UNUSED gpointer user_data) {
+    g_mutex_lock(&scheduler.lock);
+    GSequenceIter *first = g_sequence_get_begin_iter(scheduler.queue);
+    if (g_sequence_iter_is_end(first)) {
+        g_mutex_unlock(&scheduler.lock);
+        return;   // Turno de un trabajo ya cancelado
+    }
+    DecodeJob *job = g_sequence_get(first);
+    g_sequence_remove(first);
+    job->iter = NULL;
+    scheduler.running++;
+    g_mutex_unlock(&scheduler.lock);
+
+    trace_set_thread_name("decode");
+    gint64 start = g_get_monotonic_time();
+    GError *error = NULL;
+    GdkPixbuf *pixbuf = load_tile(job, &error);
+    GdkTexture *texture = NULL;
+    if (pixbuf) {
+        texture = gdk_texture_new_for_pixbuf(pixbuf);
+        ALLOC_STATS_TRACK(ALLOC_TEXTURES, texture, gdk_pixbuf_get_byte_length(pixbuf));
+        g_object_unref(pixbuf);
+    } else {
+        g_warning("Error loading image %s: %s", job->path, error ? error->message : "unknown");
+        g_clear_error(&error);
+    }
+    gint64 finished = g_get_monotonic_time();
+    TRACE_END(start, "tile", job->path);
+
+    g_mutex_lock(&scheduler.lock);
+    scheduler.running--;
+    scheduler.decoded++;
+    double seconds = (finished - start) / (double)G_USEC_PER_SEC;
+    scheduler.decode_seconds = scheduler.decode_seconds > 0
+        ? scheduler.decode_seconds + DECODE_TIME_SMOOTHING * (seconds - scheduler.decode_seconds)
+        : seconds;
+    update_lookahead(finished, job);
+    gboolean cancelled = job->cancelled;
+    g_mutex_unlock(&scheduler.lock);
+
+    if (cancelled) {
+        g_clear_object(&texture);
+        free_job(job);
+        return;
+    }
+
+    // Los widgets solo se tocan desde el hilo principal
+    DecodeResult *result = g_new0(DecodeResult, 1);
+    result->job = job;
+    result->texture = texture;
+    result->finished = finished;
+    push_result(result);
+}
+
+// Informe periódico de frame_stats (hilo principal, como la entrega): cola y latencia
+// decodificado→commit de la ventana, que se vacía aquí
+static void report_commit_stats(GString *summary, GString *file_lines, G_GNUC_UNUSED double seconds) {
+    double p50 = bench_samples_percentile(scheduler.commit_latency, 50.0) / 1000.0;
+    double p99 = bench_samples_percentile(scheduler.commit_latency, 99.0) / 1000.0;
+    g_string_append_printf(summary, " | entrega: cola máx %u, p50 %.1fms p99 %.1fms, %u aplazadas",
+                           scheduler.window_max_pending, p50, p99, scheduler.window_deferred);
+    g_string_append_printf(file_lines, "commit_queue_max=%u\n", scheduler.window_max_pending);
+    g_string_append_printf(file_lines, "commit_latency_p50_ms=%.2f\n", p50);
+    g_string_append_printf(file_lines, "commit_latency_p99_ms=%.2f\n", p99);
+    g_string_append_printf(file_lines, "commit_deferred=%u\n", scheduler.window_deferred);
+
+    bench_samples_reset(scheduler.commit_latency);
+    scheduler.window_max_pending = 0;
+    scheduler.window_deferred = 0;
+}
+
+static gboolean ingest_cancelled(IngestJob *ingest) {
+    g_mutex_lock(&scheduler.lock);
+    gboolean cancelled = ingest->cancelled;
+    g_mutex_unlock(&scheduler.lock);
+    return cancelled;
+}
+
+// Solo cabeceras: los ilegibles salen del lote y el más parecido a ingest->ratio pasa
+// delante. FALSE si no queda ninguno o lo cancelaron
+static gboolean pick_closest(IngestJob *ingest) {
+    double best_error = G_MAXDOUBLE;
+    guint best = 0;
+
+    for (guint i = ingest->paths->len; i > 0; i--) {
+        if (ingest_cancelled(ingest)) return FALSE;
+
+        const char *path = g_ptr_array_index(ingest->paths, i - 1);
+        int width = 0, height = 0;
+        if (!gdk_pixbuf_get_file_info(path, &width, &height) || width <= 0 || height <= 0) {
+            g_ptr_array_remove_index(ingest->paths, i - 1);
+            if (best > i - 1) best--;
+            continue;
+        }
+        double error = fabs(log((double)width / height / ingest->ratio));
+        if (error <= best_error) {
+            best = i - 1;
+            best_error = error;
+        }
+    }
+    if (ingest->paths->len == 0) return FALSE;
+
+    gpointer path = g_ptr_array_steal_index(ingest->paths, best);
+    g_ptr_array_insert(ingest->paths, 0, path);
+    return TRUE;
+}
+
+// Un lote entero por turno; entre archivo y archivo se mira si lo cancelaron
+static void ingest_worker(gpointer data, G_GNUC_UNUSED gpointer user_data) {
+    IngestJob *ingest = data;
+    trace_set_thread_name("ingest");
+
+    guint count = ingest->paths->len;
+    if (ingest->ratio > 0) {
+        TRACE_BEGIN(probe_start);
+        count = pick_closest(ingest) ? 1 : 0;
+        TRACE_END(probe_start, "ingest_probe", NULL);
+    }
+
+    for (guint i = 0; i < count; i++) {
+        if (ingest_cancelled(ingest)) break;
+
+        const char *path = g_ptr_array_index(ingest->paths, i);
+        IngestResult *result = g_new0(IngestResult, 1);
+        GError *error = NULL;
+        TRACE_BEGIN(ingest_start);
+        gboolean ok = ingest_file(path, ingest->thumbnail_width, result, &error);
+        TRACE_END(ingest_start, "ingest", path);
+        if (ok) {
+            ingest->results[i] = result;
+        } else {
+            g_warning("Could not load image %s: %s", path, error ? error->message : "unknown");
+            g_clear_error(&error);
+            g_free(result);
+        }
+    }
+
+    DecodeResult *result = g_new0(DecodeResult, 1);
+    result->ingest = ingest;
+    result->finished = g_get_monotonic_time();
+    push_result(result);
+}
+
+static void push_ingest(GPtrArray *paths, int thumbnail_width, double ratio, IngestReadyFunc on_ready,
+                        gpointer owner) {
+    if (!scheduler.pool || !paths || paths->len == 0) {
+        if (paths) g_ptr_array_unref(paths);
+        return;
+    }
+
+    IngestJob *ingest = g_new0(IngestJob, 1);
+    ingest->paths = paths;
+    ingest->results = g_new0(IngestResult *, paths->len);
+    ingest->thumbnail_width = thumbnail_width;
+    ingest->ratio = ratio;
+    ingest->on_ready = on_ready;
+    ingest->owner = owner;
+
+    g_mutex_lock(&scheduler.lock);
+    g_ptr_array_add(scheduler.ingests, ingest);
+    g_mutex_unlock(&scheduler.lock);
+    g_thread_pool_push(scheduler.ingest_pool, ingest, NULL);
+}
+
+void decode_scheduler_ingest(GPtrArray *paths, int thumbnail_width, IngestReadyFunc on_ready, gpointer owner) {
+    push_ingest(paths, thumbnail_width, 0.0, on_ready, owner);
+}
+
+void decode_scheduler_ingest_closest(GPtrArray *candidates, double ratio, int thumbnail_width,
+                                     IngestReadyFunc on_ready, gpointer owner) {
+    push_ingest(candidates, thumbnail_width, MAX(ratio, 1e-6), on_ready, owner);
+}
+
+void decode_scheduler_cancel_ingest(gpointer owner) {
+    if (!scheduler.pool) return;
+
+    g_mutex_lock(&scheduler.lock);
+    for (guint i = scheduler.ingests->len; i > 0; i--) {
+        IngestJob *ingest = g_ptr_array_index(scheduler.ingests, i - 1);
+        if (ingest->owner != owner) continue;
+        ingest->cancelled = TRUE;   // Sigue su camino hasta la entrega, que lo descarta y lo libera
+        g_ptr_array_remove_index_fast(scheduler.ingests, i - 1);
+    }
+    g_mutex_unlock(&scheduler.lock);
+}
+
+void decode_scheduler_init(DecodeReadyFunc on_ready, gpointer user_data) {
+    if (scheduler.pool) return;
+
+    g_mutex_init(&scheduler.lock);
+    scheduler.queue = g_sequence_new(NULL);
+    scheduler.jobs = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, (GDestroyNotify)free_job);
+    scheduler.lookahead = DECODE_LOOKAHEAD_MIN;
+    scheduler.on_ready = on_ready;
+    scheduler.user_data = user_data;
+    scheduler.pending = g_ptr_array_new();
+    if (frame_stats_enabled) {
+        scheduler.commit_latency = bench_samples_new("commit_latency");
+        frame_stats_set_reporter(report_commit_stats);
+    }
+    scheduler.ingests = g_ptr_array_new();
+    scheduler.pool = g_thread_pool_new(decode_worker, NULL, DECODE_THREADS, FALSE, NULL);
+    scheduler.ingest_pool = g_thread_pool_new(ingest_worker, NULL, DECODE_INGEST_THREADS, FALSE, NULL);
+}
+
+// Saca un trabajo de la tabla (con el lock tomado). Si un hilo ya lo tiene, solo se
+// marca: el resultado se descarta al terminar
+static void cancel_job(DecodeJob *job) {
+    scheduler.cancelled++;
+    if (job->iter) {
+        g_sequence_remove(job->iter);
+        g_hash_table_remove(scheduler.jobs, job->path);
+    } else {
+        job->cancelled = TRUE;
+        g_hash_table_steal(scheduler.jobs, job->path);
+    }
+}
+
+void decode_scheduler_submit(const char *path, int width, int height, double deadline) {
+    if (!scheduler.pool || !path) return;
+
+    gint64 now = g_get_monotonic_time();
+    gint64 deadline_us = now + (gint64)(MAX(deadline, 0.0) * G_USEC_PER_SEC);
+
+    g_mutex_lock(&scheduler.lock);
+    DecodeJob *job = g_hash_table_lookup(scheduler.jobs, path);
+    if (job && (job->width != width || job->height != height || job->bake_scale != scheduler.bake_scale)) {
+        cancel_job(job);   // Cambió el tamaño del tile: el resultado ya no sirve
+        job = NULL;
+    }
+
+    if (job) {
+        // En curso o por entregar: no hay nada que reordenar
+        if (job->iter && job->deadline != deadline_us) {
+            job->deadline = deadline_us;
+            g_sequence_sort_changed(job->iter, compare_deadlines, NULL);
+        }
+        g_mutex_unlock(&scheduler.lock);
+        return;
+    }
+
+    job = g_new0(DecodeJob, 1);
+    job->path = g_strdup(path);
+    job->width = width;
+    job->height = height;
+    job->bake_scale = scheduler.bake_scale;
+    job->deadline = deadline_us;
+    job->had_slack = deadline > 0;
+    job->iter = g_sequence_insert_sorted(scheduler.queue, job, compare_deadlines, NULL);
+    g_hash_table_insert(scheduler.jobs, job->path, job);
+    g_mutex_unlock(&scheduler.lock);
+
+    // La lectura va por delante en los hilos de prefetch mientras este espera turno,
+    // salvo que la ingesta haya dejado ya los píxeles
+    if (!image_loader_has_thumbnail(path)) prefetch_request(path);
+    g_thread_pool_push(scheduler.pool, GINT_TO_POINTER(1), NULL);
+}
+
+void decode_scheduler_cancel(const char *path) {
+    if (!scheduler.pool || !path) return;
+
+    g_mutex_lock(&scheduler.lock);
+    DecodeJob *job = g_hash_table_lookup(scheduler.jobs, path);
+    if (job) cancel_job(job);
+    g_mutex_unlock(&scheduler.lock);
+}
+
+void decode_scheduler_cancel_all(void) {
+    if (!scheduler.pool) return;
+
+    g_mutex_lock(&scheduler.lock);
+    GHashTableIter iter;
+    gpointer value;
+    g_hash_table_iter_init(&iter, scheduler.jobs);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        DecodeJob *job = value;
+        scheduler.cancelled++;
+        if (job->iter) {
+            g_sequence_remove(job->iter);
+            g_hash_table_iter_remove(&iter);
+        } else {
+            job->cancelled = TRUE;
+            g_hash_table_iter_steal(&iter);
+        }
+    }
+    g_mutex_unlock(&scheduler.lock);
+}
+
+void decode_scheduler_set_bake_scale(double scale) {
+    g_mutex_lock(&scheduler.lock);
+    scheduler.bake_scale = MAX(scale, 0.0);
+    g_mutex_unlock(&scheduler.lock);
+}
+
+double decode_scheduler_get_lookahead(void) {
+    if (!scheduler.pool) return DECODE_LOOKAHEAD_MIN;
+
+    g_mutex_lock(&scheduler.lock);
+    double lookahead = scheduler.lookahead;
+    g_mutex_unlock(&scheduler.lock);
+    return lookahead;
+}
+
+void decode_scheduler_shutdown(void) {
+    if (!scheduler.pool) return;
+
+    decode_scheduler_cancel_all();
+    g_mutex_lock(&scheduler.lock);
+    for (guint i = 0; i < scheduler.ingests->len; i++) {
+        ((IngestJob *)g_ptr_array_index(scheduler.ingests, i))->cancelled = TRUE;
+    }
+    g_ptr_array_set_size(scheduler.ingests, 0);
+    g_mutex_unlock(&scheduler.lock);
+    // Los lotes a medias terminan pronto: se saltan lo que les queda
+    g_thread_pool_free(scheduler.ingest_pool, FALSE, TRUE);
+    scheduler.ingest_pool = NULL;
+    g_thread_pool_free(scheduler.pool, TRUE, TRUE);
+    scheduler.pool = NULL;
+
+    if (scheduler.decoded > 0) {
+        g_print("🧩 Decodificación: %" G_GUINT64_FORMAT " tiles (%.1f ms/tile), %" G_GUINT64_FORMAT
+                " tarde, %" G_GUINT64_FORMAT " canceladas, lookahead final %.1fs\n",
+                scheduler.decoded, scheduler.decode_seconds * 1000.0, scheduler.late,
+                scheduler.cancelled, scheduler.lookahead);
+        g_print("📥 Entrega: cola máx %u, %" G_GUINT64_FORMAT " pasadas aplazadas por presupuesto\n",
+                scheduler.max_pending, scheduler.deferred);
+    }
+
+    // Lo que quedó sin entregar ya no tiene destinatario
+    if (scheduler.commit_id > 0) {
+        g_source_remove(scheduler.commit_id);
+        scheduler.commit_id = 0;
+    }
+    for (DecodeResult *result = take_inbox(); result; ) {
+        DecodeResult *next = result->next;
+        free_result(result);
+        result = next;
+    }
+    for (guint i = 0; i < scheduler.pending->len; i++) {
+        free_result(g_ptr_array_index(scheduler.pending, i));
+    }
+    g_clear_pointer(&scheduler.pending, g_ptr_array_unref);
+    g_clear_pointer(&scheduler.ingests, g_ptr_array_unref);
+    g_clear_pointer(&scheduler.commit_latency, bench_samples_free);
+
+    g_clear_pointer(&scheduler.jobs, g_hash_table_destroy);
+    g_clear_pointer(&scheduler.queue, g_sequence_free);
+    g_mutex_clear(&scheduler.lock);
+}
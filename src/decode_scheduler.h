@@ -0,0 +1,57 @@
+#ifndef DECODE_SCHEDULER_H
+#define DECODE_SCHEDULER_H
+
+#include <gtk/gtk.h>
+#include "ingest.h"
+
+// Decodificación de tiles en segundo plano, primero el de plazo más próximo (EDF).
+// El scroll es determinista, así que quien llama sabe cuándo entra cada tile en
+// pantalla y lo pasa como plazo; aquí se ordena, se cancela lo que deja de hacer
+// falta y se ajusta cuánto scroll por delante conviene tener decodificado.
+#define DECODE_THREADS 2
+#define DECODE_LOOKAHEAD_MIN 2.0       // Segundos de scroll decodificados por delante, como mínimo
+#define DECODE_LOOKAHEAD_MAX 60.0
+#define DECODE_LOOKAHEAD_SAFETY 3.0    // Margen sobre el tiempo estimado para vaciar la cola
+#define DECODE_RELEASE_FACTOR 2.0      // Texturas a más de lookahead × esto se liberan
+
+// Entrega al hilo principal: los hilos dejan cada resultado en una pila sin locks y el
+// hilo principal la vacía por orden de plazo (lo más cerca del viewport primero), sin
+// pasar de DECODE_COMMIT_BUDGET_US por ventana de ~1 frame; lo que no cabe espera a la siguiente
+#define DECODE_COMMIT_BUDGET_US 2000
+#define DECODE_COMMIT_WINDOW_US 16000
+
+// En el hilo principal; texture es NULL si el archivo no se pudo decodificar
+typedef void (*DecodeReadyFunc)(const char *path, GdkTexture *texture, gpointer user_data);
+
+void decode_scheduler_init(DecodeReadyFunc on_ready, gpointer user_data);
+// Encola la decodificación de path, o actualiza plazo y tamaño si ya estaba en cola.
+// deadline: segundos desde ahora hasta que el tile se ve (0 = ya visible)
+void decode_scheduler_submit(const char *path, int width, int height, double deadline);
+void decode_scheduler_cancel(const char *path);
+void decode_scheduler_cancel_all(void);
+// Con scale > 0 los tiles salen horneados (ver tile_bake.h): width × height de submit es
+// el tile con su margen y la imagen ocupa el centro. 0 = imagen sola
+void decode_scheduler_set_bake_scale(double scale);
+
+// Ingesta (ver ingest.h) fuera del hilo principal, en un pool propio para no quitar
+// turno a los tiles con plazo. El lote vuelve por la misma pila de entrada que los
+// tiles y se entrega en el hilo principal: results[i] es el de paths[i], NULL si no se
+// pudo leer; ambos son del planificador (se liberan tras la llamada). owner agrupa
+// lotes para cancelarlos juntos
+#define DECODE_INGEST_THREADS 2
+typedef void (*IngestReadyFunc)(GPtrArray *paths, IngestResult **results, gpointer owner);
+
+// Se queda con paths (char*, con su función de liberación)
+void decode_scheduler_ingest(GPtrArray *paths, int thumbnail_width, IngestReadyFunc on_ready, gpointer owner);
+// Como decode_scheduler_ingest, pero de los candidatos solo se ingiere el de proporción
+// (ancho / alto, leída de las cabeceras) más parecida a ratio. En la entrega ese va en
+// paths[0] con results[0] (NULL si no se pudo decodificar), detrás los demás legibles
+// sin resultado; los ilegibles ya no vienen
+void decode_scheduler_ingest_closest(GPtrArray *candidates, double ratio, int thumbnail_width,
+                                     IngestReadyFunc on_ready, gpointer owner);
+// Los lotes de owner en curso o por entregar no se entregarán
+void decode_scheduler_cancel_ingest(gpointer owner);
+double decode_scheduler_get_lookahead(void);
+void decode_scheduler_shutdown(void);
+
+#endif // DECODE_SCHEDULER_H
@@ -0,0 +1,259 @@
+#include "frame_stats.h"
+#include "bench_stats.h"
+#include <glib/gstdio.h>
+#include <unistd.h>
+
+#define HISTOGRAM_BUCKETS 10
+#define PENDING_FRAMES 64
+#define DEFAULT_INTERVAL_SECONDS 5
+
+// Límites en ms alrededor de los refresh habituales (240, 144, 120, 90, 60, 48, 30 Hz)
+static const double histogram_edges_ms[HISTOGRAM_BUCKETS - 1] = {
+    4.2, 7.0, 8.4, 11.2, 16.8, 21.0, 33.4, 50.0, 100.0
+};
+
+typedef struct {
+    gint64 frame_counter;
+    gint64 tick_time;
+} PendingFrame;
+
+gboolean frame_stats_enabled = FALSE;
+
+static struct {
+    gboolean print_summaries;
+    char *stats_file;
+    int interval_seconds;
+    guint timer_id;
+
+    GdkFrameClock *clock;
+    gulong after_paint_id;
+
+    gint64 tick_interval;       // Intervalo configurado del timer de scroll
+    gint64 pending_tick;        // Primer tick desde el último paint (0 = ninguno)
+    PendingFrame pending[PENDING_FRAMES];
+    int pending_head;
+    int pending_count;
+    gint64 last_frame_time;
+
+    guint64 histogram[HISTOGRAM_BUCKETS];
+    guint64 total_frames;
+    guint64 total_ticks;
+    guint64 total_missed;
+
+    gint64 window_start;
+    guint window_frames;
+    guint window_ticks;
+    guint window_missed;
+    BenchSamples *frame_intervals;
+    BenchSamples *tick_to_present;
+    FrameStatsReportFunc reporter;
+} stats;
+
+static int histogram_bucket(double interval_ms) {
+    for (int i = 0; i < HISTOGRAM_BUCKETS - 1; i++) {
+        if (interval_ms < histogram_edges_ms[i]) return i;
+    }
+    return HISTOGRAM_BUCKETS - 1;
+}
+
+void frame_stats_set_reporter(FrameStatsReportFunc report) {
+    stats.reporter = report;
+}
+
+void frame_stats_set_tick_interval(gint64 interval_us) {
+    stats.tick_interval = interval_us;
+}
+
+void frame_stats_record_tick(void) {
+    stats.total_ticks++;
+    stats.window_ticks++;
+    if (stats.pending_tick == 0) {
+        stats.pending_tick = g_get_monotonic_time();
+    }
+}
+
+// Los timings de presentación llegan uno o dos frames después del paint
+static void process_completed_frames(GdkFrameClock *clock) {
+    while (stats.pending_count > 0) {
+        PendingFrame *frame = &stats.pending[stats.pending_head];
+        GdkFrameTimings *timings = gdk_frame_clock_get_timings(clock, frame->frame_counter);
+
+        if (timings && !gdk_frame_timings_get_complete(timings)) {
+            break;
+        }
+
+        if (timings) {
+            gint64 presentation = gdk_frame_timings_get_presentation_time(timings);
+            if (presentation > 0 && presentation >= frame->tick_time) {
+                bench_samples_add(stats.tick_to_present, (double)(presentation - frame->tick_time));
+            }
+        }
+
+        stats.pending_head = (stats.pending_head + 1) % PENDING_FRAMES;
+        stats.pending_count--;
+    }
+}
+
+static void on_after_paint(GdkFrameClock *clock, G_GNUC_UNUSED gpointer user_data) {
+    gint64 frame_time = gdk_frame_clock_get_frame_time(clock);
+
+    if (stats.last_frame_time > 0 && frame_time > stats.last_frame_time) {
+        gint64 interval = frame_time - stats.last_frame_time;
+        stats.histogram[histogram_bucket(interval / 1000.0)]++;
+        bench_samples_add(stats.frame_intervals, (double)interval);
+
+        // Un vblank se cuenta como perdido si el frame llega más tarde que la cadencia
+        // esperada: la mayor entre el refresh del monitor y el intervalo del timer
+        gint64 refresh_interval = 0;
+        gdk_frame_clock_get_refresh_info(clock, frame_time, &refresh_interval, NULL);
+        gint64 expected = MAX(refresh_interval, stats.tick_interval);
+        if (expected > 0) {
+            gint64 slots = (interval + expected / 2) / expected;
+            if (slots > 1) {
+                stats.total_missed += slots - 1;
+                stats.window_missed += slots - 1;
+            }
+        }
+    }
+    stats.last_frame_time = frame_time;
+    stats.total_frames++;
+    stats.window_frames++;
+
+    if (stats.pending_tick > 0) {
+        if (stats.pending_count == PENDING_FRAMES) {
+            stats.pending_head = (stats.pending_head + 1) % PENDING_FRAMES;
+            stats.pending_count--;
+        }
+        int slot = (stats.pending_head + stats.pending_count) % PENDING_FRAMES;
+        stats.pending[slot].frame_counter = gdk_frame_clock_get_frame_counter(clock);
+        stats.pending[slot].tick_time = stats.pending_tick;
+        stats.pending_count++;
+        stats.pending_tick = 0;
+    }
+
+    process_completed_frames(clock);
+}
+
+static void write_stats_file(double seconds, const char *extra_lines) {
+    GString *out = g_string_new(NULL);
+
+    g_string_append_printf(out, "pid=%d\n", (int)getpid());
+    g_string_append_printf(out, "updated=%" G_GINT64_FORMAT "\n", g_get_real_time() / G_USEC_PER_SEC);
+    g_string_append_printf(out, "fps=%.1f\n", stats.window_frames / seconds);
+    g_string_append_printf(out, "wakeups_per_sec=%.1f\n", stats.window_ticks / seconds);
+    g_string_append_printf(out, "missed_vblanks=%u\n", stats.window_missed);
+    g_string_append_printf(out, "frame_p50_ms=%.2f\n", bench_samples_percentile(stats.frame_intervals, 50.0) / 1000.0);
+    g_string_append_printf(out, "frame_p99_ms=%.2f\n", bench_samples_percentile(stats.frame_intervals, 99.0) / 1000.0);
+    g_string_append_printf(out, "tick_to_present_p50_ms=%.2f\n", bench_samples_percentile(stats.tick_to_present, 50.0) / 1000.0);
+    g_string_append_printf(out, "tick_to_present_p99_ms=%.2f\n", bench_samples_percentile(stats.tick_to_present, 99.0) / 1000.0);
+    g_string_append_printf(out, "total_frames=%" G_GUINT64_FORMAT "\n", stats.total_frames);
+    g_string_append_printf(out, "total_wakeups=%" G_GUINT64_FORMAT "\n", stats.total_ticks);
+    g_string_append_printf(out, "total_missed_vblanks=%" G_GUINT64_FORMAT "\n", stats.total_missed);
+
+    g_string_append(out, "frame_histogram_ms=");
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if (i < HISTOGRAM_BUCKETS - 1) {
+            g_string_append_printf(out, "<%.1f:%" G_GUINT64_FORMAT ",", histogram_edges_ms[i], stats.histogram[i]);
+        } else {
+            g_string_append_printf(out, ">=%.1f:%" G_GUINT64_FORMAT "\n", histogram_edges_ms[i - 1], stats.histogram[i]);
+        }
+    }
+    g_string_append(out, extra_lines);
+
+    // Escritura atómica: el script de estado nunca lee un archivo a medias
+    GError *error = NULL;
+    if (!g_file_set_contents(stats.stats_file, out->str, out->len, &error)) {
+        g_warning("No se pudo escribir %s: %s", stats.stats_file, error->message);
+        g_error_free(error);
+    }
+    g_string_free(out, TRUE);
+}
+
+static gboolean stats_summary_tick(G_GNUC_UNUSED gpointer user_data) {
+    gint64 now = g_get_monotonic_time();
+    double seconds = MAX(0.001, (now - stats.window_start) / (double)G_USEC_PER_SEC);
+
+    GString *extra_summary = g_string_new(NULL);
+    GString *extra_lines = g_string_new(NULL);
+    if (stats.reporter) stats.reporter(extra_summary, extra_lines, seconds);
+
+    if (stats.print_summaries) {
+        g_print("📊 %.1f fps | wakeups: %.1f/s | vblanks perdidos: %u | frame p50 %.2fms p99 %.2fms | tick→present p50 %.2fms p99 %.2fms%s\n",
+                stats.window_frames / seconds,
+                stats.window_ticks / seconds,
+                stats.window_missed,
+                bench_samples_percentile(stats.frame_intervals, 50.0) / 1000.0,
+                bench_samples_percentile(stats.frame_intervals, 99.0) / 1000.0,
+                bench_samples_percentile(stats.tick_to_present, 50.0) / 1000.0,
+                bench_samples_percentile(stats.tick_to_present, 99.0) / 1000.0,
+                extra_summary->str);
+    }
+
+    if (stats.stats_file) {
+        write_stats_file(seconds, extra_lines->str);
+    }
+    g_string_free(extra_summary, TRUE);
+    g_string_free(extra_lines, TRUE);
+
+    stats.window_start = now;
+    stats.window_frames = 0;
+    stats.window_ticks = 0;
+    stats.window_missed = 0;
+    bench_samples_reset(stats.frame_intervals);
+    bench_samples_reset(stats.tick_to_present);
+
+    return G_SOURCE_CONTINUE;
+}
+
+void frame_stats_enable(gboolean print_summaries, const char *stats_file, int interval_seconds) {
+    if (frame_stats_enabled) return;
+
+    stats.print_summaries = print_summaries;
+    stats.stats_file = g_strdup(stats_file);
+    stats.interval_seconds = interval_seconds > 0 ? interval_seconds : DEFAULT_INTERVAL_SECONDS;
+    stats.frame_intervals = bench_samples_new("frame_interval");
+    stats.tick_to_present = bench_samples_new("tick_to_present");
+    stats.window_start = g_get_monotonic_time();
+    stats.timer_id = g_timeout_add_seconds(stats.interval_seconds, stats_summary_tick, NULL);
+
+    frame_stats_enabled = TRUE;
+}
+
+static void on_window_map(GtkWidget *window, G_GNUC_UNUSED gpointer user_data) {
+    GdkFrameClock *clock = gtk_widget_get_frame_clock(window);
+    if (!clock || clock == stats.clock) return;
+
+    if (stats.clock) {
+        g_signal_handler_disconnect(stats.clock, stats.after_paint_id);
+        g_object_unref(stats.clock);
+    }
+    stats.clock = g_object_ref(clock);
+    stats.after_paint_id = g_signal_connect(clock, "after-paint", G_CALLBACK(on_after_paint), NULL);
+}
+
+void frame_stats_attach(GtkWidget *window) {
+    if (!frame_stats_enabled) return;
+    g_signal_connect(window, "map", G_CALLBACK(on_window_map), NULL);
+}
+
+void frame_stats_shutdown(void) {
+    if (!frame_stats_enabled) return;
+
+    if (stats.timer_id > 0) {
+        g_source_remove(stats.timer_id);
+        stats.timer_id = 0;
+    }
+    if (stats.clock) {
+        g_signal_handler_disconnect(stats.clock, stats.after_paint_id);
+        g_clear_object(&stats.clock);
+    }
+    if (stats.stats_file) {
+        g_unlink(stats.stats_file);
+        g_clear_pointer(&stats.stats_file, g_free);
+    }
+    g_clear_pointer(&stats.frame_intervals, bench_samples_free);
+    g_clear_pointer(&stats.tick_to_present, bench_samples_free);
+    stats.reporter = NULL;
+
+    frame_stats_enabled = FALSE;
+}
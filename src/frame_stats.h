@@ -0,0 +1,26 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <gtk/gtk.h>
+
+// Instrumentación del bucle de scroll: histograma de frames, vblanks perdidos,
+// retardo tick→present y wakeups por segundo. Desactivada por defecto.
+extern gboolean frame_stats_enabled;
+
+// Único coste en el camino caliente cuando está desactivada: una rama
+#define FRAME_STATS_TICK() \
+    do { if (G_UNLIKELY(frame_stats_enabled)) frame_stats_record_tick(); } while (0)
+
+void frame_stats_enable(gboolean print_summaries, const char *stats_file, int interval_seconds);
+void frame_stats_attach(GtkWidget *window);
+void frame_stats_set_tick_interval(gint64 interval_us);
+void frame_stats_record_tick(void);
+
+// Sección de otro subsistema en el informe periódico: se llama una vez por ventana,
+// añade " | ..." a la línea de resumen y líneas clave=valor al archivo, y reinicia lo
+// que acumula por ventana (así su memoria no crece con el tiempo que lleva en marcha)
+typedef void (*FrameStatsReportFunc)(GString *summary, GString *file_lines, double seconds);
+void frame_stats_set_reporter(FrameStatsReportFunc report);
+void frame_stats_shutdown(void);
+
+#endif // FRAME_STATS_H
@@ -0,0 +1,222 @@
+#include "image_loader.h"
+#include "decode_budget.h"
+#include "jpeg_decode.h"
+#include "prefetch.h"
+#include "shared_thumbnails.h"
+#include "trace.h"
+#include "alloc_stats.h"
+
+typedef struct {
+    int width;
+    int height;
+} CoverTarget;
+
+static struct {
+    GMutex lock;
+    GHashTable *pixbufs;     // path -> GdkPixbuf
+    GQueue order;            // paths (propiedad de pixbufs) en orden de llegada, para expulsar
+    gsize bytes;
+    guint64 hits, misses;
+} thumbnails;
+
+// Con las dimensiones reales ya conocidas, pedir al loader el tamaño mínimo que cubre
+// el tile manteniendo la proporción; el sobrante se recorta después
+static void cover_size(int source_width, int source_height, int *width, int *height, gpointer user_data) {
+    CoverTarget *target = user_data;
+    double scale = MAX((double)target->width / source_width, (double)target->height / source_height);
+    if (scale >= 1.0) return;   // No se amplía aquí; si hace falta lo hace el recorte
+
+    *width = MAX(target->width, (int)(source_width * scale + 0.5));
+    *height = MAX(target->height, (int)(source_height * scale + 0.5));
+}
+
+// Recorte centrado al tamaño exacto (o escalado si la imagen era más pequeña que el tile)
+static GdkPixbuf *crop_to_cover(GdkPixbuf *pixbuf, int width, int height) {
+    int source_width = gdk_pixbuf_get_width(pixbuf);
+    int source_height = gdk_pixbuf_get_height(pixbuf);
+
+    if (source_width == width && source_height == height) {
+        return g_object_ref(pixbuf);
+    }
+
+    if (source_width < width || source_height < height) {
+        double scale = MAX((double)width / source_width, (double)height / source_height);
+        int scaled_width = MAX(width, (int)(source_width * scale + 0.5));
+        int scaled_height = MAX(height, (int)(source_height * scale + 0.5));
+        GdkPixbuf *scaled = gdk_pixbuf_scale_simple(pixbuf, scaled_width, scaled_height, GDK_INTERP_BILINEAR);
+        GdkPixbuf *cropped = crop_to_cover(scaled, width, height);
+        g_object_unref(scaled);
+        return cropped;
+    }
+
+    // La copia suelta el buffer sobrante
+    GdkPixbuf *sub = gdk_pixbuf_new_subpixbuf(pixbuf, (source_width - width) / 2, (source_height - height) / 2,
+                                              width, height);
+    GdkPixbuf *cropped = gdk_pixbuf_copy(sub);
+    g_object_unref(sub);
+    return cropped;
+}
+
+static GdkPixbuf *cover_from_thumbnail(GdkPixbuf *thumbnail, int width, int height);
+
+// Vista de jpeg_decode_view (ya reducida en el dominio DCT, entre 1× y 2× del tile):
+// orientar, llevar al tamaño mínimo que cubre y recortar. Siempre devuelve una copia,
+// porque los píxeles de la vista son el buffer del hilo
+static GdkPixbuf *cover_from_view(GdkPixbuf *view, int width, int height) {
+    TRACE_BEGIN(crop_start);
+    GdkPixbuf *oriented = gdk_pixbuf_apply_embedded_orientation(view);
+    GdkPixbuf *cover = cover_from_thumbnail(oriented, width, height);
+    if (!cover) cover = crop_to_cover(oriented, width, height);
+    if (cover == view) {
+        g_object_unref(cover);
+        cover = gdk_pixbuf_copy(view);
+    }
+    g_object_unref(oriented);
+    TRACE_END(crop_start, "crop", NULL);
+    return cover;
+}
+
+GdkPixbuf *image_loader_decode_cover(GBytes *bytes, int width, int height, GError **error) {
+    CoverTarget target = { MAX(width, 1), MAX(height, 1) };
+
+    if (jpeg_decode_available()) {
+        TRACE_BEGIN(jpeg_start);
+        GdkPixbuf *view = jpeg_decode_view(bytes, target.width, target.height, NULL, NULL);
+        if (view) {
+            TRACE_END(jpeg_start, "decode", "turbojpeg");
+            GdkPixbuf *cover = cover_from_view(view, target.width, target.height);
+            g_object_unref(view);
+            return cover;
+        }
+    }
+
+    TRACE_BEGIN(decode_start);
+    GdkPixbuf *pixbuf = decode_budget_load(bytes, cover_size, &target, error);
+    TRACE_END(decode_start, "decode", NULL);
+
+    GdkPixbuf *result = NULL;
+    if (pixbuf) {
+        // Respetar la orientación EXIF como hacía gdk_pixbuf_new_from_file_at_scale
+        TRACE_BEGIN(crop_start);
+        GdkPixbuf *oriented = gdk_pixbuf_apply_embedded_orientation(pixbuf);
+        result = crop_to_cover(oriented, target.width, target.height);
+        g_object_unref(oriented);
+        g_object_unref(pixbuf);
+        TRACE_END(crop_start, "crop", NULL);
+    }
+    return result;
+}
+
+// Reduce la miniatura al tamaño mínimo que cubre el tile y recorta; NULL si habría que
+// ampliarla (mejor decodificar el archivo que perder nitidez)
+static GdkPixbuf *cover_from_thumbnail(GdkPixbuf *thumbnail, int width, int height) {
+    int source_width = gdk_pixbuf_get_width(thumbnail);
+    int source_height = gdk_pixbuf_get_height(thumbnail);
+    double scale = MAX((double)width / source_width, (double)height / source_height);
+    if (scale > 1.0) return NULL;
+    if (scale == 1.0) return crop_to_cover(thumbnail, width, height);
+
+    int scaled_width = MAX(width, (int)(source_width * scale + 0.5));
+    int scaled_height = MAX(height, (int)(source_height * scale + 0.5));
+    GdkPixbuf *scaled = gdk_pixbuf_scale_simple(thumbnail, scaled_width, scaled_height, GDK_INTERP_BILINEAR);
+    GdkPixbuf *cropped = crop_to_cover(scaled, width, height);
+    g_object_unref(scaled);
+    return cropped;
+}
+
+static gsize thumbnail_size(GdkPixbuf *pixbuf) {
+    return (gsize)gdk_pixbuf_get_rowstride(pixbuf) * gdk_pixbuf_get_height(pixbuf);
+}
+
+// Quita la miniatura de path y la devuelve (con el lock tomado)
+static GdkPixbuf *steal_thumbnail(const char *path) {
+    gpointer key, value;
+    if (!thumbnails.pixbufs || !g_hash_table_lookup_extended(thumbnails.pixbufs, path, &key, &value)) {
+        return NULL;
+    }
+    g_queue_remove(&thumbnails.order, key);   // La cola comparte la clave de la tabla
+    g_hash_table_steal(thumbnails.pixbufs, path);
+    g_free(key);
+    thumbnails.bytes -= thumbnail_size(value);
+    ALLOC_STATS_SUB(ALLOC_DECODE, thumbnail_size(value));
+    return value;
+}
+
+void image_loader_offer_thumbnail(const char *path, GdkPixbuf *thumbnail) {
+    if (!path || !thumbnail || thumbnail_size(thumbnail) > IMAGE_LOADER_THUMBNAIL_BUDGET_BYTES) return;
+
+    g_mutex_lock(&thumbnails.lock);
+    if (!thumbnails.pixbufs) {
+        thumbnails.pixbufs = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_object_unref);
+    }
+    GdkPixbuf *previous = steal_thumbnail(path);
+    if (previous) g_object_unref(previous);
+
+    while (thumbnails.bytes + thumbnail_size(thumbnail) > IMAGE_LOADER_THUMBNAIL_BUDGET_BYTES) {
+        GdkPixbuf *oldest = steal_thumbnail(g_queue_peek_head(&thumbnails.order));
+        g_object_unref(oldest);
+    }
+
+    char *key = g_strdup(path);
+    g_hash_table_insert(thumbnails.pixbufs, key, g_object_ref(thumbnail));
+    g_queue_push_tail(&thumbnails.order, key);
+    thumbnails.bytes += thumbnail_size(thumbnail);
+    ALLOC_STATS_ADD(ALLOC_DECODE, thumbnail_size(thumbnail));
+    g_mutex_unlock(&thumbnails.lock);
+}
+
+gboolean image_loader_has_thumbnail(const char *path) {
+    g_mutex_lock(&thumbnails.lock);
+    gboolean found = thumbnails.pixbufs && g_hash_table_contains(thumbnails.pixbufs, path);
+    g_mutex_unlock(&thumbnails.lock);
+    return found || shared_thumbnail_known(path);
+}
+
+void image_loader_clear_thumbnails(void) {
+    g_mutex_lock(&thumbnails.lock);
+    if (thumbnails.hits + thumbnails.misses > 0) {
+        g_print("🖼️  Miniaturas de la ingesta: %" G_GUINT64_FORMAT " tiles sin segunda decodificación, %"
+                G_GUINT64_FORMAT " demasiado pequeñas\n", thumbnails.hits, thumbnails.misses);
+    }
+    g_queue_clear(&thumbnails.order);
+    g_clear_pointer(&thumbnails.pixbufs, g_hash_table_destroy);
+    ALLOC_STATS_SUB(ALLOC_DECODE, thumbnails.bytes);
+    thumbnails.bytes = 0;
+    thumbnails.hits = thumbnails.misses = 0;
+    g_mutex_unlock(&thumbnails.lock);
+}
+
+GdkPixbuf *image_loader_load_cover(const char *path, int width, int height, GError **error) {
+    g_mutex_lock(&thumbnails.lock);
+    GdkPixbuf *thumbnail = steal_thumbnail(path);
+    g_mutex_unlock(&thumbnails.lock);
+
+    if (thumbnail) {
+        TRACE_BEGIN(thumbnail_start);
+        GdkPixbuf *cover = cover_from_thumbnail(thumbnail, width, height);
+        TRACE_END(thumbnail_start, "thumbnail", path);
+        g_object_unref(thumbnail);
+
+        g_mutex_lock(&thumbnails.lock);
+        if (cover) thumbnails.hits++; else thumbnails.misses++;
+        g_mutex_unlock(&thumbnails.lock);
+        if (cover) return cover;
+    }
+
+    // Miniatura freedesktop de tamaño suficiente: tampoco se lee el original
+    GdkPixbuf *shared = shared_thumbnail_lookup(path, width, height, NULL, NULL);
+    if (shared) {
+        GdkPixbuf *cover = cover_from_thumbnail(shared, width, height);
+        g_object_unref(shared);
+        if (cover) return cover;   // Lo que el prefetch ya leyó lo expulsa su presupuesto
+    }
+
+    TRACE_BEGIN(take_start);
+    GBytes *bytes = prefetch_take(path, error);
+    TRACE_END(take_start, "take", path);
+    if (!bytes) return NULL;
+
+    GdkPixbuf *pixbuf = image_loader_decode_cover(bytes, width, height, error);
+    g_bytes_unref(bytes);
+    return pixbuf;
+}
@@ -0,0 +1,23 @@
+#ifndef IMAGE_LOADER_H
+#define IMAGE_LOADER_H
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+// Decodificación de tiles desde memoria: el archivo llega como GBytes (ver prefetch.h)
+// y GdkPixbufLoader lo escala ya durante la decodificación, de modo que el tile nunca se
+// guarda a resolución completa. Los JPEG van por libjpeg-turbo si está disponible (ver
+// jpeg_decode.h), que además decodifica ya reducido en el dominio DCT.
+GdkPixbuf *image_loader_decode_cover(GBytes *bytes, int width, int height, GError **error);
+GdkPixbuf *image_loader_load_cover(const char *path, int width, int height, GError **error);
+
+// Miniaturas de la ingesta (ver ingest.h) para el primer decode de cada tile: si cubren
+// el tamaño pedido, load_cover recorta de ellas sin volver a leer el archivo. Se usan
+// una sola vez y se expulsan por antigüedad por encima del presupuesto
+#define IMAGE_LOADER_THUMBNAIL_BUDGET_BYTES (64 * 1024 * 1024)
+
+void image_loader_offer_thumbnail(const char *path, GdkPixbuf *thumbnail);
+// También TRUE si path tiene miniatura compartida (shared_thumbnails.h): no hace falta prefetch
+gboolean image_loader_has_thumbnail(const char *path);
+void image_loader_clear_thumbnails(void);
+
+#endif // IMAGE_LOADER_H
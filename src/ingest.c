@@ -0,0 +1,133 @@
+#include <stdlib.h>
+#include "ingest.h"
+#include "decode_budget.h"
+#include "jpeg_decode.h"
+#include "shared_thumbnails.h"
+
+typedef struct {
+    int thumbnail_width;
+    int source_width;
+    int source_height;
+} IngestTarget;
+
+// Ancho fijo y alto proporcional: el tile recorta luego a su alto (tipo cover).
+// Con orientación EXIF de 90° el ancho visible es el alto del archivo; esas imágenes
+// salen algo más estrechas y su primer tile se vuelve a decodificar
+static void thumbnail_size(int source_width, int source_height, int *width, int *height, gpointer user_data) {
+    IngestTarget *target = user_data;
+    target->source_width = source_width;
+    target->source_height = source_height;
+    if (source_width <= target->thumbnail_width) return;
+
+    *width = target->thumbnail_width;
+    *height = MAX(1, (int)((double)source_height * target->thumbnail_width / source_width + 0.5));
+}
+
+static void fill_result(IngestResult *out, const IngestTarget *target, gboolean rotated, GdkPixbuf *thumbnail) {
+    out->width = rotated ? target->source_height : target->source_width;
+    out->height = rotated ? target->source_width : target->source_height;
+    out->color = get_average_color(thumbnail);
+    out->hash = phash_compute_pixbuf(thumbnail);
+    out->thumbnail = thumbnail;
+}
+
+// Camino libjpeg-turbo: la vista llega reducida en el dominio DCT y ya se sabe la
+// orientación, así que la miniatura sale con el ancho visible exacto (también en
+// fotos giradas). Se copia siempre: la vista es el buffer del hilo
+static GdkPixbuf *thumbnail_from_view(GdkPixbuf *view, int thumbnail_width) {
+    GdkPixbuf *oriented = gdk_pixbuf_apply_embedded_orientation(view);
+    int width = gdk_pixbuf_get_width(oriented);
+    int height = gdk_pixbuf_get_height(oriented);
+
+    GdkPixbuf *thumbnail;
+    if (width > thumbnail_width) {
+        int scaled_height = MAX(1, (int)((double)height * thumbnail_width / width + 0.5));
+        thumbnail = gdk_pixbuf_scale_simple(oriented, thumbnail_width, scaled_height, GDK_INTERP_BILINEAR);
+    } else {
+        thumbnail = gdk_pixbuf_copy(oriented);
+    }
+    g_object_unref(oriented);
+    return thumbnail;
+}
+
+gboolean ingest_decode(GBytes *bytes, int thumbnail_width, IngestResult *out, GError **error) {
+    IngestTarget target = { MAX(thumbnail_width, 1), 0, 0 };
+
+    GdkPixbuf *view = jpeg_decode_view(bytes, target.thumbnail_width, 1, &target.source_width, &target.source_height);
+    if (view) {
+        const char *orientation = gdk_pixbuf_get_option(view, "orientation");
+        gboolean rotated = orientation && atoi(orientation) >= 5;
+        fill_result(out, &target, rotated, thumbnail_from_view(view, target.thumbnail_width));
+        g_object_unref(view);
+        return TRUE;
+    }
+
+    // A trozos y dentro del presupuesto de memoria (ver decode_budget.h)
+    GdkPixbuf *pixbuf = decode_budget_load(bytes, thumbnail_size, &target, error);
+    if (!pixbuf) return FALSE;
+
+    GdkPixbuf *oriented = gdk_pixbuf_apply_embedded_orientation(pixbuf);
+    gboolean rotated = gdk_pixbuf_get_width(oriented) != gdk_pixbuf_get_width(pixbuf);
+    fill_result(out, &target, rotated, oriented);
+
+    g_object_unref(pixbuf);
+    return TRUE;
+}
+
+// Reduce al ancho de la ingesta; referencia nueva, sin copiar si ya lo tiene
+static GdkPixbuf *scale_to_width(GdkPixbuf *pixbuf, int width) {
+    int source_width = gdk_pixbuf_get_width(pixbuf);
+    if (source_width <= width) return g_object_ref(pixbuf);
+    int height = MAX(1, (int)((double)gdk_pixbuf_get_height(pixbuf) * width / source_width + 0.5));
+    return gdk_pixbuf_scale_simple(pixbuf, width, height, GDK_INTERP_BILINEAR);
+}
+
+gboolean ingest_file(const char *path, int thumbnail_width, IngestResult *out, GError **error) {
+    thumbnail_width = MAX(thumbnail_width, 1);
+
+    // Miniatura del gestor de archivos: ni se abre el original
+    int source_width = 0, source_height = 0;
+    GdkPixbuf *shared = shared_thumbnail_lookup(path, thumbnail_width, 1, &source_width, &source_height);
+    if (shared) {
+        out->width = source_width;
+        out->height = source_height;
+        out->thumbnail = scale_to_width(shared, thumbnail_width);
+        out->color = get_average_color(out->thumbnail);
+        out->hash = phash_compute_pixbuf(out->thumbnail);
+        g_object_unref(shared);
+        return TRUE;
+    }
+
+    // Sin ella se decodifica al tamaño x-large para poder escribirla de vuelta, pero solo
+    // si la escritura tiene hueco en la cola: si no, se descartaría tras pagar el decode
+    gboolean store = thumbnail_width < SHARED_THUMBNAIL_STORE_SIZE && shared_thumbnail_reserve(path);
+    int decode_width = store ? SHARED_THUMBNAIL_STORE_SIZE : thumbnail_width;
+
+    // Mapeado: un archivo enorme no se copia entero a memoria anónima
+    GMappedFile *mapped = g_mapped_file_new(path, FALSE, error);
+    if (!mapped) {
+        if (store) shared_thumbnail_release();
+        return FALSE;
+    }
+
+    GBytes *bytes = g_mapped_file_get_bytes(mapped);
+    gboolean ok = ingest_decode(bytes, decode_width, out, error);
+    g_bytes_unref(bytes);
+    g_mapped_file_unref(mapped);
+
+    if (store && !ok) shared_thumbnail_release();
+    if (store && ok) {
+        shared_thumbnail_store(path, out->thumbnail, out->width, out->height);
+        GdkPixbuf *thumbnail = scale_to_width(out->thumbnail, thumbnail_width);
+        g_object_unref(out->thumbnail);
+        out->thumbnail = thumbnail;
+        // Color y hash de la miniatura que se queda, como sin miniaturas compartidas
+        out->color = get_average_color(thumbnail);
+        out->hash = phash_compute_pixbuf(thumbnail);
+    }
+    return ok;
+}
+
+void ingest_result_clear(IngestResult *result) {
+    g_clear_object(&result->thumbnail);
+}
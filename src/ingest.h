@@ -0,0 +1,24 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include "color_analysis.h"
+#include "phash.h"
+
+// Ingesta en una sola pasada: cada archivo se decodifica una vez, ya reducido al ancho
+// del tile, y de ese mismo buffer salen las dimensiones para el layout, el color
+// dominante, el hash perceptual y los píxeles del primer tile (ver
+// image_loader_offer_thumbnail). Antes eran tres decodificaciones, dos a tamaño completo.
+typedef struct {
+    int width;              // Dimensiones originales, ya con la orientación EXIF aplicada
+    int height;
+    Color color;
+    PHash hash;
+    GdkPixbuf *thumbnail;   // thumbnail_width de ancho (nunca ampliada); de quien llama
+} IngestResult;
+
+gboolean ingest_decode(GBytes *bytes, int thumbnail_width, IngestResult *out, GError **error);
+gboolean ingest_file(const char *path, int thumbnail_width, IngestResult *out, GError **error);
+void ingest_result_clear(IngestResult *result);
+
+#endif // INGEST_H
@@ -0,0 +1,199 @@
+#include <string.h>
+#include "jpeg_decode.h"
+#include "alloc_stats.h"
+#include "decode_budget.h"
+
+#ifdef HAVE_TURBOJPEG
+#include <turbojpeg.h>
+
+// Un decodificador y un buffer de salida por hilo: los hilos de decodificación y de
+// ingesta son fijos, así que tras los primeros tiles ya no se reserva nada
+typedef struct {
+    tjhandle handle;
+    guchar *pixels;
+    gsize capacity;
+} JpegDecoder;
+
+// Un buffer mayor (tras un JPEG enorme sin escala que lo reduzca) no se queda en el hilo
+#define JPEG_RETAINED_BYTES (8 * 1024 * 1024)
+
+static gboolean backend_enabled = TRUE;
+
+static void decoder_free(gpointer data) {
+    JpegDecoder *decoder = data;
+    if (decoder->handle) tjDestroy(decoder->handle);
+    ALLOC_STATS_SUB(ALLOC_DECODE, decoder->capacity);
+    g_free(decoder->pixels);
+    g_free(decoder);
+}
+
+static GPrivate thread_decoder = G_PRIVATE_INIT(decoder_free);
+
+static JpegDecoder *get_decoder(void) {
+    JpegDecoder *decoder = g_private_get(&thread_decoder);
+    if (!decoder) {
+        decoder = g_new0(JpegDecoder, 1);
+        decoder->handle = tjInitDecompress();
+        g_private_set(&thread_decoder, decoder);
+    }
+    return decoder->handle ? decoder : NULL;
+}
+
+static guchar *reserve_pixels(JpegDecoder *decoder, gsize size) {
+    if (size > decoder->capacity || (decoder->capacity > JPEG_RETAINED_BYTES && size <= JPEG_RETAINED_BYTES)) {
+        ALLOC_STATS_SUB(ALLOC_DECODE, decoder->capacity);
+        g_free(decoder->pixels);
+        decoder->pixels = g_malloc(size);
+        decoder->capacity = size;
+        ALLOC_STATS_ADD(ALLOC_DECODE, size);
+    }
+    return decoder->pixels;
+}
+
+static guint read16(const guint8 *p, gboolean little_endian) {
+    return little_endian ? (guint)(p[0] | p[1] << 8) : (guint)(p[0] << 8 | p[1]);
+}
+
+static guint32 read32(const guint8 *p, gboolean little_endian) {
+    return little_endian ? (guint32)p[0] | (guint32)p[1] << 8 | (guint32)p[2] << 16 | (guint32)p[3] << 24
+                         : (guint32)p[0] << 24 | (guint32)p[1] << 16 | (guint32)p[2] << 8 | (guint32)p[3];
+}
+
+// Etiqueta Orientation (0x0112) del primer IFD de un bloque TIFF
+static int tiff_orientation(const guint8 *tiff, gsize size) {
+    if (size < 8) return 1;
+    gboolean little_endian = tiff[0] == 'I' && tiff[1] == 'I';
+    if (!little_endian && !(tiff[0] == 'M' && tiff[1] == 'M')) return 1;
+
+    guint32 ifd = read32(tiff + 4, little_endian);
+    if (ifd > size - 2) return 1;
+    guint count = read16(tiff + ifd, little_endian);
+    for (guint i = 0; i < count; i++) {
+        gsize entry = ifd + 2 + (gsize)i * 12;
+        if (entry + 12 > size) break;
+        if (read16(tiff + entry, little_endian) == 0x0112) {
+            guint value = read16(tiff + entry + 8, little_endian);
+            return value >= 1 && value <= 8 ? (int)value : 1;
+        }
+    }
+    return 1;
+}
+
+// Orientación EXIF (1-8) del segmento APP1, o 1 si no hay; solo recorre las cabeceras
+static int exif_orientation(const guint8 *data, gsize size) {
+    gsize pos = 2;   // Tras SOI
+    while (pos + 4 <= size && data[pos] == 0xFF) {
+        guint8 marker = data[pos + 1];
+        if (marker == 0xDA || marker == 0xD9) break;   // SOS: empiezan los datos comprimidos
+        gsize length = read16(data + pos + 2, FALSE);
+        if (length < 2 || pos + 2 + length > size) break;
+
+        const guint8 *segment = data + pos + 4;
+        gsize segment_size = length - 2;
+        if (marker == 0xE1 && segment_size > 6 && memcmp(segment, "Exif\0\0", 6) == 0) {
+            return tiff_orientation(segment + 6, segment_size - 6);
+        }
+        pos += 2 + length;
+    }
+    return 1;
+}
+
+// Menor factor de escala (≤ 1) con el que la imagen sigue cubriendo el mínimo
+static tjscalingfactor pick_scaling_factor(int width, int height, int min_width, int min_height) {
+    tjscalingfactor best = { 1, 1 };
+    int count = 0;
+    tjscalingfactor *factors = tjGetScalingFactors(&count);
+    for (int i = 0; factors && i < count; i++) {
+        tjscalingfactor factor = factors[i];
+        if (factor.num > factor.denom) continue;
+        if (TJSCALED(width, factor) < min_width || TJSCALED(height, factor) < min_height) continue;
+        if ((double)factor.num / factor.denom < (double)best.num / best.denom) best = factor;
+    }
+    return best;
+}
+
+// La vista devuelve su parte del presupuesto de decodificación al liberarse
+static void release_view(G_GNUC_UNUSED guchar *pixels, gpointer data) {
+    decode_budget_release(GPOINTER_TO_SIZE(data));
+}
+
+gboolean jpeg_decode_available(void) {
+    return backend_enabled;
+}
+
+void jpeg_decode_set_enabled(gboolean enabled) {
+    backend_enabled = enabled;
+}
+
+const char *jpeg_decode_backend_name(void) {
+    return backend_enabled ? "turbojpeg" : "gdk-pixbuf";
+}
+
+GdkPixbuf *jpeg_decode_view(GBytes *bytes, int min_width, int min_height,
+                            int *source_width, int *source_height) {
+    gsize size = 0;
+    const guint8 *data = g_bytes_get_data(bytes, &size);
+    if (!backend_enabled || size < 4 || data[0] != 0xFF || data[1] != 0xD8 || data[2] != 0xFF) return NULL;
+
+    JpegDecoder *decoder = get_decoder();
+    if (!decoder) return NULL;
+
+    int width = 0, height = 0, subsampling = 0, colorspace = 0;
+    if (tjDecompressHeader3(decoder->handle, data, size, &width, &height, &subsampling, &colorspace) != 0 ||
+        width <= 0 || height <= 0) {
+        return NULL;
+    }
+    // CMYK/YCCK no se convierte a RGB aquí; GdkPixbuf sí sabe
+    if (colorspace == TJCS_CMYK || colorspace == TJCS_YCCK) return NULL;
+
+    // Con 90° (orientaciones 5-8) el ancho visible es el alto del archivo
+    int orientation = exif_orientation(data, size);
+    gboolean rotated = orientation >= 5;
+    tjscalingfactor factor = pick_scaling_factor(width, height,
+                                                 MAX(rotated ? min_height : min_width, 1),
+                                                 MAX(rotated ? min_width : min_height, 1));
+    int scaled_width = TJSCALED(width, factor);
+    int scaled_height = TJSCALED(height, factor);
+    int stride = (scaled_width * 3 + 3) & ~3;
+    gsize pixel_bytes = (gsize)stride * scaled_height;
+    if (!decode_budget_acquire((gint64)scaled_width * scaled_height, pixel_bytes)) return NULL;
+    guchar *pixels = reserve_pixels(decoder, pixel_bytes);
+
+    if (tjDecompress2(decoder->handle, data, size, pixels, scaled_width, stride, scaled_height,
+                      TJPF_RGB, 0) != 0 && tjGetErrorCode(decoder->handle) != TJERR_WARNING) {
+        decode_budget_release(pixel_bytes);
+        return NULL;   // Las advertencias (datos truncados al final, etc.) dejan una imagen usable
+    }
+
+    if (source_width) *source_width = width;
+    if (source_height) *source_height = height;
+
+    GdkPixbuf *view = gdk_pixbuf_new_from_data(pixels, GDK_COLORSPACE_RGB, FALSE, 8,
+                                               scaled_width, scaled_height, stride,
+                                               release_view, GSIZE_TO_POINTER(pixel_bytes));
+    if (orientation != 1) {
+        char value[2] = { (char)('0' + orientation), '\0' };
+        gdk_pixbuf_set_option(view, "orientation", value);
+    }
+    return view;
+}
+
+#else // !HAVE_TURBOJPEG
+
+gboolean jpeg_decode_available(void) {
+    return FALSE;
+}
+
+void jpeg_decode_set_enabled(G_GNUC_UNUSED gboolean enabled) {
+}
+
+const char *jpeg_decode_backend_name(void) {
+    return "gdk-pixbuf";
+}
+
+GdkPixbuf *jpeg_decode_view(G_GNUC_UNUSED GBytes *bytes, G_GNUC_UNUSED int min_width, G_GNUC_UNUSED int min_height,
+                            G_GNUC_UNUSED int *source_width, G_GNUC_UNUSED int *source_height) {
+    return NULL;
+}
+
+#endif // HAVE_TURBOJPEG
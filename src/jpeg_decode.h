@@ -0,0 +1,26 @@
+#ifndef JPEG_DECODE_H
+#define JPEG_DECODE_H
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+// Backend JPEG opcional con libjpeg-turbo (se compila si el Makefile encuentra
+// libturbojpeg; ver HAVE_TURBOJPEG). Decodifica directamente a 1/8, 1/4, 1/2... en el
+// dominio DCT con la IDCT SIMD, en vez de pasar por la resolución completa como el
+// loader JPEG de GdkPixbuf. Los demás formatos siguen por GdkPixbufLoader.
+
+// FALSE si no se compiló o se desactivó con jpeg_decode_set_enabled
+gboolean jpeg_decode_available(void);
+void jpeg_decode_set_enabled(gboolean enabled);
+const char *jpeg_decode_backend_name(void);
+
+// Si bytes es un JPEG, lo decodifica a la menor escala DCT cuyo resultado, ya con la
+// orientación EXIF aplicada, sigue cubriendo min_width × min_height. Devuelve un pixbuf
+// RGB con la opción "orientation" puesta (para gdk_pixbuf_apply_embedded_orientation)
+// cuyos píxeles son el buffer reutilizable del hilo: vale hasta la siguiente llamada
+// desde el mismo hilo, así que quien llama escala o copia antes de quedárselo.
+// source_width/height (opcionales): dimensiones del archivo, sin orientar.
+// NULL = no es JPEG, no hay backend o no se pudo: usar GdkPixbufLoader
+GdkPixbuf *jpeg_decode_view(GBytes *bytes, int min_width, int min_height,
+                            int *source_width, int *source_height);
+
+#endif // JPEG_DECODE_H
@@ -20,6 +20,28 @@ gboolean layer_shell_is_supported(void) {
     return gtk_layer_is_supported();
 }
 
+GdkMonitor *layer_shell_find_monitor(GdkDisplay *display, const char *monitor_name) {
+    if (!display) {
+        return NULL;
+    }
+    
+    GListModel *monitors = gdk_display_get_monitors(display);
+    guint n_monitors = g_list_model_get_n_items(monitors);
+    
+    for (guint i = 0; i < n_monitors; i++) {
+        GdkMonitor *monitor = g_list_model_get_item(monitors, i);
+        const char *connector = gdk_monitor_get_connector(monitor);
+        
+        if (!monitor_name || (connector && strcmp(connector, monitor_name) == 0)) {
+            return monitor;
+        }
+        g_object_unref(monitor);
+    }
+    
+    // Not found: fall back to the first monitor so callers still get real geometry
+    return n_monitors > 0 ? g_list_model_get_item(monitors, 0) : NULL;
+}
+
 void layer_shell_init_window_for_monitor(GtkWindow *window, const char *monitor_name) {
     if (!layer_shell_is_supported()) {
         g_print("Layer shell not supported, falling back to regular window mode\n");
@@ -53,19 +75,15 @@ void layer_shell_init_window_for_monitor(GtkWindow *window, const char *monitor_
     // Set monitor if specified
     if (monitor_name && strlen(monitor_name) > 0) {
         GdkDisplay *display = gtk_widget_get_display(GTK_WIDGET(window));
-        GListModel *monitors = gdk_display_get_monitors(display);
-        guint n_monitors = g_list_model_get_n_items(monitors);
+        GdkMonitor *monitor = layer_shell_find_monitor(display, monitor_name);
         
-        for (guint i = 0; i < n_monitors; i++) {
-            GdkMonitor *monitor = g_list_model_get_item(monitors, i);
-            const char *connector = gdk_monitor_get_connector(monitor);
-            
-            if (connector && strcmp(connector, monitor_name) == 0) {
-                gtk_layer_set_monitor(window, monitor);
-                g_print("Layer shell configured for monitor: %s\n", monitor_name);
-                g_object_unref(monitor);
-                return;
-            }
+        if (monitor && g_strcmp0(gdk_monitor_get_connector(monitor), monitor_name) == 0) {
+            gtk_layer_set_monitor(window, monitor);
+            g_print("Layer shell configured for monitor: %s\n", monitor_name);
+            g_object_unref(monitor);
+            return;
+        }
+        if (monitor) {
             g_object_unref(monitor);
         }
         g_print("Monitor '%s' not found, using default\n", monitor_name);
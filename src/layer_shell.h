@@ -6,6 +6,7 @@
 
 // Layer shell initialization and configuration
 gboolean layer_shell_is_supported(void);
+GdkMonitor *layer_shell_find_monitor(GdkDisplay *display, const char *monitor_name);
 void layer_shell_init_window(GtkWindow *window);
 void layer_shell_init_window_for_monitor(GtkWindow *window, const char *monitor_name);
 void layer_shell_configure_wallpaper(GtkWindow *window);
@@ -1,5 +1,13 @@
 #include "layout.h"
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <math.h>
+#include <string.h>
+#include "alloc_stats.h"
+
+// Lo que retiene el layout por imagen: la estructura, su ruta y el nodo de la lista
+static gsize image_info_bytes(const ImageInfo *info) {
+    return sizeof(ImageInfo) + strlen(info->path) + 1 + sizeof(GList);
+}
 
 static ImageInfo* create_image_info(const char *path, GHashTable *loaded_paths) {
     // Check if we've already loaded this image
@@ -12,19 +20,14 @@ static ImageInfo* create_image_info(const char *path, GHashTable *loaded_paths)
     info->path = g_strdup(path);
     g_hash_table_add(loaded_paths, info->path);
     
-    // Load image to get dimensions
-    GError *error = NULL;
-    GdkPixbuf *pixbuf = gdk_pixbuf_new_from_file(path, &error);
-    if (pixbuf) {
-        info->original_width = gdk_pixbuf_get_width(pixbuf);
-        info->original_height = gdk_pixbuf_get_height(pixbuf);
+    // Solo la cabecera: las dimensiones no justifican decodificar la imagen
+    if (gdk_pixbuf_get_file_info(path, &info->original_width, &info->original_height) &&
+        info->original_width > 0 && info->original_height > 0) {
         info->aspect_ratio = (double)info->original_width / info->original_height;
         g_print("Loaded image: %s (%dx%d, ratio: %.2f)\n", 
                 path, info->original_width, info->original_height, info->aspect_ratio);
-        g_object_unref(pixbuf);
     } else {
-        g_warning("Could not load image %s: %s", path, error->message);
-        g_error_free(error);
+        g_warning("Could not read image size %s", path);
         info->original_width = 300;
         info->original_height = 300;
         info->aspect_ratio = 1.0;
@@ -33,17 +36,57 @@ static ImageInfo* create_image_info(const char *path, GHashTable *loaded_paths)
     return info;
 };
 
+// images se rehace entera (reorder, calculate): el último nodo se vuelve a buscar una vez
+static void set_images(MasonryLayout *layout, GList *images) {
+    layout->images = images;
+    layout->images_tail = g_list_last(images);
+}
+
+// Al final de images sin recorrerla (g_list_append desde el último nodo)
+static void append_image(MasonryLayout *layout, ImageInfo *info) {
+    if (!layout->images_tail) {
+        set_images(layout, g_list_prepend(NULL, info));
+        return;
+    }
+    g_list_append(layout->images_tail, info);
+    layout->images_tail = layout->images_tail->next;
+}
+
 void masonry_layout_init(MasonryLayout *layout, int grid_width, int row_height, int spacing) {
-    layout->images = NULL;
-    layout->grid_width = grid_width;
+    set_images(layout, NULL);
     layout->row_height = row_height;
     layout->spacing = spacing;
+    layout->balance_lookahead = BALANCE_LOOKAHEAD;
+    layout->content_height = 0;
+    masonry_layout_set_viewport(layout, grid_width, 1.0);
     
-    // Crear hash table único para esta instancia del layout
-    layout->loaded_paths = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    // Crear hash table único para esta instancia del layout (las claves son info->path,
+    // que libera masonry_layout_free junto con cada imagen)
+    layout->loaded_paths = g_hash_table_new(g_str_hash, g_str_equal);
+}
+
+// Columnas y ancho de tile a partir del ancho real del monitor: tantas columnas de
+// ~STANDARD_WIDTH como quepan, y luego se reparte el sobrante para llenar el ancho
+void masonry_layout_set_viewport(MasonryLayout *layout, int grid_width, double scale) {
+    layout->grid_width = grid_width > 0 ? grid_width : DEFAULT_MONITOR_WIDTH;
+    layout->scale = scale > 0.0 ? scale : 1.0;
+
+    int available = layout->grid_width - (IMAGE_SPACING * 4) - GRID_CSS_CHROME;
+    int slot = STANDARD_WIDTH + TILE_CSS_CHROME + IMAGE_SPACING;
+    int columns = (available + IMAGE_SPACING) / slot;
+    if (columns < MIN_COLUMNS) columns = MIN_COLUMNS;
+
+    int width = (available - (columns - 1) * IMAGE_SPACING) / columns - TILE_CSS_CHROME;
+    layout->num_columns = columns;
+    layout->column_width = MAX(width, STANDARD_WIDTH / 2);
 }
 
-static void classify_and_size_image(ImageInfo *info) {
+// Tamaño en píxeles de dispositivo para decodificar exactamente lo que se va a mostrar
+int masonry_layout_device_size(const MasonryLayout *layout, int logical_size) {
+    return (int)ceil(logical_size * layout->scale);
+}
+
+static void classify_and_size_image(ImageInfo *info, int tile_width) {
     // Determine aspect ratio and type
     if (info->original_height > 0) {
         info->aspect_ratio = (double)info->original_width / (double)info->original_height;
@@ -59,145 +102,248 @@ static void classify_and_size_image(ImageInfo *info) {
         info->image_type = IMAGE_SQUARE;
     }
 
-    // All cards share the same width; height adapts to the image (Pinterest-style)
-    info->target_width  = STANDARD_WIDTH;
+    // All cards share the column width; height adapts to the image (Pinterest-style)
+    info->target_width  = tile_width;
     if (info->aspect_ratio <= 0.0) {
-        info->target_height = STANDARD_WIDTH; // safety
+        info->target_height = tile_width; // safety
     } else {
         // height = width / (w/h)
         info->target_height = (int) ((double)info->target_width / info->aspect_ratio + 0.5);
     }
-    // Clamp absurdly tall items to avoid runaway (optional soft cap)
-    if (info->image_type == IMAGE_VERTICAL && info->target_height > MAX_VERTICAL_HEIGHT) {
-        info->target_height = MAX_VERTICAL_HEIGHT;
+    // Clamp absurdly tall items to avoid runaway (optional soft cap, scaled with the column)
+    int max_height = MAX_VERTICAL_HEIGHT * tile_width / STANDARD_WIDTH;
+    if (info->image_type == IMAGE_VERTICAL && info->target_height > max_height) {
+        info->target_height = max_height;
     }
 }
 
-static void calculate_row_layout(GList *start, int count) {
-    if (count == 0) return;
+// Min-heap de alturas de columna: la raíz es siempre la columna más corta.
+// Empate por índice de columna para que el reparto sea determinista.
+typedef struct {
+    int height;
+    int column;
+} ColumnSlot;
 
-    int current_count = 0;
-    double row_width = 0;
-    GList *l = start;
+static gboolean column_slot_less(const ColumnSlot *a, const ColumnSlot *b) {
+    return a->height < b->height || (a->height == b->height && a->column < b->column);
+}
 
-    // Calcular tamaños y limitar imágenes por fila
-    while (l && current_count < MAX_IMAGES_PER_ROW) {
-        ImageInfo *info = l->data;
-        
-        // Clasificar y asignar tamaño estándar
-        classify_and_size_image(info);
-        
-        // Verificar si la imagen cabe en la fila actual
-        double new_width = row_width + info->target_width;
-        if (current_count > 0) {
-            new_width += IMAGE_SPACING;
-        }
-        
-        if (new_width > WINDOW_WIDTH - (IMAGE_SPACING * 2)) {
-            break;
-        }
-        
-        row_width = new_width;
-        current_count++;
-        l = l->next;
+static void column_heap_sift_down(ColumnSlot *heap, int size, int index) {
+    for (;;) {
+        int smallest = index;
+        int left = 2 * index + 1;
+        int right = left + 1;
+        if (left < size && column_slot_less(&heap[left], &heap[smallest])) smallest = left;
+        if (right < size && column_slot_less(&heap[right], &heap[smallest])) smallest = right;
+        if (smallest == index) return;
+
+        ColumnSlot tmp = heap[index];
+        heap[index] = heap[smallest];
+        heap[smallest] = tmp;
+        index = smallest;
     }
+}
 
-    // Ajustar alturas si es necesario para mantener proporciones
-    l = start;
-    for (int i = 0; i < current_count && l; i++) {
-        ImageInfo *info = l->data;
-        double target_ratio = (double)info->target_width / info->target_height;
-        
-        // Si la proporción es significativamente diferente, ajustar altura
-        if (fabs(target_ratio - info->aspect_ratio) > 0.01) {
-            info->target_height = info->target_width / info->aspect_ratio;
-        }
-        l = l->next;
+// Para la cola: las más altas primero (LPT), empate por ruta para ser deterministas
+static int compare_tail_by_height(const void *a, const void *b) {
+    const ImageInfo *ia = *(ImageInfo * const *)a;
+    const ImageInfo *ib = *(ImageInfo * const *)b;
+    if (ia->target_height != ib->target_height) {
+        return ib->target_height - ia->target_height;
     }
+    return g_strcmp0(ia->path, ib->path);
 }
 
+// Iguala el alto de las columnas repartiendo la diferencia con la media entre sus
+// últimos `lookahead` tiles, sin cambiar ninguno más de BALANCE_MAX_STRETCH
+static void balance_columns(GPtrArray **column_tiles, int *heights, int num_columns, int lookahead) {
+    gint64 total = 0;
+    for (int c = 0; c < num_columns; c++) total += heights[c];
+    int target = (int)((total + num_columns / 2) / num_columns);
 
-static GList *find_similar_images(GList *start, ImageInfo *reference, int max_count, int available_width) {
-    GList *group = NULL;
-    ImageType target_type = reference->image_type;
-    int count = 0;
-    double total_width = 0;
-    int required_count = (target_type == IMAGE_VERTICAL) ? 2 : 3;
-    
-    // First pass: count available similar images
-    int available_count = 0;
-    for (GList *l = start; l && available_count < max_count; l = l->next) {
-        ImageInfo *info = l->data;
-        if (info->image_type == target_type) {
-            available_count++;
+    for (int c = 0; c < num_columns; c++) {
+        GPtrArray *tiles = column_tiles[c];
+        int deficit = target - heights[c];
+        if (deficit == 0 || tiles->len == 0) continue;
+
+        guint first = tiles->len > (guint)lookahead ? tiles->len - lookahead : 0;
+        int window_height = 0;
+        for (guint i = first; i < tiles->len; i++) {
+            window_height += ((ImageInfo *)g_ptr_array_index(tiles, i))->target_height;
         }
-    }
-    
-    // If not enough vertical images, try squares instead
-    if (target_type == IMAGE_VERTICAL && available_count < required_count) {
-        target_type = IMAGE_SQUARE;
-        max_count = 3;
-    }
-    
-    for (GList *l = start; l && count < max_count; l = l->next) {
-        ImageInfo *info = l->data;
-        if (info->image_type == target_type) {
-            double standard_width = STANDARD_WIDTH;            if (total_width + standard_width + IMAGE_SPACING > available_width) {
-                break;
-            }
-            
-            group = g_list_append(group, info);
-            total_width += standard_width + IMAGE_SPACING;
-            count++;
+        if (window_height <= 0) continue;
+
+        int remaining = deficit;
+        for (guint i = first; i < tiles->len; i++) {
+            ImageInfo *info = g_ptr_array_index(tiles, i);
+            int limit = (int)(info->target_height * BALANCE_MAX_STRETCH);
+            int delta = (i == tiles->len - 1)
+                ? remaining
+                : (int)((double)deficit * info->target_height / window_height + (deficit > 0 ? 0.5 : -0.5));
+            delta = CLAMP(delta, -limit, limit);
+            info->target_height += delta;
+            remaining -= delta;
+        }
+
+        // Recolocar la columna con las nuevas alturas
+        int y = 0;
+        for (guint i = 0; i < tiles->len; i++) {
+            ImageInfo *info = g_ptr_array_index(tiles, i);
+            info->y = y;
+            y += info->target_height + TILE_VERTICAL_GAP;
         }
+        heights[c] = y > 0 ? y - TILE_VERTICAL_GAP : 0;
     }
-    
-    return group;
 }
 
 void masonry_layout_add_image(MasonryLayout *layout, const char *path) {
     ImageInfo *info = create_image_info(path, layout->loaded_paths);
     if (info) {  // Solo añadir si no es un duplicado
-        layout->images = g_list_append(layout->images, info);
+        append_image(layout, info);
+        ALLOC_STATS_ADD(ALLOC_LAYOUT, image_info_bytes(info));
+    }
+}
+
+// Igual que masonry_layout_add_image pero con dimensiones ya conocidas (sin decodificar)
+void masonry_layout_add_image_with_size(MasonryLayout *layout, const char *path, int width, int height) {
+    if (g_hash_table_contains(layout->loaded_paths, path)) {
+        return;
+    }
+
+    ImageInfo *info = g_new0(ImageInfo, 1);
+    info->path = g_strdup(path);
+    g_hash_table_add(layout->loaded_paths, info->path);
+
+    if (width > 0 && height > 0) {
+        info->original_width = width;
+        info->original_height = height;
+    } else {
+        info->original_width = 300;
+        info->original_height = 300;
     }
+    info->aspect_ratio = (double)info->original_width / info->original_height;
+
+    append_image(layout, info);
+    ALLOC_STATS_ADD(ALLOC_LAYOUT, image_info_bytes(info));
 }
 
+gboolean masonry_layout_replace_image(MasonryLayout *layout, ImageInfo *info, const char *path, int width, int height) {
+    if (g_hash_table_contains(layout->loaded_paths, path)) {
+        return FALSE;
+    }
+
+    ALLOC_STATS_SUB(ALLOC_LAYOUT, image_info_bytes(info));
+    g_hash_table_remove(layout->loaded_paths, info->path);
+    g_free(info->path);
+    info->path = g_strdup(path);
+    g_hash_table_add(layout->loaded_paths, info->path);
+    ALLOC_STATS_ADD(ALLOC_LAYOUT, image_info_bytes(info));
+
+    // Columna, y y tamaño del tile se quedan: la imagen nueva se recorta (cover) al hueco
+    // hasta el próximo masonry_layout_calculate
+    info->original_width = width > 0 ? width : 300;
+    info->original_height = height > 0 ? height : 300;
+    return TRUE;
+}
+
+// Reordena las imágenes ya cargadas sin volver a leerlas del disco.
+// Las rutas que no aparezcan en ordered_paths se mantienen al final en su orden actual.
+void masonry_layout_reorder(MasonryLayout *layout, GList *ordered_paths) {
+    GHashTable *by_path = g_hash_table_new(g_str_hash, g_str_equal);
+    for (GList *l = layout->images; l; l = l->next) {
+        ImageInfo *info = l->data;
+        g_hash_table_insert(by_path, info->path, info);
+    }
+
+    GList *reordered = NULL;
+    for (GList *l = ordered_paths; l; l = l->next) {
+        ImageInfo *info = g_hash_table_lookup(by_path, l->data);
+        if (info) {
+            reordered = g_list_prepend(reordered, info);
+            g_hash_table_remove(by_path, info->path);
+        }
+    }
+    for (GList *l = layout->images; l; l = l->next) {
+        ImageInfo *info = l->data;
+        if (g_hash_table_remove(by_path, info->path)) {
+            reordered = g_list_prepend(reordered, info);
+        }
+    }
+
+    g_list_free(layout->images);
+    set_images(layout, g_list_reverse(reordered));
+    g_hash_table_destroy(by_path);
+}
+
+// Reparte las imágenes en columnas de igual ancho: cada imagen va a la columna más
+// corta (min-heap, O(n log k)) conservando el orden de entrada, salvo la cola final,
+// que se coloca de mayor a menor altura y luego se balancea para que todas las
+// columnas terminen a la misma altura y el bucle del scroll no deje huecos abajo.
 void masonry_layout_calculate(MasonryLayout *layout) {
+    layout->content_height = 0;
     if (!layout->images) return;
 
-    int available_width = layout->grid_width - (2 * IMAGE_SPACING);
-    GList *current = layout->images;
-    GList *processed_images = NULL;
-
-    while (current) {
-        ImageInfo *info = current->data;
-        GList *group = find_similar_images(current, info, 
-                                         info->image_type == IMAGE_VERTICAL ? 2 : 3, 
-                                         available_width);
-        
-        if (group) {
-            int count = g_list_length(group);
-            // Calculate layout for the group
-            calculate_row_layout(group, count);
-            
-            // Add to processed list
-            processed_images = g_list_concat(processed_images, group);
-            
-            // Skip the processed images
-            for (int i = 0; i < count && current; i++) {
-                current = current->next;
-            }
-        } else {
-            // If we couldn't form a group, just add this image alone
-            GList *single = g_list_append(NULL, info);
-            calculate_row_layout(single, 1);
-            processed_images = g_list_append(processed_images, info);
-            current = current->next;
-        }
+    int num_columns = MAX(layout->num_columns, 1);
+    guint count = g_list_length(layout->images);
+    ImageInfo **order = g_new(ImageInfo *, count);
+
+    guint index = 0;
+    for (GList *l = layout->images; l; l = l->next) {
+        ImageInfo *info = l->data;
+        classify_and_size_image(info, layout->column_width);
+        order[index++] = info;
+    }
+
+    guint tail = 0;
+    if (layout->balance_lookahead > 0) {
+        tail = MIN(count, (guint)(layout->balance_lookahead * num_columns));
+        qsort(order + (count - tail), tail, sizeof(ImageInfo *), compare_tail_by_height);
+    }
+
+    ColumnSlot *heap = g_new(ColumnSlot, num_columns);
+    GPtrArray **column_tiles = g_new(GPtrArray *, num_columns);
+    for (int c = 0; c < num_columns; c++) {
+        heap[c].height = 0;
+        heap[c].column = c;
+        column_tiles[c] = g_ptr_array_new();
+    }
+
+    for (guint i = 0; i < count; i++) {
+        ImageInfo *info = order[i];
+        info->column = heap[0].column;
+        info->y = heap[0].height;
+        g_ptr_array_add(column_tiles[info->column], info);
+
+        heap[0].height += info->target_height + TILE_VERTICAL_GAP;
+        column_heap_sift_down(heap, num_columns, 0);
+    }
+
+    int *heights = g_new(int, num_columns);
+    for (int i = 0; i < num_columns; i++) {
+        heights[heap[i].column] = heap[i].height > 0 ? heap[i].height - TILE_VERTICAL_GAP : 0;
+    }
+
+    if (layout->balance_lookahead > 0) {
+        balance_columns(column_tiles, heights, num_columns, layout->balance_lookahead);
     }
 
-    // Update the layout's image list with the new order
-    layout->images = processed_images;
+    for (int c = 0; c < num_columns; c++) {
+        layout->content_height = MAX(layout->content_height, heights[c]);
+        g_ptr_array_free(column_tiles[c], TRUE);
+    }
+
+    // La lista queda en orden de colocación: dentro de cada columna, de arriba abajo
+    GList *placed = NULL;
+    for (guint i = count; i > 0; i--) {
+        placed = g_list_prepend(placed, order[i - 1]);
+    }
+    g_list_free(layout->images);
+    set_images(layout, placed);
+
+    g_free(heights);
+    g_free(column_tiles);
+    g_free(heap);
+    g_free(order);
 }
 
 void masonry_layout_free(MasonryLayout *layout) {
@@ -210,9 +356,10 @@ void masonry_layout_free(MasonryLayout *layout) {
     GList *l;
     for (l = layout->images; l; l = l->next) {
         ImageInfo *info = l->data;
+        ALLOC_STATS_SUB(ALLOC_LAYOUT, image_info_bytes(info));
         g_free(info->path);
         g_free(info);
     }
     g_list_free(layout->images);
-    layout->images = NULL;
+    set_images(layout, NULL);
 }
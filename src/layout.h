@@ -19,9 +19,23 @@
 #define HORIZONTAL_RATIO_THRESHOLD 1.33 // Para imágenes horizontales (mayor que 1.33)
 
 // Límites y espaciado
-#define MAX_IMAGES_PER_ROW 5          // Número máximo de imágenes por fila
+#define MIN_COLUMNS 2                 // Número mínimo de columnas
 #define IMAGE_SPACING 16              // Espaciado entre imágenes
-#define WINDOW_WIDTH 1920            // Ancho de la ventana
+
+// Espacio que añade el CSS alrededor de cada tile y del grid (ver apply_css_to_window)
+#define TILE_CSS_CHROME 32            // margin de .rounded (8px) + padding del box columna (8px), por lado
+#define GRID_CSS_CHROME 32            // padding del box principal y del contenedor de columnas (8px), por lado
+#define TILE_TOP_OFFSET (IMAGE_SPACING * 2 + GRID_CSS_CHROME / 2 + TILE_CSS_CHROME / 2)   // Del borde del grid al primer tile
+#define TILE_VERTICAL_GAP (IMAGE_SPACING + 16) // spacing del box columna + margin vertical de .rounded (8px arriba y abajo)
+
+// Balanceo de columnas: las últimas N imágenes de cada columna absorben la diferencia
+// de altura recortando/ampliando su alto (el tile usa recorte tipo cover)
+#define BALANCE_LOOKAHEAD 4           // Tiles por columna que participan en el balanceo (0 = desactivado)
+#define BALANCE_MAX_STRETCH 0.20      // Variación máxima de alto por tile (20%)
+
+// Geometría por defecto si no se puede consultar el monitor
+#define DEFAULT_MONITOR_WIDTH 1920
+#define DEFAULT_MONITOR_HEIGHT 1080
 
 typedef enum {
     IMAGE_VERTICAL,   // Aspect ratio < 0.75 (más alto que ancho, ej: 9:16)
@@ -37,18 +51,32 @@ typedef struct {
     int target_width;
     int target_height;
     ImageType image_type;
+    int column;                // Columna asignada por masonry_layout_calculate
+    int y;                     // Posición vertical dentro de la columna
 } ImageInfo;
 
 typedef struct {
     GList *images;
-    int grid_width;
+    GList *images_tail;        // Último nodo de images: añadir es O(1) aunque lleguen 100k de una en una
+    int grid_width;            // Ancho lógico del monitor
     int row_height;
     int spacing;
+    double scale;              // Factor de escala del monitor (píxeles de dispositivo por píxel lógico)
+    int num_columns;           // Derivado de grid_width
+    int column_width;          // Ancho lógico de cada tile
+    int balance_lookahead;     // Ver BALANCE_LOOKAHEAD
+    int content_height;        // Alto de la columna más alta tras el cálculo
     GHashTable *loaded_paths;  // Hash table para tracking de imágenes cargadas
 } MasonryLayout;
 
 void masonry_layout_init(MasonryLayout *layout, int grid_width, int row_height, int spacing);
+void masonry_layout_set_viewport(MasonryLayout *layout, int grid_width, double scale);
+int masonry_layout_device_size(const MasonryLayout *layout, int logical_size);
 void masonry_layout_add_image(MasonryLayout *layout, const char *path);
+void masonry_layout_add_image_with_size(MasonryLayout *layout, const char *path, int width, int height);
+// Cambia la imagen de un tile ya colocado sin moverlo (modo --sample). FALSE si path ya está
+gboolean masonry_layout_replace_image(MasonryLayout *layout, ImageInfo *info, const char *path, int width, int height);
+void masonry_layout_reorder(MasonryLayout *layout, GList *ordered_paths);
 void masonry_layout_calculate(MasonryLayout *layout);
 void masonry_layout_free(MasonryLayout *layout);
 
@@ -0,0 +1,402 @@
+// WallPin - Benchmark del pipeline sin display (scan, scan_async, probe, decode, scale, tile, ingest, color, phash, dedup, grouping, layout)
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include "layout.h"
+#include "color_analysis.h"
+#include "phash.h"
+#include "scanner.h"
+#include "image_loader.h"
+#include "jpeg_decode.h"
+#include "ingest.h"
+#include "shared_thumbnails.h"
+#include "bench_stats.h"
+#include "bench_corpus.h"
+#include "trace.h"
+
+#define DEFAULT_SIZES "100,1000"
+#define DEFAULT_OUTLIERS 3
+#define DEFAULT_PNG_RATIO 0.15
+#define DEFAULT_DECODE_SAMPLE 300
+#define DEFAULT_RUNS 5
+#define DEFAULT_SEED 42
+
+typedef struct {
+    char *sizes;            // Lista de tamaños de corpus separada por comas
+    char *corpus_base;      // Directorio donde se generan los corpus
+    const char *input_dir;  // Directorio existente (sustituye al corpus sintético)
+    const char *label;      // Etiqueta libre (ej: hash del commit)
+    const char *output;     // Archivo JSON de salida (stdout si es NULL)
+    int outliers;
+    double png_ratio;
+    int decode_sample;
+    int runs;
+    guint32 seed;
+} BenchOptions;
+
+static gint compare_path_ptrs(gconstpointer a, gconstpointer b) {
+    return g_strcmp0(*(const char * const *)a, *(const char * const *)b);
+}
+
+typedef struct {
+    GMainLoop *loop;
+    GPtrArray *paths;       // Lo que encontró el scanner: el conjunto de trabajo del resto de etapas
+    gboolean done;
+} BenchScan;
+
+// Recorrido síncrono de referencia, con el mismo criterio que el scanner: recursivo, tipo
+// por lstat (d_type puede ser DT_UNKNOWN en NFS/XFS...) y sin seguir enlaces simbólicos
+static void scan_directory(const char *dir_path, GPtrArray *paths) {
+    GDir *dir = g_dir_open(dir_path, 0, NULL);
+    if (!dir) return;
+
+    const char *name;
+    while ((name = g_dir_read_name(dir)) != NULL) {
+        char *full_path = g_build_filename(dir_path, name, NULL);
+        GStatBuf st;
+        if (g_lstat(full_path, &st) != 0) {
+            // Desaparecido entre readdir y lstat
+        } else if (S_ISDIR(st.st_mode)) {
+            scan_directory(full_path, paths);
+        } else if (S_ISREG(st.st_mode) && scanner_is_image_name(name)) {
+            g_ptr_array_add(paths, g_steal_pointer(&full_path));
+        }
+        g_free(full_path);
+    }
+    g_dir_close(dir);
+}
+
+static void on_bench_scan_batch(GPtrArray *paths, gpointer user_data) {
+    BenchScan *scan = user_data;
+    while (paths->len > 0) {
+        g_ptr_array_add(scan->paths, g_ptr_array_steal_index(paths, paths->len - 1));
+    }
+}
+
+static void on_bench_scan_done(G_GNUC_UNUSED guint total, gpointer user_data) {
+    BenchScan *scan = user_data;
+    scan->done = TRUE;
+    g_main_loop_quit(scan->loop);
+}
+
+// Muestra representativa para las etapas caras: reparto uniforme + todos los outliers
+static GArray *pick_decode_sample(int *widths, int *heights, guint count, int sample_size) {
+    GArray *indices = g_array_new(FALSE, FALSE, sizeof(guint));
+    guint step = (sample_size > 0 && count > (guint)sample_size) ? count / sample_size : 1;
+
+    for (guint i = 0; i < count; i++) {
+        gboolean outlier = (gint64)widths[i] * heights[i] >= 7680LL * 4320LL;
+        if (outlier || i % step == 0) {
+            g_array_append_val(indices, i);
+        }
+    }
+    return indices;
+}
+
+static void run_corpus(const char *dir, const BenchOptions *opts, GString *json, gboolean first) {
+    BenchSamples *scan = bench_samples_new("scan");
+    BenchSamples *scan_async = bench_samples_new("scan_async");
+    BenchSamples *probe = bench_samples_new("probe");
+    BenchSamples *decode = bench_samples_new("decode");
+    BenchSamples *scale = bench_samples_new("scale");
+    BenchSamples *tile = bench_samples_new("tile");
+    BenchSamples *ingest = bench_samples_new("ingest");
+    BenchSamples *color = bench_samples_new("color");
+    BenchSamples *phash = bench_samples_new("phash");
+    BenchSamples *dedup = bench_samples_new("dedup");
+    BenchSamples *grouping = bench_samples_new("grouping");
+    BenchSamples *layout_stage = bench_samples_new("layout");
+
+    // Scan: recorrido síncrono completo del árbol, repetido (los primeros pueden ir en frío)
+    for (int run = 0; run < opts->runs; run++) {
+        GPtrArray *found = g_ptr_array_new_with_free_func(g_free);
+        gint64 start = g_get_monotonic_time();
+        scan_directory(dir, found);
+        bench_samples_add_since(scan, start);
+        g_ptr_array_unref(found);
+    }
+
+    // Scan asíncrono (el que usa el wallpaper): GIO + main loop, hasta el último lote.
+    // Las demás etapas miden exactamente lo que él encuentra
+    const char *roots[] = { dir, NULL };
+    GPtrArray *paths = NULL;
+    for (int run = 0; run < opts->runs; run++) {
+        if (paths) g_ptr_array_unref(paths);
+        BenchScan bench_scan = { g_main_loop_new(NULL, FALSE), g_ptr_array_new_with_free_func(g_free), FALSE };
+        gint64 start = g_get_monotonic_time();
+        Scanner *scanner = scanner_start(roots, on_bench_scan_batch, on_bench_scan_done, &bench_scan);
+        // Sin raíces válidas on_done llega dentro de scanner_start: no hay nada que esperar
+        if (!bench_scan.done) g_main_loop_run(bench_scan.loop);
+        bench_samples_add_since(scan_async, start);
+        scanner_stop(scanner);
+        g_main_loop_unref(bench_scan.loop);
+        paths = bench_scan.paths;
+    }
+    g_ptr_array_sort(paths, compare_path_ptrs);   // Orden estable entre ejecuciones
+    guint count = paths->len;
+    g_printerr("📂 %s: %u imágenes\n", dir, count);
+
+    // Probe: solo cabeceras, por archivo
+    int *widths = g_new0(int, MAX(count, 1));
+    int *heights = g_new0(int, MAX(count, 1));
+    for (guint i = 0; i < count; i++) {
+        gint64 start = g_get_monotonic_time();
+        gdk_pixbuf_get_file_info(g_ptr_array_index(paths, i), &widths[i], &heights[i]);
+        bench_samples_add_since(probe, start);
+    }
+
+    // Decode + scale + color sobre una muestra (decodificar 100k imágenes completas no aporta)
+    GArray *sample = pick_decode_sample(widths, heights, count, opts->decode_sample);
+    Color *sample_colors = g_new0(Color, MAX(sample->len, 1));
+    PHash *sample_hashes = g_new0(PHash, MAX(sample->len, 1));
+    for (guint s = 0; s < sample->len; s++) {
+        guint i = g_array_index(sample, guint, s);
+        const char *path = g_ptr_array_index(paths, i);
+
+        gint64 start = g_get_monotonic_time();
+        GdkPixbuf *pixbuf = gdk_pixbuf_new_from_file(path, NULL);
+        bench_samples_add_since(decode, start);
+        if (!pixbuf) continue;
+
+        int width = gdk_pixbuf_get_width(pixbuf);
+        int height = gdk_pixbuf_get_height(pixbuf);
+        int target_height = MAX(1, (int)((double)STANDARD_WIDTH * height / width + 0.5));
+        start = g_get_monotonic_time();
+        GdkPixbuf *scaled = gdk_pixbuf_scale_simple(pixbuf, STANDARD_WIDTH, target_height, GDK_INTERP_BILINEAR);
+        bench_samples_add_since(scale, start);
+        g_object_unref(scaled);
+        g_object_unref(pixbuf);
+
+        // Tile: el camino del wallpaper, desde los bytes en memoria y escalando al decodificar
+        char *contents = NULL;
+        gsize length = 0;
+        if (g_file_get_contents(path, &contents, &length, NULL)) {
+            GBytes *bytes = g_bytes_new_take(contents, length);
+            start = g_get_monotonic_time();
+            GdkPixbuf *cover = image_loader_decode_cover(bytes, STANDARD_WIDTH, target_height, NULL);
+            bench_samples_add_since(tile, start);
+            g_clear_object(&cover);
+
+            // Ingest: la única decodificación del wallpaper (dimensiones, color, hash y miniatura)
+            IngestResult result = {0};
+            start = g_get_monotonic_time();
+            if (ingest_decode(bytes, STANDARD_WIDTH, &result, NULL)) {
+                bench_samples_add_since(ingest, start);
+            }
+            ingest_result_clear(&result);
+            g_bytes_unref(bytes);
+        }
+
+        start = g_get_monotonic_time();
+        sample_colors[s] = extract_dominant_color(path);
+        bench_samples_add_since(color, start);
+
+        start = g_get_monotonic_time();
+        phash_compute_file(path, &sample_hashes[s]);
+        bench_samples_add_since(phash, start);
+
+        if ((s + 1) % 100 == 0) {
+            g_printerr("   Decodificadas: %u/%u\n", s + 1, sample->len);
+        }
+    }
+
+    // Grouping: toda la colección, reutilizando los colores de la muestra de forma cíclica
+    Color *colors = g_new(Color, MAX(count, 1));
+    GList *path_list = NULL;
+    for (guint i = count; i > 0; i--) {
+        path_list = g_list_prepend(path_list, g_ptr_array_index(paths, i - 1));
+    }
+    for (guint i = 0; i < count; i++) {
+        colors[i] = sample->len > 0 ? sample_colors[i % sample->len] : (Color){128, 128, 128, 0, 0, 0.5};
+    }
+    for (int run = 0; run < opts->runs; run++) {
+        gint64 start = g_get_monotonic_time();
+        GList *groups = group_images_by_precomputed_colors(path_list, colors, 50);
+        bench_samples_add_since(grouping, start);
+        g_list_free_full(groups, (GDestroyNotify)free_color_group);
+    }
+
+    // Dedup: índice multi-hash sobre toda la colección; hashes reales de la muestra y
+    // pseudoaleatorios (deterministas) para el resto, así que casi todo son consultas sin match
+    PHash *hashes = g_new(PHash, MAX(count, 1));
+    GRand *generator = g_rand_new_with_seed(opts->seed);
+    for (guint i = 0; i < count; i++) {
+        if (i < sample->len) {
+            hashes[i] = sample_hashes[i];
+        } else {
+            PHash high = g_rand_int(generator);
+            hashes[i] = (high << 32) | g_rand_int(generator);
+        }
+    }
+    g_rand_free(generator);
+    for (int run = 0; run < opts->runs; run++) {
+        gint64 start = g_get_monotonic_time();
+        PHashIndex *index = phash_index_new(PHASH_DUPLICATE_DISTANCE);
+        for (guint i = 0; i < count; i++) {
+            if (!phash_index_find(index, hashes[i])) {
+                phash_index_add(index, g_ptr_array_index(paths, i), hashes[i]);
+            }
+        }
+        bench_samples_add_since(dedup, start);
+        phash_index_free(index);
+    }
+
+    // Layout: masonry_layout_calculate con las dimensiones del probe
+    for (int run = 0; run < opts->runs; run++) {
+        MasonryLayout layout;
+        masonry_layout_init(&layout, DEFAULT_MONITOR_WIDTH, STANDARD_WIDTH, IMAGE_SPACING);
+        for (guint i = 0; i < count; i++) {
+            masonry_layout_add_image_with_size(&layout, g_ptr_array_index(paths, i), widths[i], heights[i]);
+        }
+        gint64 start = g_get_monotonic_time();
+        masonry_layout_calculate(&layout);
+        bench_samples_add_since(layout_stage, start);
+        masonry_layout_free(&layout);
+    }
+
+    BenchSamples *stages[] = { scan, scan_async, probe, decode, scale, tile, ingest, color, phash, dedup, grouping, layout_stage };
+    g_string_append_printf(json, "%s    {\n      \"dir\": ", first ? "" : ",\n");
+    trace_append_json_string(json, dir);
+    g_string_append_printf(json, ",\n      \"files\": %u,\n"
+                           "      \"decode_sample\": %u,\n      \"runs\": %d,\n      \"stages\": {\n",
+                           count, sample->len, opts->runs);
+    for (guint i = 0; i < G_N_ELEMENTS(stages); i++) {
+        bench_samples_append_json(stages[i], json, "        ");
+        g_string_append(json, i + 1 < G_N_ELEMENTS(stages) ? ",\n" : "\n");
+        bench_samples_free(stages[i]);
+    }
+    g_string_append(json, "      }\n    }");
+
+    g_list_free(path_list);
+    g_free(colors);
+    g_free(sample_colors);
+    g_free(sample_hashes);
+    g_free(hashes);
+    g_array_free(sample, TRUE);
+    g_free(widths);
+    g_free(heights);
+    g_ptr_array_unref(paths);
+}
+
+static void print_usage(const char *prog) {
+    g_print("WallPin Pipeline Benchmark\n");
+    g_print("Uso: %s [opciones]\n", prog);
+    g_print("Opciones:\n");
+    g_print("  --sizes <lista>          Tamaños de corpus sintético (por defecto: %s, hasta 100000)\n", DEFAULT_SIZES);
+    g_print("  --outliers <n>           Imágenes 8K por corpus (por defecto: %d)\n", DEFAULT_OUTLIERS);
+    g_print("  --png-ratio <0-1>        Fracción de PNG (por defecto: %.2f)\n", DEFAULT_PNG_RATIO);
+    g_print("  --corpus-dir <dir>       Dónde generar/reutilizar los corpus\n");
+    g_print("  --dir <dir>              Medir un directorio existente en vez del corpus sintético\n");
+    g_print("  --decode-sample <n>      Imágenes decodificadas por corpus (por defecto: %d)\n", DEFAULT_DECODE_SAMPLE);
+    g_print("  --runs <n>               Repeticiones de scan/dedup/grouping/layout (por defecto: %d)\n", DEFAULT_RUNS);
+    g_print("  --seed <n>               Semilla del generador (por defecto: %d)\n", DEFAULT_SEED);
+    g_print("  --label <texto>          Etiqueta del resultado (ej: commit)\n");
+    g_print("  --jpeg-backend <nombre>  turbojpeg o gdk-pixbuf para tile/ingest/color (por defecto: %s)\n",
+            jpeg_decode_backend_name());
+    g_print("  --output <archivo>       Escribir JSON en archivo (por defecto: stdout)\n");
+    g_print("\nTiempos en microsegundos; cada etapa reporta min/p50/p90/p99/max/mean/total.\n");
+}
+
+int main(int argc, char **argv) {
+    BenchOptions opts = {
+        NULL, NULL, NULL, "", NULL,
+        DEFAULT_OUTLIERS, DEFAULT_PNG_RATIO, DEFAULT_DECODE_SAMPLE, DEFAULT_RUNS, DEFAULT_SEED
+    };
+    // Se mide la decodificación: ni atajos por ~/.cache/thumbnails ni escrituras en ella
+    shared_thumbnails_set_enabled(FALSE);
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!value) {
+            g_printerr("Error: %s requiere un valor\n", argv[i]);
+            return 1;
+        } else if (strcmp(argv[i], "--sizes") == 0) {
+            opts.sizes = g_strdup(value);
+        } else if (strcmp(argv[i], "--outliers") == 0) {
+            opts.outliers = MAX(0, atoi(value));
+        } else if (strcmp(argv[i], "--png-ratio") == 0) {
+            opts.png_ratio = CLAMP(g_ascii_strtod(value, NULL), 0.0, 1.0);
+        } else if (strcmp(argv[i], "--corpus-dir") == 0) {
+            opts.corpus_base = g_strdup(value);
+        } else if (strcmp(argv[i], "--dir") == 0) {
+            opts.input_dir = value;
+        } else if (strcmp(argv[i], "--decode-sample") == 0) {
+            opts.decode_sample = MAX(1, atoi(value));
+        } else if (strcmp(argv[i], "--runs") == 0) {
+            opts.runs = MAX(1, atoi(value));
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            opts.seed = (guint32)g_ascii_strtoull(value, NULL, 10);
+        } else if (strcmp(argv[i], "--label") == 0) {
+            opts.label = value;
+        } else if (strcmp(argv[i], "--output") == 0) {
+            opts.output = value;
+        } else if (strcmp(argv[i], "--jpeg-backend") == 0) {
+            if (strcmp(value, "gdk-pixbuf") == 0) {
+                jpeg_decode_set_enabled(FALSE);
+            } else if (strcmp(value, "turbojpeg") != 0 || !jpeg_decode_available()) {
+                g_printerr("Error: backend JPEG no disponible: %s\n", value);
+                return 1;
+            }
+        } else {
+            g_printerr("Opción desconocida: %s\n", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+
+    if (!opts.sizes) opts.sizes = g_strdup(DEFAULT_SIZES);
+    if (!opts.corpus_base) opts.corpus_base = g_build_filename(g_get_user_cache_dir(), "wallpin-bench", NULL);
+
+    GString *json = g_string_new(NULL);
+    g_string_append(json, "{\n  \"benchmark\": \"wallpin-pipeline\",\n  \"label\": ");
+    trace_append_json_string(json, opts.label);
+    g_string_append_printf(json, ",\n  \"jpeg_backend\": \"%s\",\n"
+                           "  \"timestamp\": %" G_GINT64_FORMAT ",\n  \"unit\": \"us\",\n  \"corpora\": [\n",
+                           jpeg_decode_backend_name(), g_get_real_time() / G_USEC_PER_SEC);
+
+    int status = 0;
+    if (opts.input_dir) {
+        run_corpus(opts.input_dir, &opts, json, TRUE);
+    } else {
+        char **sizes = g_strsplit(opts.sizes, ",", -1);
+        gboolean first = TRUE;
+        for (char **size = sizes; *size; size++) {
+            BenchCorpusSpec spec = { atoi(*size), opts.outliers, opts.png_ratio, opts.seed };
+            if (spec.file_count <= 0) continue;
+            spec.outlier_count = MIN(spec.outlier_count, spec.file_count);
+
+            char *dir = bench_corpus_ensure(opts.corpus_base, &spec);
+            if (!dir) {
+                status = 1;
+                break;
+            }
+            run_corpus(dir, &opts, json, first);
+            first = FALSE;
+            g_free(dir);
+        }
+        g_strfreev(sizes);
+    }
+    g_string_append(json, "\n  ]\n}\n");
+
+    if (opts.output) {
+        GError *error = NULL;
+        if (!g_file_set_contents(opts.output, json->str, json->len, &error)) {
+            g_printerr("Error escribiendo %s: %s\n", opts.output, error->message);
+            g_error_free(error);
+            status = 1;
+        } else {
+            g_printerr("📊 Resultados guardados en %s\n", opts.output);
+        }
+    } else {
+        fputs(json->str, stdout);
+    }
+
+    g_string_free(json, TRUE);
+    g_free(opts.sizes);
+    g_free(opts.corpus_base);
+    return status;
+}
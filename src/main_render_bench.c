@@ -0,0 +1,565 @@
+// WallPin - Benchmark de render offscreen (sin display ni compositor)
+//
+// Construye por frame el mismo árbol de render nodes que dibuja el wallpaper (fondo,
+// clip del scrolled window, desplazamiento del scroll y, por tile, sombra + esquinas
+// redondeadas + textura) y lo rasteriza con el renderer cairo de GSK en una textura
+// offscreen, avanzando el scroll como el auto-scroll. Cada variante quita un efecto
+// para medir lo que cuesta; "strip" mide el camino de --low-power y "baked" el de
+// --baked-tiles.
+
+#include <gtk/gtk.h>
+#include <string.h>
+#include <math.h>
+#include "layout.h"
+#include "tile_render.h"
+#include "scroll_strip.h"
+#include "tile_bake.h"
+#include "bench_stats.h"
+#include "trace.h"
+
+#define DEFAULT_FRAMES 600
+#define DEFAULT_IMAGES 500
+#define DEFAULT_SPEED 100.0
+#define DEFAULT_FPS 60
+#define DEFAULT_SEED 42
+#define DEFAULT_VARIANTS "css,no-shadow,no-clip,plain,strip,baked"
+
+#define MAX_NODE_TYPES 64
+
+typedef struct {
+    const char *label;
+    const char *output;
+    const char *variants;   // Lista separada por comas
+    int frames;
+    int images;
+    int width;
+    int height;
+    double scale;
+    double speed;           // px/s
+    int fps;
+    guint32 seed;
+} RenderBenchOptions;
+
+typedef enum {
+    VARIANT_TILES,          // Un grupo de nodos por tile visible
+    VARIANT_STRIP,          // Segmentos pre-compuestos por columna
+    VARIANT_BAKED           // Una textura por tile con esquinas y sombra horneadas
+} VariantKind;
+
+typedef struct {
+    const char *name;
+    VariantKind kind;
+    TileRenderFlags flags;
+} RenderVariant;
+
+static const RenderVariant render_variants[] = {
+    { "css", VARIANT_TILES, TILE_RENDER_CSS },            // Lo que dibuja hoy cada tile
+    { "no-shadow", VARIANT_TILES, TILE_RENDER_ROUNDED },
+    { "no-clip", VARIANT_TILES, TILE_RENDER_SHADOW },
+    { "plain", VARIANT_TILES, 0 },
+    { "strip", VARIANT_STRIP, TILE_RENDER_CSS },
+    { "baked", VARIANT_BAKED, 0 },
+};
+
+// Mismas proporciones que el corpus sintético de wallpin-bench
+static const double scene_aspect_ratios[] = {
+    9.0 / 16.0, 2.0 / 3.0, 3.0 / 4.0, 1.0, 4.0 / 3.0, 3.0 / 2.0, 16.0 / 9.0, 21.0 / 9.0
+};
+
+static const GdkRGBA window_background = { 0x12 / 255.0f, 0x12 / 255.0f, 0x12 / 255.0f, 1.0f };
+
+typedef struct {
+    graphene_rect_t rect;   // Coordenadas lógicas dentro del contenido
+    int column;
+    guint32 tone;
+    GdkTexture *texture;    // Se crea la primera vez que el tile es visible
+    GdkTexture *baked;      // Ídem, horneada (variante baked)
+} SceneTile;
+
+typedef struct {
+    GArray *tiles;          // SceneTile, en orden del layout
+    int num_columns;
+    int column_width;
+    double scale;
+    int viewport_width;
+    int viewport_height;
+    double max_scroll;
+    GHashTable *segments;   // (columna << 16 | segmento) -> GdkTexture (variante strip)
+} RenderScene;
+
+static void scene_tile_clear(SceneTile *tile) {
+    g_clear_object(&tile->texture);
+    g_clear_object(&tile->baked);
+}
+
+// Misma colocación horizontal que el grid: columnas centradas con el chrome del CSS
+static double scene_column_x(const RenderScene *scene, int column) {
+    double pitch = scene->column_width + TILE_CSS_CHROME + IMAGE_SPACING;
+    double total = scene->num_columns * pitch - IMAGE_SPACING;
+    return (scene->viewport_width - total) / 2.0 + column * pitch + TILE_CSS_CHROME / 2.0;
+}
+
+static RenderScene *scene_new(const RenderBenchOptions *opts) {
+    RenderScene *scene = g_new0(RenderScene, 1);
+    scene->tiles = g_array_new(FALSE, TRUE, sizeof(SceneTile));
+    g_array_set_clear_func(scene->tiles, (GDestroyNotify)scene_tile_clear);
+    scene->segments = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_object_unref);
+    scene->viewport_width = opts->width;
+    scene->viewport_height = opts->height;
+    scene->scale = opts->scale;
+
+    // Layout real con dimensiones sintéticas (mismo reparto de proporciones que el corpus)
+    MasonryLayout layout;
+    masonry_layout_init(&layout, opts->width, STANDARD_WIDTH, IMAGE_SPACING);
+    masonry_layout_set_viewport(&layout, opts->width, opts->scale);
+    GRand *generator = g_rand_new_with_seed(opts->seed);
+    for (int i = 0; i < opts->images; i++) {
+        double ratio = scene_aspect_ratios[g_rand_int_range(generator, 0, G_N_ELEMENTS(scene_aspect_ratios))];
+        char *path = g_strdup_printf("scene-%06d", i);
+        masonry_layout_add_image_with_size(&layout, path, (int)(1920 * MIN(ratio, 1.0)), (int)(1920 / MAX(ratio, 1.0)));
+        g_free(path);
+    }
+    masonry_layout_calculate(&layout);
+
+    scene->num_columns = layout.num_columns;
+    scene->column_width = layout.column_width;
+    for (GList *l = layout.images; l != NULL; l = l->next) {
+        ImageInfo *info = (ImageInfo *)l->data;
+        SceneTile tile = { 0 };
+        tile.column = info->column;
+        tile.rect = GRAPHENE_RECT_INIT(scene_column_x(scene, info->column), TILE_TOP_OFFSET + info->y,
+                                       info->target_width, info->target_height);
+        tile.tone = g_rand_int(generator);
+        g_array_append_val(scene->tiles, tile);
+    }
+    scene->max_scroll = MAX(1.0, layout.content_height + 2.0 * TILE_TOP_OFFSET - opts->height);
+
+    g_rand_free(generator);
+    masonry_layout_free(&layout);
+    return scene;
+}
+
+static void scene_free(RenderScene *scene) {
+    g_array_unref(scene->tiles);
+    g_hash_table_destroy(scene->segments);
+    g_free(scene);
+}
+
+// Píxeles RGB opacos al tamaño de dispositivo, como los de un JPEG decodificado
+static GBytes *make_tile_pixels(const SceneTile *tile, double scale, int *out_width, int *out_height) {
+    int width = (int)ceil(tile->rect.size.width * scale);
+    int height = (int)ceil(tile->rect.size.height * scale);
+    gsize stride = (gsize)width * 3;
+    guchar *pixels = g_malloc(stride * height);
+
+    guchar r = tile->tone & 0xff, g = (tile->tone >> 8) & 0xff, b = (tile->tone >> 16) & 0xff;
+    for (int y = 0; y < height; y++) {
+        guchar *row = pixels + y * stride;
+        int shade = y * 96 / MAX(height, 1);
+        for (int x = 0; x < width; x++) {
+            row[x * 3 + 0] = (guchar)((r + shade + x) & 0xff);
+            row[x * 3 + 1] = (guchar)((g + shade) & 0xff);
+            row[x * 3 + 2] = (guchar)((b + x / 2) & 0xff);
+        }
+    }
+
+    *out_width = width;
+    *out_height = height;
+    return g_bytes_new_take(pixels, stride * height);
+}
+
+// Textura opaca al tamaño de dispositivo, como la que sale de gdk_texture_new_for_pixbuf con un JPEG
+static GdkTexture *make_tile_texture(const SceneTile *tile, double scale) {
+    int width, height;
+    GBytes *bytes = make_tile_pixels(tile, scale, &width, &height);
+    GdkTexture *texture = gdk_memory_texture_new(width, height, GDK_MEMORY_R8G8B8, bytes, (gsize)width * 3);
+    g_bytes_unref(bytes);
+    return texture;
+}
+
+// La misma con esquinas y sombra horneadas, como las del decodificador con --baked-tiles
+static GdkTexture *make_baked_texture(const SceneTile *tile, double scale) {
+    int width, height;
+    GBytes *bytes = make_tile_pixels(tile, scale, &width, &height);
+    GdkPixbuf *pixbuf = gdk_pixbuf_new_from_bytes(bytes, GDK_COLORSPACE_RGB, FALSE, 8, width, height, width * 3);
+    g_bytes_unref(bytes);
+    GdkPixbuf *baked = tile_bake(pixbuf, scale);
+    GdkTexture *texture = gdk_texture_new_for_pixbuf(baked);
+    g_object_unref(baked);
+    g_object_unref(pixbuf);
+    return texture;
+}
+
+static gboolean tile_visible(const SceneTile *tile, double top, double bottom) {
+    return tile->rect.origin.y + tile->rect.size.height + STRIP_SHADOW_PAD >= top &&
+           tile->rect.origin.y - STRIP_SHADOW_PAD <= bottom;
+}
+
+// Las texturas se crean fuera de la medición: aquí solo interesa el coste de dibujar
+static void scene_prepare_textures(RenderScene *scene, double offset) {
+    for (guint i = 0; i < scene->tiles->len; i++) {
+        SceneTile *tile = &g_array_index(scene->tiles, SceneTile, i);
+        if (!tile->texture && tile_visible(tile, offset, offset + scene->viewport_height)) {
+            tile->texture = make_tile_texture(tile, scene->scale);
+        }
+    }
+}
+
+static void push_viewport(GtkSnapshot *snapshot, const RenderScene *scene, double offset) {
+    graphene_rect_t viewport = GRAPHENE_RECT_INIT(0, 0, scene->viewport_width, scene->viewport_height);
+    gtk_snapshot_scale(snapshot, scene->scale, scene->scale);
+    gtk_snapshot_append_color(snapshot, &window_background, &viewport);
+    gtk_snapshot_push_clip(snapshot, &viewport);   // El scrolled window recorta a su tamaño
+    gtk_snapshot_translate(snapshot, &GRAPHENE_POINT_INIT(0, (float)-offset));
+}
+
+// El horneado va en los hilos de decodificación, fuera del frame: su coste va en "prerender"
+static void scene_prepare_baked(RenderScene *scene, double offset, BenchSamples *prerender) {
+    for (guint i = 0; i < scene->tiles->len; i++) {
+        SceneTile *tile = &g_array_index(scene->tiles, SceneTile, i);
+        if (!tile->baked && tile_visible(tile, offset, offset + scene->viewport_height)) {
+            gint64 start = g_get_monotonic_time();
+            tile->baked = make_baked_texture(tile, scene->scale);
+            bench_samples_add_since(prerender, start);
+        }
+    }
+}
+
+static GskRenderNode *build_baked_frame(const RenderScene *scene, double offset) {
+    GtkSnapshot *snapshot = gtk_snapshot_new();
+    push_viewport(snapshot, scene, offset);
+
+    for (guint i = 0; i < scene->tiles->len; i++) {
+        const SceneTile *tile = &g_array_index(scene->tiles, SceneTile, i);
+        if (!tile_visible(tile, offset, offset + scene->viewport_height)) continue;
+        graphene_rect_t rect = GRAPHENE_RECT_INIT(tile->rect.origin.x - TILE_BAKE_PADDING,
+                                                  tile->rect.origin.y - TILE_BAKE_PADDING,
+                                                  tile->rect.size.width + 2 * TILE_BAKE_PADDING,
+                                                  tile->rect.size.height + 2 * TILE_BAKE_PADDING);
+        tile_render_append(snapshot, tile->baked, &rect, 0);
+    }
+
+    gtk_snapshot_pop(snapshot);
+    return gtk_snapshot_free_to_node(snapshot);
+}
+
+static GskRenderNode *build_tiles_frame(const RenderScene *scene, double offset, TileRenderFlags flags) {
+    GtkSnapshot *snapshot = gtk_snapshot_new();
+    push_viewport(snapshot, scene, offset);
+
+    for (guint i = 0; i < scene->tiles->len; i++) {
+        const SceneTile *tile = &g_array_index(scene->tiles, SceneTile, i);
+        if (tile_visible(tile, offset, offset + scene->viewport_height)) {
+            tile_render_append(snapshot, tile->texture, &tile->rect, flags);
+        }
+    }
+
+    gtk_snapshot_pop(snapshot);
+    return gtk_snapshot_free_to_node(snapshot);
+}
+
+// Segmento de columna pre-compuesto, igual que compose_segment en scroll_strip.c
+static GdkTexture *render_segment(RenderScene *scene, GskRenderer *renderer, int column, int segment) {
+    double top = (double)segment * STRIP_SEGMENT_HEIGHT;
+    double width = scene->column_width + 2 * STRIP_SHADOW_PAD;
+    double x = scene_column_x(scene, column) - STRIP_SHADOW_PAD;
+
+    GtkSnapshot *snapshot = gtk_snapshot_new();
+    gtk_snapshot_scale(snapshot, scene->scale, scene->scale);
+    gtk_snapshot_push_clip(snapshot, &GRAPHENE_RECT_INIT(0, 0, width, STRIP_SEGMENT_HEIGHT));
+    gtk_snapshot_append_color(snapshot, &window_background, &GRAPHENE_RECT_INIT(0, 0, width, STRIP_SEGMENT_HEIGHT));
+    gtk_snapshot_translate(snapshot, &GRAPHENE_POINT_INIT((float)-x, (float)-top));
+    for (guint i = 0; i < scene->tiles->len; i++) {
+        SceneTile *tile = &g_array_index(scene->tiles, SceneTile, i);
+        if (tile->column != column || !tile_visible(tile, top, top + STRIP_SEGMENT_HEIGHT)) continue;
+        if (!tile->texture) tile->texture = make_tile_texture(tile, scene->scale);
+        tile_render_append(snapshot, tile->texture, &tile->rect, TILE_RENDER_CSS);
+    }
+    gtk_snapshot_pop(snapshot);
+
+    GskRenderNode *node = gtk_snapshot_free_to_node(snapshot);
+    GdkTexture *texture = gsk_renderer_render_texture(renderer, node,
+                                                      &GRAPHENE_RECT_INIT(0, 0, ceil(width * scene->scale),
+                                                                          ceil(STRIP_SEGMENT_HEIGHT * scene->scale)));
+    gsk_render_node_unref(node);
+    return texture;
+}
+
+// Los segmentos que necesita el frame se componen fuera de la medición (como el
+// prerender en idle del strip) y su coste va aparte, en "prerender"
+static void scene_prepare_segments(RenderScene *scene, GskRenderer *renderer, double offset, BenchSamples *prerender) {
+    int first = (int)(offset / STRIP_SEGMENT_HEIGHT);
+    int last = (int)((offset + scene->viewport_height) / STRIP_SEGMENT_HEIGHT);
+    for (int column = 0; column < scene->num_columns; column++) {
+        for (int segment = first; segment <= last; segment++) {
+            gpointer key = GUINT_TO_POINTER(((guint)column << 16) | (guint)segment);
+            if (g_hash_table_contains(scene->segments, key)) continue;
+            gint64 start = g_get_monotonic_time();
+            g_hash_table_insert(scene->segments, key, render_segment(scene, renderer, column, segment));
+            bench_samples_add_since(prerender, start);
+        }
+    }
+}
+
+static GskRenderNode *build_strip_frame(const RenderScene *scene, double offset) {
+    GtkSnapshot *snapshot = gtk_snapshot_new();
+    push_viewport(snapshot, scene, offset);
+
+    int first = (int)(offset / STRIP_SEGMENT_HEIGHT);
+    int last = (int)((offset + scene->viewport_height) / STRIP_SEGMENT_HEIGHT);
+    for (int column = 0; column < scene->num_columns; column++) {
+        double x = scene_column_x(scene, column) - STRIP_SHADOW_PAD;
+        for (int segment = first; segment <= last; segment++) {
+            GdkTexture *texture = g_hash_table_lookup(scene->segments,
+                                                      GUINT_TO_POINTER(((guint)column << 16) | (guint)segment));
+            if (!texture) continue;
+            gtk_snapshot_append_texture(snapshot, texture,
+                                        &GRAPHENE_RECT_INIT(x, (double)segment * STRIP_SEGMENT_HEIGHT,
+                                                            scene->column_width + 2 * STRIP_SHADOW_PAD,
+                                                            STRIP_SEGMENT_HEIGHT));
+        }
+    }
+
+    gtk_snapshot_pop(snapshot);
+    return gtk_snapshot_free_to_node(snapshot);
+}
+
+static void count_nodes(GskRenderNode *node, guint64 *counts) {
+    GskRenderNodeType type = gsk_render_node_get_node_type(node);
+    if ((int)type >= 0 && type < MAX_NODE_TYPES) counts[type]++;
+
+    switch (type) {
+    case GSK_CONTAINER_NODE:
+        for (guint i = 0; i < gsk_container_node_get_n_children(node); i++) {
+            count_nodes(gsk_container_node_get_child(node, i), counts);
+        }
+        break;
+    case GSK_CLIP_NODE:
+        count_nodes(gsk_clip_node_get_child(node), counts);
+        break;
+    case GSK_ROUNDED_CLIP_NODE:
+        count_nodes(gsk_rounded_clip_node_get_child(node), counts);
+        break;
+    case GSK_TRANSFORM_NODE:
+        count_nodes(gsk_transform_node_get_child(node), counts);
+        break;
+    default:
+        break;
+    }
+}
+
+static void append_node_counts(GString *json, const guint64 *counts, int frames) {
+    static const struct { GskRenderNodeType type; const char *name; } named[] = {
+        { GSK_CONTAINER_NODE, "container" },
+        { GSK_CLIP_NODE, "clip" },
+        { GSK_ROUNDED_CLIP_NODE, "rounded_clip" },
+        { GSK_TRANSFORM_NODE, "transform" },
+        { GSK_OUTSET_SHADOW_NODE, "outset_shadow" },
+        { GSK_COLOR_NODE, "color" },
+        { GSK_TEXTURE_NODE, "texture" },
+    };
+
+    guint64 total = 0, listed = 0;
+    for (int i = 0; i < MAX_NODE_TYPES; i++) total += counts[i];
+    g_string_append_printf(json, "      \"nodes_per_frame\": {\n        \"total\": %.1f",
+                           (double)total / MAX(frames, 1));
+    for (guint i = 0; i < G_N_ELEMENTS(named); i++) {
+        listed += counts[named[i].type];
+        g_string_append_printf(json, ",\n        \"%s\": %.1f", named[i].name,
+                               (double)counts[named[i].type] / MAX(frames, 1));
+    }
+    g_string_append_printf(json, ",\n        \"other\": %.1f\n      }", (double)(total - listed) / MAX(frames, 1));
+}
+
+static void run_variant(RenderScene *scene, GskRenderer *renderer, const RenderVariant *variant,
+                        const RenderBenchOptions *opts, GString *json, gboolean first) {
+    BenchSamples *snapshot_stage = bench_samples_new("snapshot");
+    BenchSamples *render_stage = bench_samples_new("render");
+    BenchSamples *frame_stage = bench_samples_new("frame");
+    BenchSamples *prerender = bench_samples_new("prerender");
+    guint64 counts[MAX_NODE_TYPES] = { 0 };
+    double step = opts->speed / opts->fps;
+    graphene_rect_t viewport = GRAPHENE_RECT_INIT(0, 0, ceil(scene->viewport_width * scene->scale),
+                                                  ceil(scene->viewport_height * scene->scale));
+
+    for (int frame = 0; frame < opts->frames; frame++) {
+        double offset = fmod(frame * step, scene->max_scroll);
+        if (variant->kind == VARIANT_STRIP) {
+            scene_prepare_segments(scene, renderer, offset, prerender);
+        } else if (variant->kind == VARIANT_BAKED) {
+            scene_prepare_baked(scene, offset, prerender);
+        } else {
+            scene_prepare_textures(scene, offset);
+        }
+
+        gint64 start = g_get_monotonic_time();
+        GskRenderNode *node;
+        if (variant->kind == VARIANT_STRIP) {
+            node = build_strip_frame(scene, offset);
+        } else if (variant->kind == VARIANT_BAKED) {
+            node = build_baked_frame(scene, offset);
+        } else {
+            node = build_tiles_frame(scene, offset, variant->flags);
+        }
+        bench_samples_add_since(snapshot_stage, start);
+
+        gint64 render_start = g_get_monotonic_time();
+        GdkTexture *output = gsk_renderer_render_texture(renderer, node, &viewport);
+        bench_samples_add_since(render_stage, render_start);
+        bench_samples_add_since(frame_stage, start);
+
+        count_nodes(node, counts);
+        g_object_unref(output);
+        gsk_render_node_unref(node);
+    }
+
+    g_string_append_printf(json, "%s    {\n      \"variant\": \"%s\",\n      \"frames\": %d,\n",
+                           first ? "" : ",\n", variant->name, opts->frames);
+    append_node_counts(json, counts, opts->frames);
+    g_string_append(json, ",\n      \"stages\": {\n");
+    BenchSamples *stages[] = { snapshot_stage, render_stage, frame_stage, prerender };
+    guint stage_count = variant->kind != VARIANT_TILES ? G_N_ELEMENTS(stages) : G_N_ELEMENTS(stages) - 1;
+    for (guint i = 0; i < stage_count; i++) {
+        bench_samples_append_json(stages[i], json, "        ");
+        g_string_append(json, i + 1 < stage_count ? ",\n" : "\n");
+    }
+    g_string_append(json, "      }\n    }");
+
+    g_printerr("🖼️  %-10s p50 %.0fus  p99 %.0fus por frame\n", variant->name,
+               bench_samples_percentile(frame_stage, 50), bench_samples_percentile(frame_stage, 99));
+
+    for (guint i = 0; i < G_N_ELEMENTS(stages); i++) {
+        bench_samples_free(stages[i]);
+    }
+}
+
+static const RenderVariant *find_variant(const char *name) {
+    for (guint i = 0; i < G_N_ELEMENTS(render_variants); i++) {
+        if (strcmp(render_variants[i].name, name) == 0) return &render_variants[i];
+    }
+    return NULL;
+}
+
+static void print_usage(const char *prog) {
+    g_print("WallPin Render Benchmark (offscreen, renderer cairo de GSK)\n");
+    g_print("Uso: %s [opciones]\n", prog);
+    g_print("Opciones:\n");
+    g_print("  --frames <n>             Frames por variante (por defecto: %d)\n", DEFAULT_FRAMES);
+    g_print("  --images <n>             Tiles en el layout (por defecto: %d)\n", DEFAULT_IMAGES);
+    g_print("  --size <AnchoxAlto>      Tamaño lógico del monitor (por defecto: %dx%d)\n",
+            DEFAULT_MONITOR_WIDTH, DEFAULT_MONITOR_HEIGHT);
+    g_print("  --scale <f>              Escala del monitor (por defecto: 1.0)\n");
+    g_print("  --speed <px/s>           Velocidad de scroll simulada (por defecto: %.0f)\n", DEFAULT_SPEED);
+    g_print("  --fps <n>                Frames por segundo simulados (por defecto: %d)\n", DEFAULT_FPS);
+    g_print("  --variants <lista>       Variantes a medir (por defecto: %s)\n", DEFAULT_VARIANTS);
+    g_print("  --seed <n>               Semilla del layout (por defecto: %d)\n", DEFAULT_SEED);
+    g_print("  --label <texto>          Etiqueta del resultado (ej: commit)\n");
+    g_print("  --output <archivo>       Escribir JSON en archivo (por defecto: stdout)\n");
+    g_print("\nVariantes: css (sombra + esquinas, lo actual), no-shadow, no-clip, plain (solo textura),\n");
+    g_print("strip (segmentos pre-compuestos de --low-power), baked (esquinas y sombra horneadas\n");
+    g_print("de --baked-tiles; el horneado se mide aparte como etapa prerender).\n");
+    g_print("Tiempos en microsegundos; cada etapa reporta min/p50/p90/p99/max/mean/total.\n");
+}
+
+int main(int argc, char **argv) {
+    RenderBenchOptions opts = {
+        "", NULL, DEFAULT_VARIANTS, DEFAULT_FRAMES, DEFAULT_IMAGES,
+        DEFAULT_MONITOR_WIDTH, DEFAULT_MONITOR_HEIGHT, 1.0, DEFAULT_SPEED, DEFAULT_FPS, DEFAULT_SEED
+    };
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!value) {
+            g_printerr("Error: %s requiere un valor\n", argv[i]);
+            return 1;
+        } else if (strcmp(argv[i], "--frames") == 0) {
+            opts.frames = MAX(1, atoi(value));
+        } else if (strcmp(argv[i], "--images") == 0) {
+            opts.images = MAX(1, atoi(value));
+        } else if (strcmp(argv[i], "--size") == 0) {
+            if (sscanf(value, "%dx%d", &opts.width, &opts.height) != 2 || opts.width <= 0 || opts.height <= 0) {
+                g_printerr("Error: --size espera AnchoxAlto (ej: 2560x1440)\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--scale") == 0) {
+            opts.scale = CLAMP(g_ascii_strtod(value, NULL), 0.5, 4.0);
+        } else if (strcmp(argv[i], "--speed") == 0) {
+            opts.speed = MAX(0.0, g_ascii_strtod(value, NULL));
+        } else if (strcmp(argv[i], "--fps") == 0) {
+            opts.fps = CLAMP(atoi(value), 1, 500);
+        } else if (strcmp(argv[i], "--variants") == 0) {
+            opts.variants = value;
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            opts.seed = (guint32)g_ascii_strtoull(value, NULL, 10);
+        } else if (strcmp(argv[i], "--label") == 0) {
+            opts.label = value;
+        } else if (strcmp(argv[i], "--output") == 0) {
+            opts.output = value;
+        } else {
+            g_printerr("Opción desconocida: %s\n", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+
+    // Sin gtk_init: ni snapshots ni el renderer cairo necesitan display
+    GError *error = NULL;
+    GskRenderer *renderer = gsk_cairo_renderer_new();
+    if (!gsk_renderer_realize(renderer, NULL, &error)) {
+        g_printerr("Error inicializando el renderer cairo: %s\n", error->message);
+        g_clear_error(&error);
+        g_object_unref(renderer);
+        return 1;
+    }
+
+    RenderScene *scene = scene_new(&opts);
+    g_printerr("🧱 %u tiles en %d columnas de %dpx, viewport %dx%d @%.2f, %.0f px/s a %d FPS\n",
+               scene->tiles->len, scene->num_columns, scene->column_width,
+               opts.width, opts.height, opts.scale, opts.speed, opts.fps);
+
+    GString *json = g_string_new(NULL);
+    g_string_append(json, "{\n  \"benchmark\": \"wallpin-render\",\n  \"label\": ");
+    trace_append_json_string(json, opts.label);
+    g_string_append_printf(json, ",\n  \"timestamp\": %" G_GINT64_FORMAT ",\n  \"unit\": \"us\",\n"
+                           "  \"renderer\": \"cairo\",\n  \"viewport\": [%d, %d],\n  \"scale\": %.2f,\n"
+                           "  \"tiles\": %u,\n  \"speed\": %.1f,\n  \"fps\": %d,\n  \"variants\": [\n",
+                           g_get_real_time() / G_USEC_PER_SEC, opts.width, opts.height,
+                           opts.scale, scene->tiles->len, opts.speed, opts.fps);
+
+    int status = 0;
+    gboolean first = TRUE;
+    char **names = g_strsplit(opts.variants, ",", -1);
+    for (char **name = names; *name; name++) {
+        const RenderVariant *variant = find_variant(g_strstrip(*name));
+        if (!variant) {
+            g_printerr("Variante desconocida: %s\n", *name);
+            status = 1;
+            break;
+        }
+        run_variant(scene, renderer, variant, &opts, json, first);
+        first = FALSE;
+    }
+    g_strfreev(names);
+    g_string_append(json, "\n  ]\n}\n");
+
+    if (status == 0) {
+        if (opts.output) {
+            if (!g_file_set_contents(opts.output, json->str, json->len, &error)) {
+                g_printerr("Error escribiendo %s: %s\n", opts.output, error->message);
+                g_clear_error(&error);
+                status = 1;
+            }
+        } else {
+            g_print("%s", json->str);
+        }
+    }
+
+    g_string_free(json, TRUE);
+    scene_free(scene);
+    gsk_renderer_unrealize(renderer);
+    g_object_unref(renderer);
+    return status;
+}
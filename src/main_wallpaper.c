@@ -10,33 +10,135 @@ static void init_scroll_config(void);
 // Variables para auto-scroll infinitode with Layer Shell
 
 #include <gtk/gtk.h>
-#include <dirent.h>
+#include <glib-unix.h>
+#include <signal.h>
 #include <string.h>
+#include <math.h>
 #include "wallpaper.h"
 #include "config.h"
 #include "utils.h"
 #include "layout.h"
 #include "layer_shell.h"
 #include "color_analysis.h"
+#include "frame_stats.h"
+#include "control.h"
+#include "phash.h"
+#include "scroll_strip.h"
+#include "scanner.h"
+#include "prefetch.h"
+#include "image_loader.h"
+#include "decode_scheduler.h"
+#include "ingest.h"
+#include "pacing.h"
+#include "shard.h"
+#include "alloc_stats.h"
+#include "tile_bake.h"
+#include "decode_budget.h"
+#include "sample_pool.h"
+#include "shared_thumbnails.h"
+#include "trace.h"
 
-#define WINDOW_HEIGHT 1080
 #define CORNER_RADIUS 16
 
 static MasonryLayout layout;
 
 static GtkWidget *create_image_grid(void);
-static void load_images_from_directory(GtkBox *container, const char *dir_path);
-static void load_images_by_color_groups(GtkBox *container, const char *dir_path, ColorMode mode, int tolerance);
-static GtkWidget *create_rounded_image(const char *image_path, int target_width, int target_height);
+static void apply_color_order(ColorMode mode, int tolerance);
+static GtkWidget *create_rounded_image(int target_width, int target_height);
 static void render_layout(GtkBox *container);
+static void forget_tiles(void);
+static void cancel_color_order(void);
+static gboolean staged_wants(const char *path);
+static void start_sample_rotation(void);
+static void staged_offer_decoded(const char *path, GdkTexture *texture);
 
 // Función para configurar FPS sin afectar la velocidad
 static void set_target_fps(int fps);
+static void apply_adaptive_rate(void);
+static void start_scroll_timer(void);
+
+// Estado reutilizable entre cambios en caliente (canal de control)
+static GtkBox *grid_container = NULL;
+static GtkWidget *current_columns = NULL;      // Contenedor de columnas renderizado actualmente
+static GHashTable *tile_widgets = NULL;        // path -> GtkWidget ya decodificado
+static GPtrArray *tile_columns = NULL;         // Por columna, ImageInfo* ordenados por y (ver index_tile_columns)
+static GHashTable *resident_tiles = NULL;      // Rutas con textura, decode pedido o readahead hecho
+static GHashTable *color_cache = NULL;         // path -> Color
+static GHashTable *phash_cache = NULL;         // path -> PHash
+static gboolean dedup_enabled = TRUE;          // Omitir casi-duplicados (ver add_ingested)
+static char **current_asset_roots = NULL;      // Carpetas raíz (--dir, repetible)
+static ColorMode current_color_mode = COLOR_MODE_DEFAULT;
+static int current_color_tolerance = 50;
+
+// Carga de una colección: el scanner entrega rutas, los hilos de ingesta las decodifican
+// (ver decode_scheduler_ingest) y en el hilo principal solo entran al layout
+#define INGEST_CHUNK_SIZE 16           // Rutas por lote de ingesta: la primera pantalla no espera a un lote entero del scanner
+typedef struct {
+    MasonryLayout *layout;
+    SamplePool *pool;             // --sample: lo que no cabe en la ventana activa
+    GPtrArray *sample_paths;      // --sample: todo lo de este fragmento hasta elegir la ventana
+    PHashIndex *dedup_index;
+    int duplicates;
+    guint other_shards;           // Rutas que se quedan los demás monitores
+    guint in_flight;              // Lotes de ingesta sin entregar
+    gboolean scanned;             // El scanner terminó: la carga acaba al entregarse el último lote
+    guint total;
+    void (*on_loaded)(void);      // Escaneado e ingerido entero
+} CollectionLoad;
+
+// Escaneo en curso (ver load_collection)
+#define SCAN_RELAYOUT_INTERVAL_MS 250
+static Scanner *active_scanner = NULL;
+static CollectionLoad scan_load;
+static guint scan_relayout_id = 0;
+static gint64 scan_started_us = 0;
+static gboolean baked_tiles = FALSE;           // --baked-tiles: esquinas y sombra en los píxeles (ver tile_bake.h)
+static GCancellable *color_order_cancellable = NULL;   // Agrupación por color en curso (ver apply_color_order)
+static GList *pending_order = NULL;            // Orden completo por aplicar cuando el scroll vuelva al principio
+static Shard current_shard = SHARD_NONE;       // --shard i/n: parte de la colección de este monitor
+
+// --sample K: ventana activa acotada sobre una biblioteca enorme (ver sample_pool.h)
+#define SAMPLE_ROTATE_INTERVAL_S 8     // Como mucho un tile de la ventana cambia de imagen cada tanto
+static int sample_size = 0;                    // 0 = sin muestreo: toda la colección entra al layout
+static guint32 sample_seed = 0;
+static SamplePool *sample_pool = NULL;         // Rutas fuera de la ventana activa
+static GHashTable *sample_turns = NULL;        // path -> turno de rotación en que entró (0 = desde el escaneo)
+static guint sample_turn = 0;
+static guint sample_rotate_id = 0;
+static ImageInfo *sample_rotation_slot = NULL;  // Hueco de la rotación en curso (NULL = ninguna)
+
+// Cambio de colección en caliente (ver control_swap)
+#define SWAP_WARMUP_TIMEOUT_MS 5000    // Se cambia aunque falte algún tile de la primera pantalla
+#define SWAP_CROSSFADE_MS 400
+#define SWAP_RELEASE_BATCH 64          // Tiles de la colección anterior soltados por iteración
+#define SWAP_TEXTURES_KEEP_S 10        // Las texturas precalentadas sirven al strip hasta entonces
+static GHashTable *swap_textures = NULL;       // path -> GdkTexture de la primera pantalla tras un cambio
+static guint swap_textures_id = 0;
+static GPtrArray *swap_fades = NULL;           // Un GtkPicture por ventana para el fundido
+static gint64 crossfade_started_us = 0;
+
+// Trazas de arranque (--trace, ver trace.h)
+#define TRACE_STARTUP_DUMP_DELAY_S 5   // Tras el escaneo, margen para que entren las primeras decodificaciones
+static gint64 process_started_us = 0;
+
+// Decodificación por plazos (ver schedule_decodes)
+#define DECODE_SCHEDULE_INTERVAL_US (100 * 1000)   // Cada cuánto se recalculan los plazos durante el scroll
+static gint64 last_schedule_us = 0;
+
+// Geometría del monitor asignado (píxeles lógicos) y su factor de escala
+static int viewport_width = DEFAULT_MONITOR_WIDTH;
+static int viewport_height = DEFAULT_MONITOR_HEIGHT;
+static double viewport_scale = 1.0;
+static double viewport_refresh_hz = 0.0;       // 0 = el monitor no lo informa
+static guint viewport_idle_id = 0;
 
 // Variables para auto-scroll infinito
 static GtkWidget *main_scroll_window = NULL;
+static GtkWidget *scroll_strip = NULL;          // Solo en modo --low-power
+static GPtrArray *span_strips = NULL;           // --span: franjas de los demás monitores (siguen a scroll_strip)
 static GtkAdjustment *scroll_adjustment = NULL;
-static guint scroll_timer_id = 0;
+static guint scroll_timer_id = 0;               // Timer de --fps N, o tick callback de --fps auto en scroll_tick_widget
+static GtkWidget *scroll_tick_widget = NULL;
 static double current_scroll_position = 0.0;
 static gboolean auto_scroll_enabled = TRUE;
 
@@ -45,6 +147,12 @@ static int current_target_fps = 60;      // Valor por defecto
 static int current_scroll_interval = 16; // 60 FPS por defecto (1000/60)
 static double current_scroll_speed = 0.3; // Se calculará en base a velocidad configurada
 
+// Ritmo adaptativo (--fps auto, o "fps 0" por el canal de control; ver pacing.h)
+#define ADAPTIVE_FPS 0
+static gboolean adaptive_fps = FALSE;
+static gint64 last_tick_us = 0;                 // Frame time del último paso
+static int frames_since_tick = 0;               // Frames del frame clock desde el último paso
+
 // Variables configurables para velocidad
 static double current_speed_per_second = 18.0; // Velocidad configurable en px/s
 
@@ -65,148 +173,309 @@ static GtkWidget *create_image_grid(void) {
     return container;
 }
 
-static void load_images_by_color_groups(GtkBox *container, const char *dir_path, ColorMode mode, int tolerance) {
-    DIR *dir;
-    struct dirent *entry;
-    char full_path[PATH_MAX];
-    GList *image_files = NULL;
-    int image_count = 0;
-
-    masonry_layout_init(&layout, WINDOW_WIDTH, STANDARD_WIDTH, IMAGE_SPACING);
+// Cachés por ruta (color, hash): la entrada cuenta en ALLOC_COLOR mientras exista
+static void cache_store(GHashTable *cache, const char *path, gpointer value, gsize value_size) {
+    if (!g_hash_table_contains(cache, path)) {
+        ALLOC_STATS_ADD(ALLOC_COLOR, strlen(path) + 1 + value_size);
+    }
+    g_hash_table_replace(cache, g_strdup(path), value);
+}
 
-    dir = opendir(dir_path);
-    if (dir == NULL) {
-        g_print("Error opening directory: %s\n", dir_path);
-        return;
+static void cache_remove(GHashTable *cache, const char *path, gsize value_size) {
+    if (cache && g_hash_table_remove(cache, path)) {
+        ALLOC_STATS_SUB(ALLOC_COLOR, strlen(path) + 1 + value_size);
     }
+}
 
-    g_print("\nScanning directory: %s\n", dir_path);
-    g_print("=== WALLPAPER MODE - LOADING IMAGES BY COLOR ===\n");
-    g_print("🎨 Modo de color: %d | Tolerancia: %d\n", mode, tolerance);
-
-    // Recopilar archivos de imagen
-    while ((entry = readdir(dir)) != NULL) {
-        if (entry->d_type == DT_REG) {
-            const char *ext = strrchr(entry->d_name, '.');
-            if (ext && (strcasecmp(ext, ".jpg") == 0 ||
-                       strcasecmp(ext, ".jpeg") == 0 ||
-                       strcasecmp(ext, ".png") == 0)) {
-                snprintf(full_path, PATH_MAX, "%s/%s", dir_path, entry->d_name);
-                image_files = g_list_append(image_files, g_strdup(full_path));
-                image_count++;
-            }
+static void cache_clear(GHashTable *cache, gsize value_size) {
+    if (!cache) return;
+    if (alloc_stats_enabled) {
+        GHashTableIter iter;
+        gpointer key;
+        g_hash_table_iter_init(&iter, cache);
+        while (g_hash_table_iter_next(&iter, &key, NULL)) {
+            ALLOC_STATS_SUB(ALLOC_COLOR, strlen(key) + 1 + value_size);
         }
     }
-    closedir(dir);
+    g_hash_table_remove_all(cache);
+}
 
-    g_print("Found %d images for color analysis\n", image_count);
+static void free_ingest_result(IngestResult *result) {
+    ingest_result_clear(result);
+    g_free(result);
+}
 
-    if (image_count == 0) {
-        g_print("No images found, falling back to normal mode\n");
-        return;
-    }
+// La miniatura de la ingesta cubre el ancho del tile en píxeles de dispositivo más lo que
+// el balanceo de columnas puede estirarlo, así sirve tal cual para el primer decode del tile
+static int ingest_thumbnail_width(const MasonryLayout *target) {
+    return (int)ceil(masonry_layout_device_size(target, target->column_width) * (1.0 + BALANCE_MAX_STRETCH));
+}
 
-    // Agrupar imágenes por color
-    GList *color_groups = group_images_by_color(image_files, mode, tolerance);
-    print_color_analysis(color_groups);
+static void calculate_layout(void) {
+    TRACE_BEGIN(layout_start);
+    masonry_layout_calculate(&layout);
+    TRACE_END(layout_start, "layout", NULL);
+}
 
-    // Renderizar grupos de colores
-    for (GList *group_list = color_groups; group_list != NULL; group_list = group_list->next) {
-        ColorGroup *group = (ColorGroup *)group_list->data;
-        
-        g_print("🎨 Cargando grupo: %s (%d imágenes)\n", 
-                group->color_name, g_list_length(group->image_paths));
+// Cada lote del scanner entra al layout en cuanto llega; el relayout se agrupa
+// para no rehacer las columnas por cada carpeta
+static gboolean scan_relayout(G_GNUC_UNUSED gpointer user_data) {
+    scan_relayout_id = 0;
+    calculate_layout();
+    render_layout(grid_container);
+    return G_SOURCE_REMOVE;
+}
+
+static gint compare_path_ptrs(gconstpointer a, gconstpointer b) {
+    return g_strcmp0(*(const char * const *)a, *(const char * const *)b);
+}
+
+static void on_ingested(GPtrArray *paths, IngestResult **results, gpointer owner);
 
-        // Agregar imágenes del grupo al layout
-        for (GList *img_list = group->image_paths; img_list != NULL; img_list = img_list->next) {
-            const char *image_path = (const char *)img_list->data;
-            masonry_layout_add_image(&layout, image_path);
+// Rutas (propias) a los hilos de ingesta en trozos de INGEST_CHUNK_SIZE, en orden de nombre;
+// aquí no se lee ningún archivo
+static void submit_ingest(CollectionLoad *load, GPtrArray *files) {
+    g_ptr_array_sort(files, compare_path_ptrs);
+
+    int thumbnail_width = ingest_thumbnail_width(load->layout);
+    for (guint start = 0; start < files->len; start += INGEST_CHUNK_SIZE) {
+        guint count = MIN(INGEST_CHUNK_SIZE, files->len - start);
+        GPtrArray *chunk = g_ptr_array_new_full(count, g_free);
+        for (guint i = 0; i < count; i++) {
+            g_ptr_array_add(chunk, g_ptr_array_index(files, start + i));
         }
+        load->in_flight++;
+        decode_scheduler_ingest(chunk, thumbnail_width, on_ingested, load);
     }
+    g_ptr_array_unref(files);
+}
 
-    // Calcular layout y renderizar
-    masonry_layout_calculate(&layout);
-    render_layout(container);
+// Un lote del scanner hacia load: solo lo de este fragmento. Con pool (--sample) no se
+// ingiere nada todavía: la ventana se elige con todo escaneado (ver finish_scanning)
+static void submit_scan_batch(CollectionLoad *load, GPtrArray *paths) {
+    GPtrArray *files = g_ptr_array_new();
+    for (guint i = paths->len; i > 0; i--) {
+        // Lo de otros fragmentos ni se lee: cada monitor decodifica y guarda solo lo suyo
+        if (!shard_owns(current_shard, g_ptr_array_index(paths, i - 1))) {
+            load->other_shards++;
+            continue;
+        }
+        g_ptr_array_add(files, g_ptr_array_steal_index(paths, i - 1));
+    }
 
-    // Limpiar memoria
-    g_list_free_full(image_files, g_free);
-    g_list_free_full(color_groups, (GDestroyNotify)free_color_group);
+    if (load->pool) {
+        if (!load->sample_paths) load->sample_paths = g_ptr_array_new_with_free_func(g_free);
+        g_ptr_array_extend_and_steal(load->sample_paths, files);
+        return;
+    }
+    submit_ingest(load, files);
 }
 
-static void load_images_from_directory(GtkBox *container, const char *dir_path) {
-    DIR *dir;
-    struct dirent *entry;
-    char full_path[PATH_MAX];
-    GList *image_files = NULL;
-    int image_count = 0;
+// El scanner terminó. Con --sample la reserva se llena en orden de nombre, así la misma
+// semilla con los mismos archivos da la misma ventana llegue lo que llegue antes del
+// scanner, y la ventana activa son las K primeras por turno de subcarpeta
+static void finish_scanning(CollectionLoad *load, guint total) {
+    load->scanned = TRUE;
+    load->total = total;
+
+    if (load->pool && load->sample_paths) {
+        g_ptr_array_sort(load->sample_paths, compare_path_ptrs);
+        for (guint i = 0; i < load->sample_paths->len; i++) {
+            sample_pool_add(load->pool, g_ptr_array_index(load->sample_paths, i));
+        }
+        g_clear_pointer(&load->sample_paths, g_ptr_array_unref);
 
-    masonry_layout_init(&layout, WINDOW_WIDTH, STANDARD_WIDTH, IMAGE_SPACING);
+        GPtrArray *files = g_ptr_array_new();
+        for (int i = 0; i < sample_size; i++) {
+            char *path = sample_pool_take(load->pool);
+            if (!path) break;
+            g_ptr_array_add(files, path);
+        }
+        submit_ingest(load, files);
+    }
+    if (load->in_flight == 0) load->on_loaded();
+}
 
-    dir = opendir(dir_path);
-    if (dir == NULL) {
-        g_print("Error opening directory: %s\n", dir_path);
-        return;
+// Resultados de un lote en el layout de load (hilo principal, sin E/S): color y hash a
+// sus cachés, casi-duplicados fuera y la miniatura ofrecida al primer decode del tile.
+// Las ilegibles entran con el tamaño por defecto y su tile se queda vacío
+static void add_ingested(CollectionLoad *load, GPtrArray *paths, IngestResult **results) {
+    if (!phash_cache) {
+        phash_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    }
+    if (!color_cache) {
+        color_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
     }
 
-    g_print("\nScanning directory: %s\n", dir_path);
-    g_print("=== WALLPAPER MODE - LOADING IMAGES ===\n");
+    for (guint i = 0; i < paths->len; i++) {
+        const char *image_path = g_ptr_array_index(paths, i);
+        IngestResult *result = results[i];
+        if (!result) {
+            masonry_layout_add_image_with_size(load->layout, image_path, 0, 0);
+            continue;
+        }
 
-    while ((entry = readdir(dir)) != NULL) {
-        if (entry->d_type == DT_REG) {
-            const char *ext = strrchr(entry->d_name, '.');
-            if (ext && (strcasecmp(ext, ".jpg") == 0 ||
-                       strcasecmp(ext, ".jpeg") == 0 ||
-                       strcasecmp(ext, ".png") == 0)) {
-                snprintf(full_path, PATH_MAX, "%s/%s", dir_path, entry->d_name);
-                image_files = g_list_append(image_files, g_strdup(full_path));
-                image_count++;
+        const char *original = load->dedup_index ? phash_index_find(load->dedup_index, result->hash) : NULL;
+        if (original) {
+            if (load->duplicates < 10) {
+                char *dup_name = g_path_get_basename(image_path);
+                char *orig_name = g_path_get_basename(original);
+                g_print("   ♻️  %s ≈ %s\n", dup_name, orig_name);
+                g_free(dup_name);
+                g_free(orig_name);
             }
+            load->duplicates++;
+            continue;
+        }
+        if (load->dedup_index) phash_index_add(load->dedup_index, image_path, result->hash);
+
+        PHash *hash = g_new(PHash, 1);
+        *hash = result->hash;
+        cache_store(phash_cache, image_path, hash, sizeof(PHash));
+        Color *color = g_new(Color, 1);
+        *color = result->color;
+        cache_store(color_cache, image_path, color, sizeof(Color));
+        masonry_layout_add_image_with_size(load->layout, image_path, result->width, result->height);
+        image_loader_offer_thumbnail(image_path, result->thumbnail);
+    }
+}
+
+static void on_ingested(GPtrArray *paths, IngestResult **results, gpointer owner) {
+    CollectionLoad *load = owner;
+    load->in_flight--;
+
+    TRACE_BEGIN(batch_start);
+    gboolean first_batch = load->layout->images == NULL;
+    add_ingested(load, paths, results);
+    TRACE_END(batch_start, "scan_batch", NULL);
+
+    if (load == &scan_load) {
+        if (first_batch && layout.images) {
+            // Lo primero que aparece se muestra ya; el resto se acumula
+            scan_relayout(NULL);
+        } else if (scan_relayout_id == 0) {
+            scan_relayout_id = g_timeout_add(SCAN_RELAYOUT_INTERVAL_MS, scan_relayout, NULL);
         }
     }
+    if (load->scanned && load->in_flight == 0) load->on_loaded();
+}
 
-    g_print("Found %d images for wallpaper\n", image_count);
+static void on_scan_batch(GPtrArray *paths, G_GNUC_UNUSED gpointer user_data) {
+    submit_scan_batch(&scan_load, paths);
+}
+
+// Lo que quede de la carga anterior (lotes en los hilos incluidos) no llega a entregarse
+static void reset_scan_load(void) {
+    decode_scheduler_cancel_ingest(&scan_load);
+    g_clear_pointer(&scan_load.dedup_index, phash_index_free);
+    g_clear_pointer(&scan_load.sample_paths, g_ptr_array_unref);
+    memset(&scan_load, 0, sizeof(scan_load));
+}
+
+// Reserva nueva de --sample (o ninguna): la reserva y los turnos son de cada colección
+static void reset_sample_window(SamplePool *pool) {
+    // Una rotación en curso apunta a un hueco del layout que se va
+    decode_scheduler_cancel_ingest(&sample_rotation_slot);
+    sample_rotation_slot = NULL;
+    sample_pool_free(sample_pool);
+    sample_pool = pool;
+    if (sample_turns) g_hash_table_remove_all(sample_turns);
+    sample_turn = 0;
+}
+
+// La traza es del arranque: tras volcarla se deja de grabar, o un wallpaper que lleva
+// días en marcha acumularía un span por cada decodificación
+static gboolean dump_startup_trace(G_GNUC_UNUSED gpointer user_data) {
+    trace_shutdown();
+    return G_SOURCE_REMOVE;
+}
 
-    image_files = g_list_sort(image_files, (GCompareFunc)g_strcmp0);
+static void on_scan_done(guint total, G_GNUC_UNUSED gpointer user_data) {
+    TRACE_END(scan_started_us, "scan", NULL);
+    g_print("Found %u images for wallpaper (%.1fs)\n", total,
+            (g_get_monotonic_time() - scan_started_us) / (double)G_USEC_PER_SEC);
+    finish_scanning(&scan_load, total);
+}
 
-    for (GList *l = image_files; l != NULL; l = l->next) {
-        masonry_layout_add_image(&layout, (const char *)l->data);
-        g_free(l->data);
+// Escaneo terminado y último lote ingerido
+static void finish_scan(void) {
+    if (scan_relayout_id > 0) {
+        g_source_remove(scan_relayout_id);
+        scan_relayout_id = 0;
     }
 
-    g_list_free(image_files);
+    TRACE_END(scan_started_us, "scan_ingest", NULL);
+    if (current_shard.count > 1) {
+        g_print("🧩 Fragmento %d/%d: %u imágenes para este monitor, %u para los demás\n",
+                current_shard.index, current_shard.count, scan_load.total - scan_load.other_shards,
+                scan_load.other_shards);
+    }
+    if (scan_load.duplicates > 0) {
+        g_print("♻️  %d duplicados omitidos (%u imágenes únicas)\n",
+                scan_load.duplicates, phash_index_size(scan_load.dedup_index));
+    }
+    g_clear_pointer(&scan_load.dedup_index, phash_index_free);
 
-    masonry_layout_calculate(&layout);
-    render_layout(container);
-    closedir(dir);
+    if (!layout.images) {
+        g_print("No images to render\n");
+        return;
+    }
+    start_sample_rotation();
+
+    // Orden final: por nombre o por grupos de color, sin volver a leer nada del disco ni
+    // mover lo que ya está en pantalla
+    apply_color_order(current_color_mode, current_color_tolerance);
+
+    // La traza de arranque se vuelca cuando ya se decodificó lo visible (si se sale antes, al salir)
+    if (trace_enabled) {
+        g_timeout_add_seconds(TRACE_STARTUP_DUMP_DELAY_S, dump_startup_trace, NULL);
+    }
 }
 
-static GtkWidget *create_rounded_image(const char *image_path, int target_width, int target_height) {
-    GError *error = NULL;
-    
-    // Cargar la imagen completa
-    GdkPixbuf *original_pixbuf = gdk_pixbuf_new_from_file(image_path, &error);
-    
-    if (error) {
-        g_warning("Error loading image %s: %s", image_path, error->message);
-        g_error_free(error);
-        return gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+// Arranca (o reinicia) la carga de la colección desde todas las carpetas raíz
+static void load_collection(void) {
+    scanner_stop(active_scanner);
+    if (scan_relayout_id > 0) {
+        g_source_remove(scan_relayout_id);
+        scan_relayout_id = 0;
     }
+    reset_scan_load();
+    image_loader_clear_thumbnails();
+    cancel_color_order();
+    reset_sample_window(sample_size > 0 ? sample_pool_new(sample_seed) : NULL);
 
-    // Escalar la imagen
-    GdkPixbuf *scaled_pixbuf = gdk_pixbuf_scale_simple(original_pixbuf, 
-                                                        target_width, 
-                                                        target_height,
-                                                        GDK_INTERP_BILINEAR);
-    
-    g_object_unref(original_pixbuf);
+    forget_tiles();
+    masonry_layout_free(&layout);
+    masonry_layout_init(&layout, viewport_width, STANDARD_WIDTH, IMAGE_SPACING);
+    masonry_layout_set_viewport(&layout, viewport_width, viewport_scale);
+    if (baked_tiles) decode_scheduler_set_bake_scale(viewport_scale);
+
+    g_print("\n=== WALLPAPER MODE - SCANNING ===\n");
+    for (char **root = current_asset_roots; root && *root; root++) {
+        g_print("Scanning directory: %s\n", *root);
+    }
+    if (current_color_mode != COLOR_MODE_DEFAULT) {
+        g_print("🎨 Modo de color: %d | Tolerancia: %d\n", current_color_mode, current_color_tolerance);
+    }
+
+    scan_load.layout = &layout;
+    scan_load.pool = sample_pool;
+    scan_load.on_loaded = finish_scan;
+    scan_load.dedup_index = dedup_enabled ? phash_index_new(PHASH_DUPLICATE_DISTANCE) : NULL;
+    scan_started_us = g_get_monotonic_time();
+    active_scanner = scanner_start((const char * const *)current_asset_roots, on_scan_batch, on_scan_done, NULL);
+}
 
-    // Convertir a texture para GTK4
-    GdkTexture *texture = gdk_texture_new_for_pixbuf(scaled_pixbuf);
-    g_object_unref(scaled_pixbuf);
+// Lado del widget del tile: horneado, el margen de .rounded pasa a ser parte del tile
+static int tile_widget_size(int target_size) {
+    return baked_tiles ? target_size + 2 * TILE_BAKE_PADDING : target_size;
+}
 
-    // Crear GtkPicture con el texture
-    GtkWidget *picture = gtk_picture_new_for_paintable(GDK_PAINTABLE(texture));
-    g_object_unref(texture);
+// Tile vacío (solo el fondo de .rounded): la imagen la pone on_tile_decoded cuando el
+// planificador llega a ella, ver schedule_decodes. Con --baked-tiles el tile es solo
+// la textura (.baked): sin clip, fondo ni sombra que evaluar en cada frame
+static GtkWidget *create_rounded_image(int target_width, int target_height) {
+    GtkWidget *picture = gtk_picture_new();
 
     // Configurar las propiedades del picture
     gtk_picture_set_can_shrink(GTK_PICTURE(picture), TRUE);
@@ -215,84 +484,745 @@ static GtkWidget *create_rounded_image(const char *image_path, int target_width,
     // Crear el frame contenedor con bordes redondeados
     GtkWidget *frame = gtk_frame_new(NULL);
     gtk_frame_set_child(GTK_FRAME(frame), picture);
+    gtk_widget_set_size_request(frame, target_width, target_height);
 
     // Aplicar estilos CSS para bordes redondeados
-    gtk_widget_set_overflow(frame, GTK_OVERFLOW_HIDDEN);
-    gtk_widget_add_css_class(frame, "rounded");
+    if (baked_tiles) {
+        gtk_widget_add_css_class(frame, "baked");
+    } else {
+        gtk_widget_set_overflow(frame, GTK_OVERFLOW_HIDDEN);
+        gtk_widget_add_css_class(frame, "rounded");
+    }
     gtk_widget_add_css_class(frame, "image-card");
     
     // Asegurar que las imágenes puedan recibir eventos hover en modo wallpaper
     gtk_widget_set_sensitive(frame, TRUE);
     gtk_widget_set_can_focus(frame, FALSE); // No queremos focus, solo hover
 
+    ALLOC_STATS_TRACK(ALLOC_WIDGETS, frame, alloc_stats_instance_size(frame));
+    ALLOC_STATS_TRACK(ALLOC_WIDGETS, picture, alloc_stats_instance_size(picture));
     return frame;
 }
 
+static GtkPicture *tile_picture(GtkWidget *frame) {
+    return GTK_PICTURE(gtk_frame_get_child(GTK_FRAME(frame)));
+}
+
+// Última posición del scroll antes de volver al principio
+static double max_scroll_position(void) {
+    double max_scroll = scroll_adjustment
+        ? gtk_adjustment_get_upper(scroll_adjustment) - gtk_adjustment_get_page_size(scroll_adjustment)
+        : 0.0;
+    if (max_scroll <= 0) max_scroll = MAX(0.0, layout.content_height + 2.0 * TILE_TOP_OFFSET - viewport_height);
+    return max_scroll;
+}
+
+// Segundos hasta que el tile entra en pantalla (0 si ya se ve). El scroll es lineal y
+// vuelve al principio al llegar al final, así que lo ya pasado vuelve tras el salto.
+// También en pausa se usa la velocidad configurada: al reanudar, lo siguiente ya está listo
+static double tile_time_to_visible(const ImageInfo *info) {
+    double top = TILE_TOP_OFFSET + info->y;
+    double bottom = top + info->target_height;
+    double page = viewport_height;
+    double position = current_scroll_position;
+
+    if (bottom >= position && top <= position + page) return 0.0;
+    if (current_speed_per_second <= 0) return G_MAXDOUBLE;
+    if (top > position + page) return (top - position - page) / current_speed_per_second;
+
+    return (MAX(0.0, max_scroll_position() - position) + MAX(0.0, top - page)) / current_speed_per_second;
+}
+
+static gint compare_tile_y(gconstpointer a, gconstpointer b) {
+    const ImageInfo *first = *(ImageInfo * const *)a;
+    const ImageInfo *second = *(ImageInfo * const *)b;
+    return (first->y > second->y) - (first->y < second->y);
+}
+
+// Tiles de cada columna de arriba abajo (la cola balanceada no va en orden de la lista):
+// schedule_decodes busca en ellos solo la ventana del lookahead
+static void index_tile_columns(void) {
+    g_clear_pointer(&tile_columns, g_ptr_array_unref);
+    int num_columns = MAX(layout.num_columns, 1);
+    tile_columns = g_ptr_array_new_full(num_columns, (GDestroyNotify)g_ptr_array_unref);
+    for (int i = 0; i < num_columns; i++) g_ptr_array_add(tile_columns, g_ptr_array_new());
+
+    for (GList *l = layout.images; l != NULL; l = l->next) {
+        ImageInfo *info = l->data;
+        g_ptr_array_add(g_ptr_array_index(tile_columns, CLAMP(info->column, 0, num_columns - 1)), info);
+    }
+    for (int i = 0; i < num_columns; i++) g_ptr_array_sort(g_ptr_array_index(tile_columns, i), compare_tile_y);
+}
+
+// Al liberar o sustituir el layout o los widgets: el índice apunta a sus ImageInfo
+static void forget_tiles(void) {
+    g_clear_pointer(&tile_columns, g_ptr_array_unref);
+    if (resident_tiles) g_hash_table_remove_all(resident_tiles);
+}
+
+static void mark_resident(const char *path) {
+    if (!resident_tiles) resident_tiles = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    if (!g_hash_table_contains(resident_tiles, path)) g_hash_table_add(resident_tiles, g_strdup(path));
+}
+
+// Primer tile de la columna cuyo borde inferior llega a position (los tiles de una
+// columna no se solapan: ordenados por y, también lo están por su borde inferior)
+static guint first_tile_reaching(GPtrArray *column, double position) {
+    guint low = 0, high = column->len;
+    while (low < high) {
+        guint mid = low + (high - low) / 2;
+        const ImageInfo *info = g_ptr_array_index(column, mid);
+        if (TILE_TOP_OFFSET + info->y + info->target_height < position) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// Un tile de la ventana: lo que entra en pantalla dentro del lookahead se encola por
+// plazo, lo que viene después se cancela y solo recibe readahead
+static void schedule_tile(ImageInfo *info, double lookahead, GHashTable *seen) {
+    GtkWidget *frame = g_hash_table_lookup(tile_widgets, info->path);
+    if (!frame || g_object_get_data(G_OBJECT(frame), "decode-failed")) return;
+
+    double eta = tile_time_to_visible(info);
+    if (eta > lookahead * DECODE_RELEASE_FACTOR) return;   // Lo suelta el barrido de schedule_decodes
+    g_hash_table_add(seen, info->path);
+
+    GtkPicture *picture = tile_picture(frame);
+    gboolean decoded = gtk_picture_get_paintable(picture) != NULL;
+    if (eta <= lookahead) {
+        if (!decoded) {
+            decode_scheduler_submit(info->path,
+                                    masonry_layout_device_size(&layout, tile_widget_size(info->target_width)),
+                                    masonry_layout_device_size(&layout, tile_widget_size(info->target_height)),
+                                    eta);
+        }
+        mark_resident(info->path);
+        return;
+    }
+
+    if (!staged_wants(info->path)) decode_scheduler_cancel(info->path);
+    if (!decoded && !g_object_get_data(G_OBJECT(frame), "prefetch-hinted")) {
+        // Siguiente ventana: solo readahead del kernel, una vez por tile
+        prefetch_hint(info->path);
+        g_object_set_data(G_OBJECT(frame), "prefetch-hinted", GINT_TO_POINTER(TRUE));
+    }
+    if (decoded || g_object_get_data(G_OBJECT(frame), "prefetch-hinted")) mark_resident(info->path);
+}
+
+// Recalcula los plazos de la ventana de lookahead × DECODE_RELEASE_FACTOR (búsqueda
+// binaria por columna: el coste no crece con la colección) y suelta lo residente que
+// quedó fuera, que tardará mucho en volver a verse (residencia mínima: solo lo visible
+// y lo que está por llegar)
+static void schedule_decodes(void) {
+    if (!tile_widgets || !tile_columns || scroll_strip) return;
+
+    last_schedule_us = g_get_monotonic_time();
+    double lookahead = decode_scheduler_get_lookahead();
+    double position = current_scroll_position;
+    double page = viewport_height;
+    double reach = current_speed_per_second > 0 ? current_speed_per_second * lookahead * DECODE_RELEASE_FACTOR : 0.0;
+    // Lo ya pasado vuelve tras el salto al principio, con lo que queda hasta el final de ventaja
+    double wrap_limit = current_speed_per_second > 0 ? page + reach - MAX(0.0, max_scroll_position() - position) : -1.0;
+
+    GHashTable *seen = g_hash_table_new(g_str_hash, g_str_equal);
+    for (guint c = 0; c < tile_columns->len; c++) {
+        GPtrArray *column = g_ptr_array_index(tile_columns, c);
+        guint start = first_tile_reaching(column, position);
+        for (guint i = 0; i < start; i++) {
+            ImageInfo *info = g_ptr_array_index(column, i);
+            if (TILE_TOP_OFFSET + info->y > wrap_limit) break;
+            schedule_tile(info, lookahead, seen);
+        }
+        for (guint i = start; i < column->len; i++) {
+            ImageInfo *info = g_ptr_array_index(column, i);
+            if (TILE_TOP_OFFSET + info->y > position + page + reach) break;
+            schedule_tile(info, lookahead, seen);
+        }
+    }
+
+    // Fuera de la ventana solo queda por tocar lo que tiene textura, decode o readahead
+    if (resident_tiles) {
+        GHashTableIter iter;
+        gpointer path;
+        g_hash_table_iter_init(&iter, resident_tiles);
+        while (g_hash_table_iter_next(&iter, &path, NULL)) {
+            if (g_hash_table_contains(seen, path)) continue;
+
+            if (!staged_wants(path)) decode_scheduler_cancel(path);
+            GtkWidget *frame = g_hash_table_lookup(tile_widgets, path);
+            if (frame) {
+                gtk_picture_set_paintable(tile_picture(frame), NULL);
+                g_object_set_data(G_OBJECT(frame), "prefetch-hinted", NULL);
+            }
+            g_hash_table_iter_remove(&iter);
+        }
+    }
+    g_hash_table_destroy(seen);
+}
+
+static void on_tile_decoded(const char *path, GdkTexture *texture, G_GNUC_UNUSED gpointer user_data) {
+    // La misma imagen puede estar también en la colección que se prepara
+    staged_offer_decoded(path, texture);
+
+    if (scroll_strip) {
+        scroll_strip_offer_texture(WALLPIN_SCROLL_STRIP(scroll_strip), path, texture);
+        for (guint i = 0; span_strips && i < span_strips->len; i++) {
+            scroll_strip_offer_texture(WALLPIN_SCROLL_STRIP(g_ptr_array_index(span_strips, i)), path, texture);
+        }
+        return;
+    }
+
+    GtkWidget *frame = tile_widgets ? g_hash_table_lookup(tile_widgets, path) : NULL;
+    if (!frame) return;
+
+    if (!texture) {
+        // No se reintenta en cada pasada; el tile se queda con el fondo
+        g_object_set_data(G_OBJECT(frame), "decode-failed", GINT_TO_POINTER(TRUE));
+        return;
+    }
+
+    // Un relayout pudo cambiar el tamaño mientras se decodificaba: la próxima pasada lo vuelve a pedir
+    int width, height;
+    gtk_widget_get_size_request(frame, &width, &height);
+    if (gdk_texture_get_width(texture) != masonry_layout_device_size(&layout, width) ||
+        gdk_texture_get_height(texture) != masonry_layout_device_size(&layout, height)) {
+        return;
+    }
+
+    gtk_picture_set_paintable(tile_picture(frame), GDK_PAINTABLE(texture));
+    mark_resident(path);   // Si ya salió de la ventana, la próxima pasada la suelta
+}
+
+// Textura ya decodificada para la primera pantalla tras un cambio de colección, si
+// tiene exactamente el tamaño que se pide (referencia nueva)
+static GdkTexture *take_swap_texture(const char *image_path, int device_width, int device_height) {
+    GdkTexture *texture = swap_textures ? g_hash_table_lookup(swap_textures, image_path) : NULL;
+    if (!texture || gdk_texture_get_width(texture) != device_width ||
+        gdk_texture_get_height(texture) != device_height) {
+        return NULL;
+    }
+    return g_object_ref(texture);
+}
+
+// Textura para el strip pre-compuesto: la del cambio de colección si ya está, si no
+// se encola en el planificador (mismo decodificado que los tiles normales) con el plazo
+// que da la distancia a la velocidad actual, y llega por on_tile_decoded
+static GdkTexture *request_strip_texture(const char *image_path, int device_width, int device_height,
+                                         double distance) {
+    GdkTexture *warm = take_swap_texture(image_path, device_width, device_height);
+    if (warm) return warm;
+
+    double deadline = current_speed_per_second > 0 ? distance / current_speed_per_second
+                                                   : (distance > 0 ? DECODE_LOOKAHEAD_MAX : 0.0);
+    decode_scheduler_submit(image_path, device_width, device_height, deadline);
+    return NULL;
+}
+
 static void render_layout(GtkBox *container) {
     if (!layout.images) {
         g_print("No images to render\n");
         return;
     }
 
+    // Modo bajo consumo: no hay widgets por tile, el strip compone columnas enteras
+    if (scroll_strip) {
+        scroll_strip_set_layout(WALLPIN_SCROLL_STRIP(scroll_strip), &layout);
+        for (guint i = 0; span_strips && i < span_strips->len; i++) {
+            scroll_strip_set_layout(WALLPIN_SCROLL_STRIP(g_ptr_array_index(span_strips, i)), &layout);
+        }
+        return;
+    }
+
+    TRACE_BEGIN(widgets_start);
     int num_images = g_list_length(layout.images);
     g_print("\nRendering %d images in wallpaper masonry layout...\n", num_images);
 
-    int container_width = WINDOW_WIDTH - (IMAGE_SPACING * 2);
-    int num_columns = container_width / (STANDARD_WIDTH + IMAGE_SPACING);
-    
-    // Usar MAX_IMAGES_PER_ROW del layout.h
-    if (num_columns > MAX_IMAGES_PER_ROW) num_columns = MAX_IMAGES_PER_ROW;
-    if (num_columns < 2) num_columns = 2;
+    // Columnas y ancho derivados del monitor (ver masonry_layout_set_viewport)
+    int num_columns = layout.num_columns;
+
+    g_print("Using %d columns of %dpx for a %dpx wide monitor (scale %.2f), column height %dpx\n\n",
+            num_columns, layout.column_width, layout.grid_width, layout.scale, layout.content_height);
 
-    g_print("Using %d columns for wallpaper layout (max allowed: %d)\n\n", num_columns, MAX_IMAGES_PER_ROW);
+    // Descartar el render anterior; los tiles siguen vivos en tile_widgets
+    if (current_columns) {
+        gtk_box_remove(container, current_columns);
+        current_columns = NULL;
+    }
+    if (!tile_widgets) {
+        tile_widgets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_object_unref);
+    }
 
     GtkWidget *columns_container = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, IMAGE_SPACING);
     gtk_widget_set_halign(columns_container, GTK_ALIGN_CENTER);
     gtk_box_append(container, columns_container);
+    current_columns = columns_container;
 
     GtkWidget **columns = g_new0(GtkWidget*, num_columns);
-    int *column_heights = g_new0(int, num_columns);
 
     for (int i = 0; i < num_columns; i++) {
         columns[i] = gtk_box_new(GTK_ORIENTATION_VERTICAL, IMAGE_SPACING);
         gtk_widget_set_halign(columns[i], GTK_ALIGN_START);
         gtk_widget_set_valign(columns[i], GTK_ALIGN_START);
         gtk_box_append(GTK_BOX(columns_container), columns[i]);
-        column_heights[i] = 0;
     }
 
-    int image_index = 0;
+    // masonry_layout_calculate ya asignó columna a cada imagen, en orden de arriba abajo
     for (GList *l = layout.images; l != NULL; l = l->next) {
         ImageInfo *info = (ImageInfo *)l->data;
 
-        int shortest_column = 0;
-        for (int i = 1; i < num_columns; i++) {
-            if (column_heights[i] < column_heights[shortest_column]) {
-                shortest_column = i;
+        int widget_width = tile_widget_size(info->target_width);
+        int widget_height = tile_widget_size(info->target_height);
+
+        GtkWidget *image_widget = g_hash_table_lookup(tile_widgets, info->path);
+        if (image_widget) {
+            // Tile reutilizado: solo hay que sacarlo de su columna anterior
+            GtkWidget *parent = gtk_widget_get_parent(image_widget);
+            if (parent) {
+                gtk_box_remove(GTK_BOX(parent), image_widget);
+            }
+
+            // El balanceo pudo cambiarle el alto: se vuelve a decodificar al tamaño exacto
+            int cached_width, cached_height;
+            gtk_widget_get_size_request(image_widget, &cached_width, &cached_height);
+            if (cached_width != widget_width || cached_height != widget_height) {
+                gtk_picture_set_paintable(tile_picture(image_widget), NULL);
+                decode_scheduler_cancel(info->path);
+            }
+        }
+        if (!image_widget) {
+            image_widget = create_rounded_image(widget_width, widget_height);
+            g_hash_table_insert(tile_widgets, g_strdup(info->path), g_object_ref_sink(image_widget));
+
+            // Tras un cambio de colección la primera pantalla ya viene decodificada
+            GdkTexture *warm = take_swap_texture(info->path,
+                                                 masonry_layout_device_size(&layout, widget_width),
+                                                 masonry_layout_device_size(&layout, widget_height));
+            if (warm) {
+                gtk_picture_set_paintable(tile_picture(image_widget), GDK_PAINTABLE(warm));
+                mark_resident(info->path);
+                g_object_unref(warm);
             }
         }
 
-        int widget_width = STANDARD_WIDTH;
-        int widget_height = info->target_height;
+        gtk_widget_set_size_request(image_widget, widget_width, widget_height);
+        gtk_box_append(GTK_BOX(columns[CLAMP(info->column, 0, num_columns - 1)]), image_widget);
+    }
 
-        GtkWidget *image_widget = create_rounded_image(info->path, widget_width, widget_height);
+    g_print("\n=== WALLPAPER LAYOUT READY (decoding by deadline, lookahead %.1fs) ===\n",
+            decode_scheduler_get_lookahead());
 
-        gtk_widget_set_size_request(image_widget, widget_width, widget_height);
-        gtk_box_append(GTK_BOX(columns[shortest_column]), image_widget);
-        column_heights[shortest_column] += widget_height + IMAGE_SPACING;
+    g_free(columns);
+    index_tile_columns();
+    TRACE_END(widgets_start, "widgets", NULL);
+
+    // Lo visible primero; el resto lo va pidiendo auto_scroll_tick según avanza el scroll
+    schedule_decodes();
+}
+
+// Recoloca los tiles existentes en un nuevo orden: sin I/O ni decodificación
+static void relayout_with_order(GList *ordered_paths) {
+    if (!grid_container || !layout.images) return;
+
+    masonry_layout_reorder(&layout, ordered_paths);
+    calculate_layout();
+    render_layout(grid_container);
+}
+
+static GList *current_layout_paths(void) {
+    GList *paths = NULL;
+    for (GList *l = layout.images; l != NULL; l = l->next) {
+        paths = g_list_prepend(paths, ((ImageInfo *)l->data)->path);
+    }
+    return g_list_reverse(paths);
+}
+
+static void clear_pending_order(void) {
+    g_list_free_full(pending_order, g_free);
+    pending_order = NULL;
+}
+
+// Posición de un tile visible antes de reordenar, para comprobar que no se mueve
+typedef struct {
+    ImageInfo *info;
+    int column;
+    int y;
+    int target_width;
+    int target_height;
+} TilePlacement;
+
+// Aplica un orden sin mover nada de lo que se ve. El layout coloca las imágenes en
+// orden, así que se conserva el orden actual hasta el último tile visible y solo lo
+// que viene detrás (fuera de pantalla) toma el orden nuevo. La cola que se balancea
+// depende de todo el resto: si aun así algún tile visible cambiara de sitio, el layout
+// se queda como estaba. El orden completo se aplica al volver el scroll al principio
+static void apply_order_progressively(GList *ordered) {
+    clear_pending_order();
+    if (!grid_container || !layout.images) return;
+
+    GArray *visible = g_array_new(FALSE, FALSE, sizeof(TilePlacement));
+    int last_visible = -1;
+    int index = 0;
+    for (GList *l = layout.images; l != NULL; l = l->next, index++) {
+        ImageInfo *info = (ImageInfo *)l->data;
+        if (tile_time_to_visible(info) > 0.0) continue;
+        TilePlacement placement = { info, info->column, info->y, info->target_width, info->target_height };
+        g_array_append_val(visible, placement);
+        last_visible = index;
+    }
+
+    if (last_visible < 0) {
+        // Aún no hay nada en pantalla: se puede aplicar entero
+        g_array_unref(visible);
+        relayout_with_order(ordered);
+        return;
+    }
 
-        image_index++;
+    GList *previous = current_layout_paths();
+    GHashTable *frozen = g_hash_table_new(g_str_hash, g_str_equal);
+    GList *next = NULL;
+    gboolean prefix_sorted = TRUE;
+    GList *target = ordered;
+    index = 0;
+    for (GList *l = previous; l != NULL && index <= last_visible; l = l->next, index++) {
+        g_hash_table_add(frozen, l->data);
+        next = g_list_prepend(next, l->data);
+        if (prefix_sorted && (!target || g_strcmp0(target->data, l->data) != 0)) prefix_sorted = FALSE;
+        if (target) target = target->next;
     }
+    for (GList *l = ordered; l != NULL; l = l->next) {
+        if (!g_hash_table_contains(frozen, l->data)) next = g_list_prepend(next, l->data);
+    }
+    next = g_list_reverse(next);
 
-    g_print("\n=== WALLPAPER IMAGES LOADED ===\n");
+    masonry_layout_reorder(&layout, next);
+    calculate_layout();
 
-    g_free(columns);
-    g_free(column_heights);
+    gboolean moved = FALSE;
+    for (guint i = 0; i < visible->len && !moved; i++) {
+        const TilePlacement *placement = &g_array_index(visible, TilePlacement, i);
+        const ImageInfo *info = placement->info;
+        moved = info->column != placement->column || info->y != placement->y ||
+                info->target_width != placement->target_width || info->target_height != placement->target_height;
+    }
+
+    if (moved) {
+        masonry_layout_reorder(&layout, previous);
+        calculate_layout();
+        prefix_sorted = FALSE;
+    } else {
+        render_layout(grid_container);
+    }
+
+    if (!prefix_sorted) {
+        for (GList *l = ordered; l != NULL; l = l->next) {
+            pending_order = g_list_prepend(pending_order, g_strdup(l->data));
+        }
+        pending_order = g_list_reverse(pending_order);
+    }
+
+    if (moved) {
+        g_print("🔀 Nuevo orden pendiente: se aplica al volver el scroll al principio\n");
+    } else {
+        g_print("🔀 Orden aplicado fuera de pantalla (%u tiles visibles intactos)%s\n", visible->len,
+                pending_order ? "; el resto al volver al principio" : "");
+    }
+
+    g_list_free(next);
+    g_list_free(previous);
+    g_hash_table_destroy(frozen);
+    g_array_unref(visible);
 }
 
-static gboolean auto_scroll_tick(G_GNUC_UNUSED gpointer user_data) {
+// El scroll acaba de saltar al principio: lo que había en pantalla ya no se ve
+static void apply_pending_order(void) {
+    GList *ordered = pending_order;
+    pending_order = NULL;
+    relayout_with_order(ordered);
+    g_list_free_full(ordered, g_free);
+}
+
+// Agrupación por color en un hilo: los colores suelen venir ya de la ingesta; solo se
+// decodifica lo que falte. El hilo trabaja sobre copias y no toca las cachés
+typedef struct {
+    GList *paths;              // Rutas propias, por nombre
+    Color *colors;             // Uno por ruta
+    gboolean *missing;         // Sin color en caché: se calcula en el hilo
+    int analyzed;
+    int tolerance;
+} ColorOrderJob;
+
+static void free_color_order_job(ColorOrderJob *job) {
+    g_list_free_full(job->paths, g_free);
+    g_free(job->colors);
+    g_free(job->missing);
+    g_free(job);
+}
+
+static void free_color_groups(GList *groups) {
+    g_list_free_full(groups, (GDestroyNotify)free_color_group);
+}
+
+static void color_order_thread(GTask *task, G_GNUC_UNUSED gpointer source, gpointer task_data,
+                               GCancellable *cancellable) {
+    ColorOrderJob *job = task_data;
+    trace_set_thread_name("color");
+
+    TRACE_BEGIN(colors_start);
+    int index = 0;
+    for (GList *l = job->paths; l != NULL; l = l->next, index++) {
+        if (!job->missing[index]) continue;
+        if (g_cancellable_is_cancelled(cancellable)) break;
+        TRACE_BEGIN(color_start);
+        job->colors[index] = extract_dominant_color(l->data);
+        TRACE_END(color_start, "color", l->data);
+        job->analyzed++;
+    }
+    TRACE_END(colors_start, "color_analysis", NULL);
+    if (g_task_return_error_if_cancelled(task)) return;
+
+    TRACE_BEGIN(grouping_start);
+    GList *groups = group_images_by_precomputed_colors(job->paths, job->colors, job->tolerance);
+    TRACE_END(grouping_start, "grouping", NULL);
+    g_task_return_pointer(task, groups, (GDestroyNotify)free_color_groups);
+}
+
+static void on_color_order_ready(G_GNUC_UNUSED GObject *source, GAsyncResult *result,
+                                 G_GNUC_UNUSED gpointer user_data) {
+    GTask *task = G_TASK(result);
+    GError *error = NULL;
+    GList *groups = g_task_propagate_pointer(task, &error);
+    if (error) {
+        // Cancelada: otro orden o una recarga la sustituyó
+        g_error_free(error);
+        return;
+    }
+    g_clear_object(&color_order_cancellable);
+
+    ColorOrderJob *job = g_task_get_task_data(task);
+    int index = 0;
+    for (GList *l = job->paths; l != NULL; l = l->next, index++) {
+        if (!job->missing[index]) continue;
+        Color *color = g_new(Color, 1);
+        *color = job->colors[index];
+        cache_store(color_cache, l->data, color, sizeof(Color));
+    }
+
+    GList *ordered = NULL;
+    for (GList *g = groups; g != NULL; g = g->next) {
+        ColorGroup *group = (ColorGroup *)g->data;
+        for (GList *img = group->image_paths; img != NULL; img = img->next) {
+            ordered = g_list_prepend(ordered, img->data);
+        }
+    }
+    ordered = g_list_reverse(ordered);
+
+    g_print("✅ Análisis completado: %d grupos de colores (%d analizadas, %d desde caché)\n",
+            g_list_length(groups), job->analyzed, (int)g_list_length(job->paths) - job->analyzed);
+    apply_order_progressively(ordered);
+
+    g_list_free(ordered);
+    free_color_groups(groups);
+}
+
+static void cancel_color_order(void) {
+    if (color_order_cancellable) {
+        g_cancellable_cancel(color_order_cancellable);
+        g_clear_object(&color_order_cancellable);
+    }
+    clear_pending_order();
+}
+
+// Orden final: por nombre, o por grupos de color calculados en segundo plano. Mientras
+// tanto se sigue viendo el orden actual, y al llegar el nuevo no se mueve nada visible
+static void apply_color_order(ColorMode mode, int tolerance) {
+    cancel_color_order();
+    GList *paths = g_list_sort(current_layout_paths(), (GCompareFunc)g_strcmp0);
+
+    if (mode == COLOR_MODE_DEFAULT) {
+        apply_order_progressively(paths);
+        g_list_free(paths);
+        return;
+    }
+    if (!color_cache) {
+        color_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    }
+
+    ColorOrderJob *job = g_new0(ColorOrderJob, 1);
+    int total = g_list_length(paths);
+    job->colors = g_new0(Color, MAX(total, 1));
+    job->missing = g_new0(gboolean, MAX(total, 1));
+    job->tolerance = tolerance;
+    int index = 0;
+    for (GList *l = paths; l != NULL; l = l->next, index++) {
+        job->paths = g_list_prepend(job->paths, g_strdup(l->data));
+        Color *cached = g_hash_table_lookup(color_cache, l->data);
+        if (cached) {
+            job->colors[index] = *cached;
+        } else {
+            job->missing[index] = TRUE;
+        }
+    }
+    job->paths = g_list_reverse(job->paths);
+    g_list_free(paths);
+
+    g_print("🎨 Agrupando por color %d imágenes en segundo plano (modo: %d)...\n", total, mode);
+    color_order_cancellable = g_cancellable_new();
+    GTask *task = g_task_new(NULL, color_order_cancellable, on_color_order_ready, NULL);
+    g_task_set_task_data(task, job, (GDestroyNotify)free_color_order_job);
+    g_task_run_in_thread(task, color_order_thread);
+    g_object_unref(task);
+}
+
+// === Modo muestreo (--sample) ===
+// Solo K imágenes en el layout; según los tiles pasan por arriba, el que lleva más
+// tiempo en la ventana recibe una imagen de la reserva en el mismo hueco (recorte tipo
+// cover), así que nada de lo que está en pantalla se mueve y el coste no depende del
+// tamaño de la biblioteca. La imagen saliente vuelve a la reserva
+
+// Tile más antiguo de la ventana entre los que ya pasaron por arriba y aún tardarán en
+// volver a verse (tras el salto al principio, o al dar la vuelta el strip)
+static ImageInfo *oldest_recycled_tile(void) {
+    double lookahead = decode_scheduler_get_lookahead();
+    double period = layout.content_height + TILE_VERTICAL_GAP;
+    double margin = lookahead * current_speed_per_second;
+    ImageInfo *oldest = NULL;
+    guint oldest_turn = G_MAXUINT;
+
+    for (GList *l = layout.images; l != NULL; l = l->next) {
+        ImageInfo *info = l->data;
+        double top = TILE_TOP_OFFSET + info->y;
+        if (top + info->target_height >= current_scroll_position) continue;   // Visible o por llegar
+        // El strip no salta: lo de arriba vuelve a asomar por abajo al final del periodo
+        if (scroll_strip && top + period < current_scroll_position + viewport_height + margin) continue;
+        if (tile_time_to_visible(info) <= lookahead) continue;
+
+        guint turn = sample_turns ? GPOINTER_TO_UINT(g_hash_table_lookup(sample_turns, info->path)) : 0;
+        if (turn < oldest_turn) {
+            oldest = info;
+            oldest_turn = turn;
+        }
+    }
+    return oldest;
+}
+
+// Los siguientes SAMPLE_CANDIDATES de la reserva; el hilo de ingesta se queda con el de
+// proporción más parecida a la del hueco (ver decode_scheduler_ingest_closest)
+static GPtrArray *take_sample_candidates(void) {
+    GPtrArray *candidates = g_ptr_array_new_with_free_func(g_free);
+    for (int i = 0; i < SAMPLE_CANDIDATES; i++) {
+        char *path = sample_pool_take(sample_pool);
+        if (!path) break;
+        g_ptr_array_add(candidates, path);
+    }
+    return candidates;
+}
+
+// Casi igual que algo que ya está en la ventana (el índice del escaneo ya no existe)
+static gboolean sample_is_duplicate(PHash hash) {
+    if (!dedup_enabled || !phash_cache) return FALSE;
+
+    for (GList *l = layout.images; l != NULL; l = l->next) {
+        PHash *other = g_hash_table_lookup(phash_cache, ((ImageInfo *)l->data)->path);
+        if (other && phash_is_duplicate(hash, *other)) return TRUE;
+    }
+    return FALSE;
+}
+
+// Misma posición, otra imagen: el tile (widget o trozo del strip) se vacía y el
+// planificador lo decodifica antes de que vuelva a verse
+static void replace_sample_tile(ImageInfo *slot, const char *path, const IngestResult *result) {
+    char *old_path = g_strdup(slot->path);
+    if (!phash_cache) phash_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    if (!color_cache) color_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    PHash *hash = g_new(PHash, 1);
+    *hash = result->hash;
+    cache_store(phash_cache, path, hash, sizeof(PHash));
+    Color *color = g_new(Color, 1);
+    *color = result->color;
+    cache_store(color_cache, path, color, sizeof(Color));
+    masonry_layout_replace_image(&layout, slot, path, result->width, result->height);
+    image_loader_offer_thumbnail(path, result->thumbnail);
+    decode_scheduler_cancel(old_path);
+
+    gpointer key, frame;
+    if (tile_widgets && g_hash_table_steal_extended(tile_widgets, old_path, &key, &frame)) {
+        g_free(key);
+        gtk_picture_set_paintable(tile_picture(frame), NULL);
+        g_object_set_data(G_OBJECT(frame), "decode-failed", NULL);
+        g_object_set_data(G_OBJECT(frame), "prefetch-hinted", NULL);
+        g_hash_table_insert(tile_widgets, g_strdup(path), frame);
+        if (resident_tiles) g_hash_table_remove(resident_tiles, old_path);
+    }
+    if (scroll_strip) {
+        scroll_strip_replace_tile(WALLPIN_SCROLL_STRIP(scroll_strip), old_path, path);
+        for (guint i = 0; span_strips && i < span_strips->len; i++) {
+            scroll_strip_replace_tile(WALLPIN_SCROLL_STRIP(g_ptr_array_index(span_strips, i)), old_path, path);
+        }
+    }
+
+    cache_remove(color_cache, old_path, sizeof(Color));
+    cache_remove(phash_cache, old_path, sizeof(PHash));
+    if (!sample_turns) sample_turns = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    g_hash_table_remove(sample_turns, old_path);
+    g_hash_table_insert(sample_turns, g_strdup(path), GUINT_TO_POINTER(++sample_turn));
+    sample_pool_return(sample_pool, old_path);
+}
+
+// Con la entrega en el hilo principal solo queda comprobar que no repite nada visible
+// y cambiar el tile; los demás candidatos vuelven a la reserva
+static void on_sample_ingested(GPtrArray *paths, IngestResult **results, G_GNUC_UNUSED gpointer owner) {
+    ImageInfo *slot = g_steal_pointer(&sample_rotation_slot);
+    IngestResult *result = results[0];
+
+    TRACE_BEGIN(rotate_start);
+    // El hueco pudo dejar de existir (relayout) entre la petición y la entrega
+    gboolean replaced = result && g_list_find(layout.images, slot) && !sample_is_duplicate(result->hash);
+    if (replaced) replace_sample_tile(slot, g_ptr_array_index(paths, 0), result);
+    for (guint i = 0; i < paths->len; i++) {
+        // Repetida de algo visible o sin hueco: se queda en la reserva para más adelante.
+        // Ilegible: sale de la rotación
+        if (i == 0 && (replaced || !result)) continue;
+        sample_pool_return(sample_pool, g_strdup(g_ptr_array_index(paths, i)));
+    }
+    TRACE_END(rotate_start, "sample_rotate", NULL);
+}
+
+static gboolean rotate_sample(G_GNUC_UNUSED gpointer user_data) {
+    // En pausa nada pasa por arriba; sin reserva no hay con qué rotar. Una rotación a la vez
+    if (!auto_scroll_enabled || sample_pool_size(sample_pool) == 0 || !layout.images) return G_SOURCE_CONTINUE;
+    if (sample_rotation_slot) return G_SOURCE_CONTINUE;
+
+    ImageInfo *slot = oldest_recycled_tile();
+    if (!slot) return G_SOURCE_CONTINUE;
+
+    sample_rotation_slot = slot;
+    decode_scheduler_ingest_closest(take_sample_candidates(),
+                                    (double)slot->target_width / MAX(slot->target_height, 1),
+                                    ingest_thumbnail_width(&layout), on_sample_ingested, &sample_rotation_slot);
+    return G_SOURCE_CONTINUE;
+}
+
+static void start_sample_rotation(void) {
+    if (!sample_pool) return;
+
+    g_print("🎲 Muestreo: %u imágenes activas, %u en reserva de %u subcarpetas (semilla %u)\n",
+            g_hash_table_size(layout.loaded_paths), sample_pool_size(sample_pool),
+            sample_pool_folders(sample_pool), sample_seed);
+    if (sample_rotate_id == 0 && sample_pool_size(sample_pool) > 0) {
+        sample_rotate_id = g_timeout_add_seconds(SAMPLE_ROTATE_INTERVAL_S, rotate_sample, NULL);
+    }
+}
+
+// Un paso del auto-scroll de delta píxeles lógicos
+static void scroll_step(double delta) {
+    FRAME_STATS_TICK();
+
     if (!auto_scroll_enabled || !scroll_adjustment) {
-        return G_SOURCE_CONTINUE;
+        return;
     }
 
     double upper = gtk_adjustment_get_upper(scroll_adjustment);
@@ -300,51 +1230,131 @@ static gboolean auto_scroll_tick(G_GNUC_UNUSED gpointer user_data) {
     double max_scroll = upper - page_size;
 
     if (max_scroll <= 0) {
-        return G_SOURCE_CONTINUE;
+        return;
     }
 
-    // Incrementar posición de scroll por current_scroll_speed pixels por frame
-    // La velocidad en pixels/segundo se mantiene constante independientemente de los FPS
-    current_scroll_position += current_scroll_speed;
-
+    current_scroll_position += delta;
     if (current_scroll_position >= max_scroll) {
         current_scroll_position = 0.0;
+        if (pending_order) apply_pending_order();
     }
 
     gtk_adjustment_set_value(scroll_adjustment, current_scroll_position);
 
+    if (g_get_monotonic_time() - last_schedule_us >= DECODE_SCHEDULE_INTERVAL_US) {
+        schedule_decodes();
+    }
+}
+
+// --fps N: timer fijo, current_scroll_speed píxeles por tick
+// La velocidad en pixels/segundo se mantiene constante independientemente de los FPS
+static gboolean auto_scroll_tick(G_GNUC_UNUSED gpointer user_data) {
+    scroll_step(current_scroll_speed);
+    return G_SOURCE_CONTINUE;
+}
+
+// --fps auto: el frame clock marca el ritmo y se avanza uno de cada pacing_get_divisor()
+// frames, por el frame time (acotado, para no saltar tras un bloqueo). Así cada paso cae
+// en el mismo vblank relativo, sin la deriva de un timer redondeado a milisegundos
+static gboolean adaptive_scroll_frame(G_GNUC_UNUSED GtkWidget *widget, GdkFrameClock *clock,
+                                      G_GNUC_UNUSED gpointer user_data) {
+    if (++frames_since_tick < pacing_get_divisor()) return G_SOURCE_CONTINUE;
+    frames_since_tick = 0;
+
+    gint64 frame_time = gdk_frame_clock_get_frame_time(clock);
+    double elapsed = last_tick_us > 0 ? (frame_time - last_tick_us) / (double)G_USEC_PER_SEC
+                                      : 1.0 / pacing_get_fps();
+    last_tick_us = frame_time;
+
+    gint64 tick_start = g_get_monotonic_time();
+    scroll_step(current_speed_per_second * CLAMP(elapsed, 0.0, 4.0 / pacing_get_fps()));
+    pacing_add_work(g_get_monotonic_time() - tick_start);
+
+    // La carga cambió el escalón: el divisor nuevo vale desde el siguiente frame
+    if (pacing_tick()) apply_adaptive_rate();
     return G_SOURCE_CONTINUE;
 }
 
-// Función para inicializar valores por defecto de scroll
+// Intervalo y velocidad por tick a partir de lo que elige pacing (modo adaptativo)
+static void apply_adaptive_rate(void) {
+    current_target_fps = (int)(pacing_get_fps() + 0.5);
+    current_scroll_interval = pacing_get_interval_ms();
+    current_scroll_speed = current_speed_per_second / pacing_get_fps();
+    frame_stats_set_tick_interval((gint64)(G_USEC_PER_SEC / pacing_get_fps()));
+}
+
+static void configure_adaptive_rate(void) {
+    pacing_configure(viewport_refresh_hz, current_speed_per_second, viewport_scale, 0);
+    apply_adaptive_rate();
+}
+
+static void stop_scroll_timer(void) {
+    if (scroll_timer_id == 0) return;
+    if (scroll_tick_widget) {
+        gtk_widget_remove_tick_callback(scroll_tick_widget, scroll_timer_id);
+        g_clear_object(&scroll_tick_widget);
+    } else {
+        g_source_remove(scroll_timer_id);
+    }
+    scroll_timer_id = 0;
+}
+
+// Arranca el scroll con el ritmo actual (si el scroll está activo): timer con --fps N,
+// frame clock del widget que se desplaza con --fps auto
+static void start_scroll_timer(void) {
+    stop_scroll_timer();
+    if (!auto_scroll_enabled || !scroll_adjustment) return;
+
+    GtkWidget *scroller = scroll_strip ? scroll_strip : main_scroll_window;
+    if (adaptive_fps && scroller) {
+        last_tick_us = 0;
+        frames_since_tick = 0;
+        scroll_tick_widget = g_object_ref(scroller);
+        scroll_timer_id = gtk_widget_add_tick_callback(scroller, adaptive_scroll_frame, NULL, NULL);
+    } else {
+        scroll_timer_id = g_timeout_add(current_scroll_interval, auto_scroll_tick, NULL);
+    }
+}
+
 static void init_scroll_config(void) {
     current_target_fps = TARGET_FPS;
     current_scroll_interval = SCROLL_INTERVAL;
     current_speed_per_second = SCROLL_SPEED_PER_SECOND;
     current_scroll_speed = current_speed_per_second / current_target_fps;
+    frame_stats_set_tick_interval(G_USEC_PER_SEC / current_target_fps);
 }
 
 // Función para configurar FPS sin afectar la velocidad de scroll
 static void set_target_fps(int fps) {
+    if (fps == ADAPTIVE_FPS) {
+        adaptive_fps = TRUE;
+        pacing_set_enabled(TRUE);
+        configure_adaptive_rate();
+        start_scroll_timer();
+        g_print("🎯 FPS adaptativos: %.1f (1/%d de %.0f Hz) para %.1f px/s\n",
+                pacing_get_fps(), pacing_get_divisor(), pacing_get_refresh_hz(), current_speed_per_second);
+        return;
+    }
+
     if (fps < 30 || fps > 500) {
         g_print("⚠️  FPS fuera de rango válido (30-500), usando %d\n", current_target_fps);
         return;
     }
     
     // Detener el timer actual si existe
-    if (scroll_timer_id > 0) {
-        g_source_remove(scroll_timer_id);
-        scroll_timer_id = 0;
-    }
+    stop_scroll_timer();
     
     // Actualizar configuración
+    adaptive_fps = FALSE;
+    pacing_set_enabled(FALSE);
     current_target_fps = fps;
     current_scroll_interval = 1000 / fps;  // ms por frame
     current_scroll_speed = current_speed_per_second / fps;  // pixels por frame usando velocidad actual
+    frame_stats_set_tick_interval(G_USEC_PER_SEC / fps);
     
     // Reiniciar el timer con la nueva configuración
     if (auto_scroll_enabled && scroll_adjustment) {
-        scroll_timer_id = g_timeout_add(current_scroll_interval, auto_scroll_tick, NULL);
+        start_scroll_timer();
         g_print("🎯 FPS configurados a %d (intervalo: %dms, velocidad: %.3f px/frame)\n", 
                 current_target_fps, current_scroll_interval, current_scroll_speed);
         g_print("📈 Velocidad constante: %.1f pixels/segundo\n", current_speed_per_second);
@@ -359,18 +1369,18 @@ static void set_scroll_speed(double speed_per_second) {
     }
     
     // Detener el timer actual si existe
-    if (scroll_timer_id > 0) {
-        g_source_remove(scroll_timer_id);
-        scroll_timer_id = 0;
-    }
+    stop_scroll_timer();
     
     // Actualizar configuración de velocidad
     current_speed_per_second = speed_per_second;
     current_scroll_speed = current_speed_per_second / current_target_fps;  // Recalcular px/frame
+    if (adaptive_fps) {
+        configure_adaptive_rate();   // Más velocidad puede pedir más ticks, y al revés
+    }
     
     // Reiniciar el timer con la nueva configuración
     if (auto_scroll_enabled && scroll_adjustment) {
-        scroll_timer_id = g_timeout_add(current_scroll_interval, auto_scroll_tick, NULL);
+        start_scroll_timer();
         g_print("🚀 Velocidad configurada: %.1f px/s (%.3f px/frame a %d FPS)\n", 
                 current_speed_per_second, current_scroll_speed, current_target_fps);
     }
@@ -428,17 +1438,541 @@ static void setup_infinite_scroll(GtkWidget *scroll_window) {
     gtk_widget_add_controller(scroll_window, GTK_EVENT_CONTROLLER(drag_gesture));
     g_signal_connect(drag_gesture, "drag-begin", G_CALLBACK(block_drag_events), NULL);
 
-    if (scroll_timer_id > 0) {
-        g_source_remove(scroll_timer_id);
-    }
-
-    scroll_timer_id = g_timeout_add(current_scroll_interval, auto_scroll_tick, NULL);
+    start_scroll_timer();
 
     g_print("🚀 Wallpaper auto-scroll iniciado:\n");
     g_print("   FPS: %d | Intervalo: %dms | Velocidad: %.1f px/s\n", 
             current_target_fps, current_scroll_interval, current_speed_per_second);
 }
 
+// Modo bajo consumo: el strip hace de "scrolled window" con su propio adjustment,
+// así que el tick, la pausa y los cambios de FPS/velocidad funcionan igual
+static void setup_strip_scroll(GtkWidget *strip) {
+    scroll_adjustment = scroll_strip_get_adjustment(WALLPIN_SCROLL_STRIP(strip));
+
+    start_scroll_timer();
+
+    g_print("🔋 Modo bajo consumo: columnas pre-compuestas, solo el tile bajo el puntero se dibuja en vivo\n");
+    g_print("   FPS: %d | Intervalo: %dms | Velocidad: %.1f px/s\n",
+            current_target_fps, current_scroll_interval, current_speed_per_second);
+}
+
+// === Geometría del monitor ===
+
+static double monitor_scale(GdkMonitor *monitor) {
+#if GTK_CHECK_VERSION(4, 14, 0)
+    double scale = gdk_monitor_get_scale(monitor);   // Escala fraccional (1.25, 1.5...)
+#else
+    double scale = gdk_monitor_get_scale_factor(monitor);
+#endif
+    return scale > 0.0 ? scale : 1.0;
+}
+
+static void read_monitor_metrics(GdkMonitor *monitor) {
+    GdkRectangle geometry;
+    gdk_monitor_get_geometry(monitor, &geometry);
+
+    viewport_width = geometry.width > 0 ? geometry.width : DEFAULT_MONITOR_WIDTH;
+    viewport_height = geometry.height > 0 ? geometry.height : DEFAULT_MONITOR_HEIGHT;
+    viewport_scale = monitor_scale(monitor);
+    viewport_refresh_hz = gdk_monitor_get_refresh_rate(monitor) / 1000.0;   // Viene en mHz
+
+    g_print("🖥️  Monitor %s: %dx%d lógicos, escala %.2f, %.0f Hz\n",
+            gdk_monitor_get_connector(monitor) ? gdk_monitor_get_connector(monitor) : "(desconocido)",
+            viewport_width, viewport_height, viewport_scale, viewport_refresh_hz);
+}
+
+// --span: un solo lienzo del tamaño del escritorio (la caja que envuelve todos los
+// monitores). El layout se calcula una vez sobre ese ancho y a la escala más alta, para
+// que ningún monitor reciba tiles borrosos; cada franja se coloca en su trozo
+static void read_span_metrics(void) {
+    GPtrArray *strips = g_ptr_array_new();
+    g_ptr_array_add(strips, scroll_strip);
+    g_ptr_array_extend(strips, span_strips, NULL, NULL);
+
+    int left = G_MAXINT, top = G_MAXINT, right = G_MININT, bottom = G_MININT;
+    double scale = 1.0;
+    for (guint i = 0; i < strips->len; i++) {
+        GdkMonitor *monitor = g_object_get_data(G_OBJECT(g_ptr_array_index(strips, i)), "span-monitor");
+        GdkRectangle geometry;
+        gdk_monitor_get_geometry(monitor, &geometry);
+        left = MIN(left, geometry.x);
+        top = MIN(top, geometry.y);
+        right = MAX(right, geometry.x + geometry.width);
+        bottom = MAX(bottom, geometry.y + geometry.height);
+        scale = MAX(scale, monitor_scale(monitor));
+    }
+    if (right <= left || bottom <= top) {
+        g_ptr_array_unref(strips);
+        return;
+    }
+
+    viewport_width = right - left;
+    viewport_height = bottom - top;
+    viewport_scale = scale;
+    for (guint i = 0; i < strips->len; i++) {
+        ScrollStrip *strip = WALLPIN_SCROLL_STRIP(g_ptr_array_index(strips, i));
+        GdkRectangle geometry;
+        gdk_monitor_get_geometry(g_object_get_data(G_OBJECT(strip), "span-monitor"), &geometry);
+        scroll_strip_set_canvas(strip, viewport_width, geometry.x - left, geometry.y - top);
+    }
+
+    g_print("🖥️  Lienzo continuo: %u monitores, %dx%d lógicos, escala %.2f\n",
+            strips->len, viewport_width, viewport_height, viewport_scale);
+    g_ptr_array_unref(strips);
+}
+
+// Cambio de resolución o de escala: los tiles se vuelven a decodificar al nuevo
+// tamaño, pero no hace falta reescanear ni volver a leer dimensiones
+static gboolean apply_viewport_change(G_GNUC_UNUSED gpointer user_data) {
+    viewport_idle_id = 0;
+    if (!grid_container || !layout.images) return G_SOURCE_REMOVE;
+
+    masonry_layout_set_viewport(&layout, viewport_width, viewport_scale);
+    if (baked_tiles) decode_scheduler_set_bake_scale(viewport_scale);
+    if (adaptive_fps) {
+        // Otro refresco u otra escala cambian el divisor
+        configure_adaptive_rate();
+        start_scroll_timer();
+    }
+    if (current_columns) {
+        gtk_box_remove(grid_container, current_columns);
+        current_columns = NULL;
+    }
+    if (tile_widgets) g_hash_table_remove_all(tile_widgets);
+    forget_tiles();
+    decode_scheduler_cancel_all();
+
+    calculate_layout();
+    render_layout(grid_container);
+    return G_SOURCE_REMOVE;
+}
+
+static void on_monitor_metrics_changed(GdkMonitor *monitor, G_GNUC_UNUSED GParamSpec *pspec,
+                                       G_GNUC_UNUSED gpointer user_data) {
+    if (span_strips) {
+        read_span_metrics();   // Cualquier monitor mueve el lienzo entero
+    } else {
+        read_monitor_metrics(monitor);
+    }
+    // Geometría y escala suelen cambiar juntas: se agrupan en un solo relayout
+    if (viewport_idle_id == 0) {
+        viewport_idle_id = g_idle_add(apply_viewport_change, NULL);
+    }
+}
+
+// === Operaciones del canal de control (cada una por el camino más barato) ===
+
+static void control_set_paused(gboolean paused) {
+    if (paused == !auto_scroll_enabled) return;
+
+    auto_scroll_enabled = !paused;
+    if (paused) {
+        // Sin timer no hay wakeups mientras está en pausa
+        stop_scroll_timer();
+        g_print("⏸️  Auto-scroll en pausa\n");
+    } else if (scroll_adjustment && scroll_timer_id == 0) {
+        current_scroll_position = gtk_adjustment_get_value(scroll_adjustment);
+        start_scroll_timer();
+        g_print("▶️  Auto-scroll reanudado\n");
+    }
+}
+
+static void control_reorder(const char *order) {
+    GList *paths = current_layout_paths();
+
+    if (strcmp(order, "sorted") == 0) {
+        paths = g_list_sort(paths, (GCompareFunc)g_strcmp0);
+    } else if (strcmp(order, "reverse") == 0) {
+        paths = g_list_reverse(paths);
+    } else if (strcmp(order, "shuffle") == 0) {
+        shuffle_images(&paths);
+    }
+
+    relayout_with_order(paths);
+    g_list_free(paths);
+}
+
+static void control_set_color_mode(int mode, int tolerance) {
+    if (mode > 0) current_color_mode = (ColorMode)mode;
+    if (tolerance > 0) current_color_tolerance = tolerance;
+    apply_color_order(current_color_mode, current_color_tolerance);
+}
+
+static void control_reload(const char *directory) {
+    if (!grid_container) return;
+
+    // Varias carpetas separadas por ':' (como PATH)
+    if (directory && directory[0]) {
+        g_strfreev(current_asset_roots);
+        current_asset_roots = g_strsplit(directory, G_SEARCHPATH_SEPARATOR_S, -1);
+    }
+
+    // Solo una recarga completa vuelve a leer del disco
+    if (current_columns) {
+        gtk_box_remove(grid_container, current_columns);
+        current_columns = NULL;
+    }
+    if (tile_widgets) g_hash_table_remove_all(tile_widgets);
+    forget_tiles();
+    decode_scheduler_cancel_all();
+    cache_clear(color_cache, sizeof(Color));
+    cache_clear(phash_cache, sizeof(PHash));
+
+    load_collection();
+
+    current_scroll_position = 0.0;
+    if (scroll_adjustment) gtk_adjustment_set_value(scroll_adjustment, 0.0);
+}
+
+// === Cambio de colección en caliente ===
+// La colección nueva se escanea, se ingiere y se coloca en un layout aparte mientras la
+// actual sigue en pantalla y avanzando; se decodifica lo que se verá nada más cambiar y
+// entonces se sustituye de una vez (con fundido opcional). La anterior se suelta después,
+// por lotes y con prioridad baja, así que en ningún momento queda la pantalla vacía
+
+typedef struct {
+    char **roots;
+    MasonryLayout layout;
+    Scanner *scanner;
+    CollectionLoad load;          // Ingesta en los hilos hacia layout; con --sample, su propia reserva
+    gboolean crossfade;
+    GHashTable *pending;          // Rutas de la primera pantalla aún sin decodificar
+    GHashTable *textures;         // path -> GdkTexture ya decodificada para la primera pantalla
+    guint warmup_timeout_id;
+    guint swap_id;
+    gint64 started_us;
+} StagedCollection;
+
+typedef struct {
+    MasonryLayout layout;
+    GHashTable *tiles;            // path -> widget (propiedad), se sueltan por lotes
+    GtkWidget *columns;           // Contenedor de columnas ya oculto
+} RetiredCollection;
+
+static StagedCollection *staged = NULL;
+static RetiredCollection *retired = NULL;
+static guint retire_id = 0;
+
+static void free_staged_collection(void) {
+    if (!staged) return;
+
+    scanner_stop(staged->scanner);
+    decode_scheduler_cancel_ingest(&staged->load);
+    if (staged->warmup_timeout_id > 0) g_source_remove(staged->warmup_timeout_id);
+    if (staged->swap_id > 0) g_source_remove(staged->swap_id);
+
+    GHashTableIter iter;
+    gpointer path;
+    g_hash_table_iter_init(&iter, staged->pending);
+    while (g_hash_table_iter_next(&iter, &path, NULL)) {
+        decode_scheduler_cancel(path);
+    }
+    g_hash_table_destroy(staged->pending);
+    g_clear_pointer(&staged->textures, g_hash_table_destroy);
+    g_clear_pointer(&staged->load.dedup_index, phash_index_free);
+    g_clear_pointer(&staged->load.pool, sample_pool_free);
+    g_clear_pointer(&staged->load.sample_paths, g_ptr_array_unref);
+    masonry_layout_free(&staged->layout);
+    g_strfreev(staged->roots);
+    g_clear_pointer(&staged, g_free);
+}
+
+// Entradas de color y hash de imágenes que ya no están en el layout
+static void cache_prune(GHashTable *cache, gsize value_size) {
+    if (!cache) return;
+    GHashTableIter iter;
+    gpointer key;
+    g_hash_table_iter_init(&iter, cache);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+        if (g_hash_table_contains(layout.loaded_paths, key)) continue;
+        ALLOC_STATS_SUB(ALLOC_COLOR, strlen(key) + 1 + value_size);
+        g_hash_table_iter_remove(&iter);
+    }
+}
+
+// Suelta SWAP_RELEASE_BATCH tiles de la colección sustituida por iteración; al acabar,
+// sus columnas, su layout y lo que queda en las cachés
+static gboolean release_retired_batch(G_GNUC_UNUSED gpointer user_data) {
+    if (retired->tiles) {
+        GHashTableIter iter;
+        gpointer tile;
+        int released = 0;
+        g_hash_table_iter_init(&iter, retired->tiles);
+        while (released < SWAP_RELEASE_BATCH && g_hash_table_iter_next(&iter, NULL, &tile)) {
+            GtkWidget *parent = gtk_widget_get_parent(tile);
+            if (parent) gtk_box_remove(GTK_BOX(parent), tile);
+            g_hash_table_iter_remove(&iter);
+            released++;
+        }
+        if (g_hash_table_size(retired->tiles) > 0) return G_SOURCE_CONTINUE;
+        g_clear_pointer(&retired->tiles, g_hash_table_destroy);
+    }
+
+    GtkWidget *parent = retired->columns ? gtk_widget_get_parent(retired->columns) : NULL;
+    if (parent) gtk_box_remove(GTK_BOX(parent), retired->columns);
+    masonry_layout_free(&retired->layout);
+    g_clear_pointer(&retired, g_free);
+    retire_id = 0;
+
+    cache_prune(color_cache, sizeof(Color));
+    cache_prune(phash_cache, sizeof(PHash));
+    return G_SOURCE_REMOVE;
+}
+
+// Otro cambio antes de terminar de soltar el anterior: se acaba de golpe
+static void flush_retired_collection(void) {
+    if (retire_id > 0) {
+        g_source_remove(retire_id);
+        retire_id = 0;
+    }
+    while (retired) release_retired_batch(NULL);
+}
+
+static gboolean drop_swap_textures(G_GNUC_UNUSED gpointer user_data) {
+    swap_textures_id = 0;
+    g_clear_pointer(&swap_textures, g_hash_table_destroy);
+    return G_SOURCE_REMOVE;
+}
+
+// Envuelve el contenido de una ventana para poder fundir encima, al cambiar de
+// colección, una imagen congelada de lo que se veía
+static GtkWidget *wrap_for_crossfade(GtkWidget *content) {
+    GtkWidget *overlay = gtk_overlay_new();
+    gtk_overlay_set_child(GTK_OVERLAY(overlay), content);
+
+    GtkWidget *fade = gtk_picture_new();
+    gtk_picture_set_can_shrink(GTK_PICTURE(fade), TRUE);
+    gtk_picture_set_content_fit(GTK_PICTURE(fade), GTK_CONTENT_FIT_FILL);
+    gtk_widget_set_can_target(fade, FALSE);   // El hover sigue llegando a los tiles de debajo
+    gtk_widget_set_visible(fade, FALSE);
+    gtk_overlay_add_overlay(GTK_OVERLAY(overlay), fade);
+
+    if (!swap_fades) swap_fades = g_ptr_array_new();
+    g_ptr_array_add(swap_fades, fade);
+    return overlay;
+}
+
+static gboolean crossfade_tick(GtkWidget *fade, GdkFrameClock *clock, G_GNUC_UNUSED gpointer user_data) {
+    double progress = (gdk_frame_clock_get_frame_time(clock) - crossfade_started_us) / (SWAP_CROSSFADE_MS * 1000.0);
+    if (progress >= 1.0) {
+        gtk_widget_set_visible(fade, FALSE);
+        gtk_picture_set_paintable(GTK_PICTURE(fade), NULL);
+        return G_SOURCE_REMOVE;
+    }
+    gtk_widget_set_opacity(fade, 1.0 - CLAMP(progress, 0.0, 1.0));
+    return G_SOURCE_CONTINUE;
+}
+
+// Congela lo que se ve ahora en cada ventana y lo desvanece sobre lo que venga debajo
+static void begin_crossfade(void) {
+    crossfade_started_us = g_get_monotonic_time();
+    for (guint i = 0; swap_fades && i < swap_fades->len; i++) {
+        GtkWidget *fade = g_ptr_array_index(swap_fades, i);
+        GtkWidget *content = gtk_overlay_get_child(GTK_OVERLAY(gtk_widget_get_parent(fade)));
+        GdkPaintable *live = gtk_widget_paintable_new(content);
+        GdkPaintable *frozen = gdk_paintable_get_current_image(live);
+        gtk_picture_set_paintable(GTK_PICTURE(fade), frozen);
+        g_object_unref(frozen);
+        g_object_unref(live);
+
+        gtk_widget_set_opacity(fade, 1.0);
+        gtk_widget_set_visible(fade, TRUE);
+        gtk_widget_add_tick_callback(fade, crossfade_tick, NULL, NULL);
+    }
+}
+
+// El cambio en sí: todo en una iteración del main loop, así que ningún frame ve un
+// estado intermedio
+static gboolean run_swap(G_GNUC_UNUSED gpointer user_data) {
+    StagedCollection *next = staged;
+    next->swap_id = 0;
+    if (next->warmup_timeout_id > 0) {
+        g_source_remove(next->warmup_timeout_id);
+        next->warmup_timeout_id = 0;
+    }
+
+    flush_retired_collection();
+    if (next->crossfade) begin_crossfade();   // Antes de tocar nada: es la foto de lo saliente
+
+    // Lo que aún trabajaba para la colección actual
+    scanner_stop(active_scanner);
+    active_scanner = NULL;
+    if (scan_relayout_id > 0) {
+        g_source_remove(scan_relayout_id);
+        scan_relayout_id = 0;
+    }
+    reset_scan_load();
+    cancel_color_order();
+    clear_pending_order();
+    decode_scheduler_cancel_all();
+
+    // La colección actual pasa a retirada, oculta pero aún sin liberar
+    retired = g_new0(RetiredCollection, 1);
+    retired->layout = layout;
+    retired->tiles = tile_widgets;
+    retired->columns = current_columns;
+    if (current_columns) gtk_widget_set_visible(current_columns, FALSE);
+    tile_widgets = NULL;
+    current_columns = NULL;
+    forget_tiles();
+
+    layout = next->layout;
+    memset(&next->layout, 0, sizeof(next->layout));
+    g_strfreev(current_asset_roots);
+    current_asset_roots = g_steal_pointer(&next->roots);
+    reset_sample_window(g_steal_pointer(&next->load.pool));
+    if (swap_textures_id > 0) g_source_remove(swap_textures_id);
+    g_clear_pointer(&swap_textures, g_hash_table_destroy);
+    swap_textures = g_steal_pointer(&next->textures);
+    swap_textures_id = g_timeout_add_seconds(SWAP_TEXTURES_KEEP_S, drop_swap_textures, NULL);
+
+    // El monitor pudo cambiar durante la preparación
+    if (layout.grid_width != viewport_width || layout.scale != viewport_scale) {
+        masonry_layout_set_viewport(&layout, viewport_width, viewport_scale);
+        calculate_layout();
+    }
+    current_scroll_position = 0.0;
+    if (scroll_adjustment) gtk_adjustment_set_value(scroll_adjustment, 0.0);
+    render_layout(grid_container);
+
+    g_print("🔁 Colección cambiada en caliente: %d imágenes (%.1fs de preparación)\n",
+            g_list_length(layout.images), (g_get_monotonic_time() - next->started_us) / (double)G_USEC_PER_SEC);
+    free_staged_collection();
+
+    retire_id = g_idle_add_full(G_PRIORITY_LOW, release_retired_batch, NULL, NULL);
+    start_sample_rotation();
+    apply_color_order(current_color_mode, current_color_tolerance);
+    return G_SOURCE_REMOVE;
+}
+
+static void schedule_swap(void) {
+    if (staged->swap_id == 0) staged->swap_id = g_idle_add(run_swap, NULL);
+}
+
+static gboolean on_warmup_timeout(G_GNUC_UNUSED gpointer user_data) {
+    staged->warmup_timeout_id = 0;
+    g_print("⏱️  La primera pantalla de la colección nueva no terminó a tiempo: se cambia igualmente\n");
+    schedule_swap();
+    return G_SOURCE_REMOVE;
+}
+
+// La primera pantalla de la colección en preparación no se cancela aunque la actual
+// tenga esa misma imagen lejos del scroll
+static gboolean staged_wants(const char *path) {
+    return staged && g_hash_table_contains(staged->pending, path);
+}
+
+// Resultado del planificador para un tile de la colección en preparación. El cambio se
+// programa aparte: aquí aún se está dentro de la entrega del planificador
+static void staged_offer_decoded(const char *path, GdkTexture *texture) {
+    if (!staged || !g_hash_table_remove(staged->pending, path)) return;
+
+    if (texture) g_hash_table_insert(staged->textures, g_strdup(path), g_object_ref(texture));
+    if (g_hash_table_size(staged->pending) == 0) schedule_swap();
+}
+
+// Decodifica lo que se verá nada más cambiar (scroll en 0), con el mismo tamaño que
+// pedirá el render, para no enseñar ni un tile vacío
+static void warm_staged_collection(void) {
+    for (GList *l = staged->layout.images; l != NULL; l = l->next) {
+        ImageInfo *info = l->data;
+        if (TILE_TOP_OFFSET + info->y > viewport_height) continue;
+
+        g_hash_table_add(staged->pending, g_strdup(info->path));
+        decode_scheduler_submit(info->path,
+                                masonry_layout_device_size(&staged->layout, tile_widget_size(info->target_width)),
+                                masonry_layout_device_size(&staged->layout, tile_widget_size(info->target_height)),
+                                0.0);
+    }
+
+    if (g_hash_table_size(staged->pending) == 0) {
+        schedule_swap();
+        return;
+    }
+    staged->warmup_timeout_id = g_timeout_add(SWAP_WARMUP_TIMEOUT_MS, on_warmup_timeout, NULL);
+}
+
+// Como el escaneo normal: la ingesta va a los hilos y la colección actual sigue
+// avanzando sin esperar a ningún lote
+static void on_staged_batch(GPtrArray *paths, G_GNUC_UNUSED gpointer user_data) {
+    if (!staged) return;
+    submit_scan_batch(&staged->load, paths);
+}
+
+static void on_staged_done(guint total, G_GNUC_UNUSED gpointer user_data) {
+    if (!staged) return;
+
+    g_print("🔁 Colección nueva escaneada: %u imágenes (%.1fs)\n", total,
+            (g_get_monotonic_time() - staged->started_us) / (double)G_USEC_PER_SEC);
+    finish_scanning(&staged->load, total);
+}
+
+// Colección nueva escaneada e ingerida entera: se coloca y se precalienta
+static void finish_staged(void) {
+    if (staged->load.duplicates > 0) {
+        g_print("♻️  %d duplicados omitidos\n", staged->load.duplicates);
+    }
+    g_clear_pointer(&staged->load.dedup_index, phash_index_free);
+
+    if (!staged->layout.images) {
+        g_print("⚠️  La colección nueva no tiene imágenes: se mantiene la actual\n");
+        free_staged_collection();
+        return;
+    }
+
+    // Con la geometría actual del monitor, aunque haya cambiado durante el escaneo
+    masonry_layout_set_viewport(&staged->layout, viewport_width, viewport_scale);
+    masonry_layout_calculate(&staged->layout);
+    warm_staged_collection();
+}
+
+// Como reload, pero la colección actual sigue en pantalla hasta que la nueva está lista
+static void control_swap(const char *directory, gboolean crossfade) {
+    if (!grid_container) return;
+
+    // Un cambio nuevo sustituye al que se estuviera preparando
+    free_staged_collection();
+
+    staged = g_new0(StagedCollection, 1);
+    staged->roots = directory && directory[0]
+        ? g_strsplit(directory, G_SEARCHPATH_SEPARATOR_S, -1)
+        : g_strdupv(current_asset_roots);
+    staged->crossfade = crossfade;
+    staged->pending = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    staged->textures = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_object_unref);
+    staged->load.layout = &staged->layout;
+    staged->load.on_loaded = finish_staged;
+    staged->load.pool = sample_size > 0 ? sample_pool_new(sample_seed) : NULL;
+    staged->load.dedup_index = dedup_enabled ? phash_index_new(PHASH_DUPLICATE_DISTANCE) : NULL;
+    staged->started_us = g_get_monotonic_time();
+    masonry_layout_init(&staged->layout, viewport_width, STANDARD_WIDTH, IMAGE_SPACING);
+    masonry_layout_set_viewport(&staged->layout, viewport_width, viewport_scale);
+
+    g_print("🔁 Preparando colección nueva en segundo plano:\n");
+    for (char **root = staged->roots; root && *root; root++) {
+        g_print("   %s\n", *root);
+    }
+
+    // Sin carpetas el scanner termina dentro de scanner_start y on_staged_done ya lo descartó
+    Scanner *scanner = scanner_start((const char * const *)staged->roots, on_staged_batch, on_staged_done, NULL);
+    if (staged) {
+        staged->scanner = scanner;
+    } else {
+        scanner_stop(scanner);
+    }
+}
+
+static const WallpinControlOps control_ops = {
+    set_scroll_speed,
+    set_target_fps,
+    control_set_paused,
+    control_reorder,
+    control_set_color_mode,
+    control_reload,
+    control_swap,
+};
+
 // Estructura para pasar datos a la función activate
 typedef struct {
     const char *monitor_name;
@@ -446,8 +1980,79 @@ typedef struct {
     double target_speed;
     ColorMode color_mode;
     int color_tolerance;
+    gboolean stats;          // Imprimir resúmenes periódicos de frames
+    const char *stats_file;  // Archivo de estadísticas legible por hyprwall-multi.sh
+    gboolean keep_duplicates; // No omitir imágenes repetidas
+    gboolean low_power;       // Strip pre-compuesto en vez de un widget por imagen
+    GPtrArray *asset_dirs;    // Carpetas raíz (--dir); vacío = ASSETS_DIR
+    gboolean adaptive_fps;    // --fps auto
+    Shard shard;              // --shard i/n
+    gboolean baked_tiles;     // Esquinas y sombra horneadas en cada tile
+    gboolean span;            // Un solo lienzo repartido entre todos los monitores
+    int sample_size;          // --sample K: solo K imágenes activas (0 = todas)
+    gint64 sample_seed;       // --sample-seed; -1 = aleatoria
 } AppData;
 
+// Primer frame pintado: el span va desde el inicio del proceso
+static void on_first_paint(GdkFrameClock *clock, G_GNUC_UNUSED gpointer user_data) {
+    g_signal_handlers_disconnect_by_func(clock, on_first_paint, NULL);
+    trace_record("first_frame", process_started_us, NULL);
+}
+
+static void on_trace_window_map(GtkWidget *window, G_GNUC_UNUSED gpointer user_data) {
+    g_signal_handlers_disconnect_by_func(window, on_trace_window_map, NULL);
+    GdkFrameClock *clock = gtk_widget_get_frame_clock(window);
+    if (clock) g_signal_connect(clock, "after-paint", G_CALLBACK(on_first_paint), NULL);
+}
+
+static void watch_monitor_metrics(GdkMonitor *monitor) {
+    g_signal_connect(monitor, "notify::geometry", G_CALLBACK(on_monitor_metrics_changed), NULL);
+    g_signal_connect(monitor, "notify::scale-factor", G_CALLBACK(on_monitor_metrics_changed), NULL);
+#if GTK_CHECK_VERSION(4, 14, 0)
+    g_signal_connect(monitor, "notify::scale", G_CALLBACK(on_monitor_metrics_changed), NULL);
+#endif
+}
+
+// --span: una ventana más por monitor, sin estado propio. Su franja comparte layout y
+// adjustment con la principal, así que el scroll, la pausa y los relayouts son comunes
+static void create_span_window(GtkApplication *app, GdkMonitor *monitor) {
+    const char *connector = gdk_monitor_get_connector(monitor);
+    GtkWidget *window = gtk_application_window_new(app);
+    char *title = g_strdup_printf("WallPin - Wallpaper Mode (%s)", connector);
+    gtk_window_set_title(GTK_WINDOW(window), title);
+    g_free(title);
+
+    GdkRectangle geometry;
+    gdk_monitor_get_geometry(monitor, &geometry);
+    gtk_window_set_default_size(GTK_WINDOW(window), geometry.width, geometry.height);
+    layer_shell_init_window_for_monitor(GTK_WINDOW(window), connector);
+    layer_shell_configure_wallpaper(GTK_WINDOW(window));
+
+    GtkWidget *strip = scroll_strip_new(request_strip_texture);
+    scroll_strip_follow(WALLPIN_SCROLL_STRIP(strip), WALLPIN_SCROLL_STRIP(scroll_strip));
+    g_object_set_data_full(G_OBJECT(strip), "span-monitor", g_object_ref(monitor), g_object_unref);
+    gtk_window_set_child(GTK_WINDOW(window), wrap_for_crossfade(strip));
+    g_ptr_array_add(span_strips, g_object_ref(strip));
+    watch_monitor_metrics(monitor);
+
+    gtk_widget_add_css_class(window, "dark-window");
+    gtk_window_present(GTK_WINDOW(window));
+}
+
+// El primer monitor es el de la ventana principal; el resto recibe una ventana cada uno
+static void setup_span(GtkApplication *app, GdkMonitor *primary) {
+    span_strips = g_ptr_array_new_with_free_func(g_object_unref);
+    g_object_set_data_full(G_OBJECT(scroll_strip), "span-monitor", g_object_ref(primary), g_object_unref);
+
+    GListModel *monitors = gdk_display_get_monitors(gdk_monitor_get_display(primary));
+    for (guint i = 0; i < g_list_model_get_n_items(monitors); i++) {
+        GdkMonitor *monitor = g_list_model_get_item(monitors, i);
+        if (monitor != primary) create_span_window(app, monitor);
+        g_object_unref(monitor);
+    }
+    read_span_metrics();
+}
+
 static void activate(GtkApplication *app, gpointer user_data) {
     AppData *data = (AppData *)user_data;
     GtkWidget *window;
@@ -456,54 +2061,103 @@ static void activate(GtkApplication *app, gpointer user_data) {
 
     window = gtk_application_window_new(app);
     
-    if (data && data->monitor_name) {
-        gtk_window_set_title(GTK_WINDOW(window), g_strdup_printf("WallPin - Wallpaper Mode (%s)", data->monitor_name));
+    if (data && data->span) {
+        gtk_window_set_title(GTK_WINDOW(window), "WallPin - Wallpaper Mode (span)");
+    } else if (data && data->monitor_name) {
+        char *title = g_strdup_printf("WallPin - Wallpaper Mode (%s)", data->monitor_name);
+        gtk_window_set_title(GTK_WINDOW(window), title);
+        g_free(title);
     } else {
         gtk_window_set_title(GTK_WINDOW(window), "WallPin - Wallpaper Mode");
     }
     
+    // Geometría real del monitor: columnas, ancho de tile y tamaño de decodificación
+    GdkMonitor *monitor = layer_shell_find_monitor(gtk_widget_get_display(window),
+                                                   data ? data->monitor_name : NULL);
+    if (monitor) {
+        read_monitor_metrics(monitor);
+        watch_monitor_metrics(monitor);
+    }
+
     // Establecer tamaño por defecto antes del layer shell
-    gtk_window_set_default_size(GTK_WINDOW(window), 1920, 1080);
+    gtk_window_set_default_size(GTK_WINDOW(window), viewport_width, viewport_height);
 
     // Configurar layer shell para wallpaper en monitor específico
     if (data && data->monitor_name) {
         layer_shell_init_window_for_monitor(GTK_WINDOW(window), data->monitor_name);
+    } else if (data && data->span && monitor) {
+        layer_shell_init_window_for_monitor(GTK_WINDOW(window), gdk_monitor_get_connector(monitor));
     } else {
         layer_shell_init_window(GTK_WINDOW(window));
     }
     layer_shell_configure_wallpaper(GTK_WINDOW(window));
 
+    // Estadísticas de frames (solo si se pidieron con --stats / --stats-file)
+    frame_stats_attach(window);
+    pacing_attach(window);
+    if (trace_enabled) {
+        g_signal_connect(window, "map", G_CALLBACK(on_trace_window_map), NULL);
+    }
+
     apply_css_to_window(window);
 
     // Configurar tema oscuro
     GtkSettings *settings = gtk_settings_get_default();
     g_object_set(settings, "gtk-application-prefer-dark-theme", TRUE, NULL);
 
-    scroll = gtk_scrolled_window_new();
-    
-    // Configurar para wallpaper: mantener sensibilidad para hover pero bloquear scroll
-    gtk_widget_set_can_focus(scroll, FALSE);
-    gtk_widget_set_focusable(scroll, FALSE);
-    // NO deshabilitar sensitive - esto bloquearía el hover
-    
-    gtk_window_set_child(GTK_WINDOW(window), scroll);
-
     grid = create_image_grid();
     
     // Mantener sensibilidad para efectos hover
     gtk_widget_set_sensitive(grid, TRUE);
+
+    if (data && data->low_power) {
+        // El grid no se muestra, pero sigue siendo el contenedor de referencia de las recargas
+        scroll = NULL;
+        g_object_ref_sink(grid);
+        scroll_strip = scroll_strip_new(request_strip_texture);
+        gtk_window_set_child(GTK_WINDOW(window), wrap_for_crossfade(scroll_strip));
+        // Antes de cargar la colección: el layout se calcula sobre el lienzo entero
+        if (data->span && monitor) setup_span(app, monitor);
+    } else {
+        scroll = gtk_scrolled_window_new();
+        
+        // Configurar para wallpaper: mantener sensibilidad para hover pero bloquear scroll
+        gtk_widget_set_can_focus(scroll, FALSE);
+        gtk_widget_set_focusable(scroll, FALSE);
+        // NO deshabilitar sensitive - esto bloquearía el hover
+        
+        gtk_window_set_child(GTK_WINDOW(window), wrap_for_crossfade(scroll));
+        gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scroll), grid);
+    }
     
-    gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scroll), grid);
-    
-    // Cargar imágenes según el modo especificado
-    if (data && data->color_mode != COLOR_MODE_DEFAULT) {
-        load_images_by_color_groups(GTK_BOX(grid), ASSETS_DIR, data->color_mode, data->color_tolerance);
+    grid_container = GTK_BOX(grid);
+    if (data && data->asset_dirs && data->asset_dirs->len > 0) {
+        current_asset_roots = g_new0(char *, data->asset_dirs->len + 1);
+        for (guint i = 0; i < data->asset_dirs->len; i++) {
+            current_asset_roots[i] = g_strdup(g_ptr_array_index(data->asset_dirs, i));
+        }
     } else {
-        load_images_from_directory(GTK_BOX(grid), ASSETS_DIR);
+        current_asset_roots = g_strsplit(ASSETS_DIR, G_SEARCHPATH_SEPARATOR_S, -1);
     }
+    if (data) {
+        current_color_mode = data->color_mode;
+        current_color_tolerance = data->color_tolerance;
+        dedup_enabled = !data->keep_duplicates;
+        current_shard = data->shard;
+        baked_tiles = data->baked_tiles && !data->low_power;   // El strip ya compone los tiles una vez
+        sample_size = data->sample_size;
+        sample_seed = data->sample_seed >= 0 ? (guint32)data->sample_seed : g_random_int();
+    }
+    g_clear_object(&monitor);
+
+    // Escaneo asíncrono: la ventana se presenta ya y las imágenes entran por lotes;
+    // el modo de color se aplica al terminar (ver on_scan_done)
+    load_collection();
 
     // Configurar FPS si se especificó
-    if (data && data->target_fps > 0) {
+    if (data && data->adaptive_fps) {
+        set_target_fps(ADAPTIVE_FPS);
+    } else if (data && data->target_fps > 0) {
         set_target_fps(data->target_fps);
     }
     
@@ -512,9 +2166,15 @@ static void activate(GtkApplication *app, gpointer user_data) {
         set_scroll_speed(data->target_speed);
     }
 
-    setup_infinite_scroll(scroll);
+    if (scroll_strip) {
+        setup_strip_scroll(scroll_strip);
+    } else {
+        setup_infinite_scroll(scroll);
+    }
 
+    TRACE_BEGIN(present_start);
     gtk_window_present(GTK_WINDOW(window));
+    TRACE_END(present_start, "present", NULL);
 
     gtk_widget_add_css_class(window, "dark-window");
     
@@ -522,16 +2182,21 @@ static void activate(GtkApplication *app, gpointer user_data) {
 }
 
 static void cleanup_auto_scroll(void) {
-    if (scroll_timer_id > 0) {
-        g_source_remove(scroll_timer_id);
-        scroll_timer_id = 0;
-    }
+    stop_scroll_timer();
+}
+
+// kill -USR1 <pid>: volcado de memoria por subsistema sin parar el wallpaper
+static gboolean on_alloc_stats_signal(gpointer user_data) {
+    (void)user_data;
+    alloc_stats_print("SIGUSR1");
+    return G_SOURCE_CONTINUE;
 }
 
 int main(int argc, char **argv) {
     GtkApplication *app;
     int status;
-    AppData app_data = {NULL, 0, 0.0, COLOR_MODE_DEFAULT, 50};
+    AppData app_data = {NULL, 0, 0.0, COLOR_MODE_DEFAULT, 50, FALSE, NULL, FALSE, FALSE, g_ptr_array_new(), FALSE, SHARD_NONE, FALSE, FALSE, 0, -1};
+    process_started_us = g_get_monotonic_time();
     
     // Inicializar configuración de scroll
     init_scroll_config();
@@ -555,7 +2220,10 @@ int main(int argc, char **argv) {
                 return 1;
             }
         } else if (strcmp(argv[i], "--fps") == 0 || strcmp(argv[i], "-f") == 0) {
-            if (i + 1 < argc) {
+            if (i + 1 < argc && strcmp(argv[i + 1], "auto") == 0) {
+                app_data.adaptive_fps = TRUE;
+                i++;
+            } else if (i + 1 < argc) {
                 int fps = atoi(argv[i + 1]);
                 if (fps >= 30 && fps <= 500) {
                     app_data.target_fps = fps;
@@ -618,15 +2286,119 @@ int main(int argc, char **argv) {
                 free(gtk_argv);
                 return 1;
             }
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            app_data.stats = TRUE;
+        } else if (strcmp(argv[i], "--stats-file") == 0) {
+            if (i + 1 < argc) {
+                app_data.stats_file = argv[i + 1];
+                i++; // Saltar el siguiente argumento
+            } else {
+                g_print("Error: --stats-file requiere una ruta\n");
+                free(gtk_argv);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--keep-duplicates") == 0) {
+            app_data.keep_duplicates = TRUE;
+        } else if (strcmp(argv[i], "--dir") == 0 || strcmp(argv[i], "-d") == 0) {
+            if (i + 1 < argc) {
+                g_ptr_array_add(app_data.asset_dirs, argv[i + 1]);
+                i++;
+            } else {
+                g_print("Error: --dir requiere una carpeta\n");
+                free(gtk_argv);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--low-power") == 0) {
+            app_data.low_power = TRUE;
+        } else if (strcmp(argv[i], "--baked-tiles") == 0) {
+            app_data.baked_tiles = TRUE;
+        } else if (strcmp(argv[i], "--span") == 0) {
+            app_data.span = TRUE;
+            app_data.low_power = TRUE;   // Cada monitor es una franja con su trozo del lienzo
+        } else if (strcmp(argv[i], "--shard") == 0) {
+            if (i + 1 < argc && shard_parse(argv[i + 1], &app_data.shard)) {
+                i++;
+            } else {
+                g_print("Error: --shard requiere i/n (ej: 0/2), con 0 <= i < n\n");
+                free(gtk_argv);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--sample") == 0) {
+            int size = i + 1 < argc ? atoi(argv[i + 1]) : 0;
+            if (size >= 1) {
+                app_data.sample_size = size;
+                i++;
+            } else {
+                g_print("Error: --sample requiere el número de imágenes activas (>= 1)\n");
+                free(gtk_argv);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--sample-seed") == 0) {
+            if (i + 1 < argc) {
+                app_data.sample_seed = (gint64)g_ascii_strtoull(argv[i + 1], NULL, 10) & G_MAXUINT32;
+                i++;
+            } else {
+                g_print("Error: --sample-seed requiere un número\n");
+                free(gtk_argv);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--max-decode-pixels") == 0) {
+            double megapixels = i + 1 < argc ? g_ascii_strtod(argv[i + 1], NULL) : 0.0;
+            if (megapixels >= 1.0) {
+                decode_budget_configure((gint64)(megapixels * 1e6), 0);
+                i++;
+            } else {
+                g_print("Error: --max-decode-pixels requiere megapíxeles (>= 1)\n");
+                free(gtk_argv);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--decode-memory") == 0) {
+            int megabytes = i + 1 < argc ? atoi(argv[i + 1]) : 0;
+            if (megabytes >= 16) {
+                decode_budget_configure(0, (gint64)megabytes * 1024 * 1024);
+                i++;
+            } else {
+                g_print("Error: --decode-memory requiere MB (>= 16)\n");
+                free(gtk_argv);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--no-shared-thumbnails") == 0) {
+            shared_thumbnails_set_enabled(FALSE);
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            if (i + 1 < argc) {
+                trace_enable(argv[i + 1]);
+                i++;
+            } else {
+                g_print("Error: --trace requiere una ruta\n");
+                free(gtk_argv);
+                return 1;
+            }
         } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
             g_print("WallPin Wallpaper Mode\n");
             g_print("Uso: %s [opciones]\n", argv[0]);
             g_print("Opciones:\n");
             g_print("  --monitor, -m <nombre>      Especificar monitor (ej: HDMI-A-1, eDP-1)\n");
             g_print("  --fps, -f <número>          Configurar FPS (30-500, por defecto: %d)\n", TARGET_FPS);
+            g_print("  --fps auto                  FPS mínimos suaves para la velocidad, divisor del refresco\n");
             g_print("  --speed, -s <número>        Configurar velocidad (1.0-100.0 px/s, por defecto: %.1f)\n", SCROLL_SPEED_PER_SECOND);
             g_print("  --color-mode, -c <número>   Modo de organización por color (1-5, por defecto: 1)\n");
             g_print("  --color-tolerance, -t <num> Tolerancia de color (10-100, por defecto: 50)\n");
+            g_print("  --stats                     Imprimir estadísticas de frames cada 5s\n");
+            g_print("  --stats-file <ruta>         Escribir estadísticas de frames en un archivo (clave=valor)\n");
+            g_print("  --dir, -d <carpeta>         Carpeta de imágenes, recursiva (repetible; por defecto: %s)\n", ASSETS_DIR);
+            g_print("  --keep-duplicates           No omitir imágenes repetidas con otro nombre\n");
+            g_print("  --low-power                 Columnas pre-compuestas: CPU mínima por frame (portátiles, 144Hz)\n");
+            g_print("  --baked-tiles               Esquinas y sombra horneadas en cada tile: sin blur ni clips por frame\n");
+            g_print("  --span                      Un solo lienzo continuo en todos los monitores (un proceso)\n");
+            g_print("  --shard <i/n>               Mostrar solo la parte i de n de la colección (multi-monitor)\n");
+            g_print("  --sample <K>                Bibliotecas enormes: solo K imágenes activas, rotando poco a poco\n");
+            g_print("  --sample-seed <n>           Semilla del orden de rotación (por defecto: aleatoria)\n");
+            g_print("  --max-decode-pixels <MP>    Imágenes más grandes no se decodifican (por defecto: %d)\n",
+                    DECODE_BUDGET_MAX_PIXELS / 1000000);
+            g_print("  --decode-memory <MB>        Memoria total de decodificaciones en curso (por defecto: %d)\n",
+                    DECODE_BUDGET_IN_FLIGHT_BYTES / (1024 * 1024));
+            g_print("  --no-shared-thumbnails      No leer ni escribir miniaturas en ~/.cache/thumbnails\n");
+            g_print("  --trace <ruta>              Traza del arranque en formato Chrome trace (ui.perfetto.dev)\n");
             g_print("  --help, -h                  Mostrar esta ayuda\n");
             g_print("\nModos de Color:\n");
             g_print("  1 - Normal (sin agrupación por color)\n");
@@ -651,15 +2423,21 @@ int main(int argc, char **argv) {
         }
     }
 
-    if (app_data.monitor_name) {
+    if (app_data.span) {
+        app_data.monitor_name = NULL;   // Todos los monitores
+        g_print("🖥️  Iniciando WallPin wallpaper en todos los monitores (lienzo continuo)\n");
+    } else if (app_data.monitor_name) {
         g_print("🖥️  Iniciando WallPin wallpaper en monitor: %s\n", app_data.monitor_name);
     } else {
         g_print("🖥️  Iniciando WallPin wallpaper en monitor por defecto\n");
     }
     
-    if (app_data.target_fps > 0 || app_data.target_speed > 0 || app_data.color_mode != COLOR_MODE_DEFAULT) {
+    if (app_data.target_fps > 0 || app_data.adaptive_fps || app_data.target_speed > 0 ||
+        app_data.color_mode != COLOR_MODE_DEFAULT) {
         g_print("🎯 Configuración personalizada:\n");
-        if (app_data.target_fps > 0) {
+        if (app_data.adaptive_fps) {
+            g_print("   FPS: auto\n");
+        } else if (app_data.target_fps > 0) {
             g_print("   FPS: %d\n", app_data.target_fps);
         } else {
             g_print("   FPS: %d (por defecto)\n", TARGET_FPS);
@@ -682,6 +2460,12 @@ int main(int argc, char **argv) {
                 TARGET_FPS, SCROLL_SPEED_PER_SECOND);
     }
 
+    if (app_data.stats || app_data.stats_file) {
+        frame_stats_enable(app_data.stats, app_data.stats_file, 0);
+        alloc_stats_enable(app_data.stats);
+        g_unix_signal_add(SIGUSR1, on_alloc_stats_signal, NULL);
+    }
+
     // Crear application ID único para cada monitor para evitar conflictos
     char app_id[256];
     if (app_data.monitor_name) {
@@ -696,6 +2480,8 @@ int main(int argc, char **argv) {
         }
         
         snprintf(app_id, sizeof(app_id), "org.gtk.wallpin.wallpaper_%s", clean_monitor);
+    } else if (app_data.span) {
+        snprintf(app_id, sizeof(app_id), "org.gtk.wallpin.wallpaper_span");
     } else {
         snprintf(app_id, sizeof(app_id), "org.gtk.wallpin.wallpaper_default");
     }
@@ -704,12 +2490,44 @@ int main(int argc, char **argv) {
 
     app = gtk_application_new(app_id, G_APPLICATION_DEFAULT_FLAGS);
     g_signal_connect(app, "activate", G_CALLBACK(activate), &app_data);
+    control_install(G_APPLICATION(app), &control_ops);
+    prefetch_init();
+    decode_scheduler_init(on_tile_decoded, NULL);
     status = g_application_run(G_APPLICATION(app), gtk_argc, gtk_argv);
 
     cleanup_auto_scroll();
+    cancel_color_order();
+    free_staged_collection();
+    flush_retired_collection();
+    if (sample_rotate_id > 0) g_source_remove(sample_rotate_id);
+    reset_sample_window(NULL);
+    g_clear_pointer(&sample_turns, g_hash_table_destroy);
+    if (swap_textures_id > 0) g_source_remove(swap_textures_id);
+    g_clear_pointer(&swap_textures, g_hash_table_destroy);
+    g_clear_pointer(&swap_fades, g_ptr_array_unref);
+    frame_stats_shutdown();
+    forget_tiles();
+    g_clear_pointer(&resident_tiles, g_hash_table_destroy);
     masonry_layout_free(&layout);
+    g_clear_pointer(&tile_widgets, g_hash_table_destroy);
+    g_clear_pointer(&span_strips, g_ptr_array_unref);
+    cache_clear(color_cache, sizeof(Color));
+    cache_clear(phash_cache, sizeof(PHash));
+    g_clear_pointer(&color_cache, g_hash_table_destroy);
+    g_clear_pointer(&phash_cache, g_hash_table_destroy);
+    scanner_stop(active_scanner);
+    active_scanner = NULL;
+    reset_scan_load();
+    g_clear_pointer(&current_asset_roots, g_strfreev);
+    decode_scheduler_shutdown();
+    shared_thumbnails_shutdown();   // Tras los hilos de ingesta: ya no llegan escrituras
+    image_loader_clear_thumbnails();
+    prefetch_shutdown();
+    trace_shutdown();   // Después de parar los hilos: sus spans ya están escritos
+    g_ptr_array_unref(app_data.asset_dirs);
 
     g_object_unref(app);
+    alloc_stats_shutdown();   // Al final: lo que siga vivo aquí es una fuga
     free(gtk_argv);
     return status;
 }
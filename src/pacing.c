@@ -0,0 +1,109 @@
+#include "pacing.h"
+#include <math.h>
+
+gboolean pacing_enabled = FALSE;
+
+static struct {
+    double refresh_hz;
+    int divisor;               // Elegido por velocidad y tope: fps = refresh / divisor
+    int max_divisor;           // Hasta dónde puede retroceder (PACING_FLOOR_FPS)
+    int backoff;               // Escalones extra por carga
+    gint64 window_work;        // Trabajo acumulado desde la última decisión (µs)
+    int window_ticks;
+    gint64 paint_start;
+    GdkFrameClock *clock;
+} pacing = { PACING_DEFAULT_REFRESH_HZ, 1, 1, 0, 0, 0, 0, NULL };
+
+static int current_divisor(void) {
+    return MIN(pacing.divisor + pacing.backoff, pacing.max_divisor);
+}
+
+void pacing_set_enabled(gboolean enabled) {
+    pacing_enabled = enabled;
+    pacing.backoff = 0;
+    pacing.window_work = 0;
+    pacing.window_ticks = 0;
+}
+
+void pacing_configure(double refresh_hz, double speed_per_second, double scale, double max_fps) {
+    pacing.refresh_hz = refresh_hz > 0 ? refresh_hz : PACING_DEFAULT_REFRESH_HZ;
+    double cap = max_fps > 0 ? MIN(max_fps, pacing.refresh_hz) : pacing.refresh_hz;
+    double needed = MAX(speed_per_second * MAX(scale, 1.0) / PACING_MAX_STEP_PX, PACING_MIN_FPS);
+
+    // El divisor mayor (menos ticks) que aún da `needed`, sin pasar del tope
+    int min_divisor = MAX(1, (int)ceil(pacing.refresh_hz / cap - 1e-9));
+    int smooth_divisor = MAX(1, (int)floor(pacing.refresh_hz / needed + 1e-9));
+    pacing.divisor = MAX(smooth_divisor, min_divisor);
+    pacing.max_divisor = MAX(pacing.divisor, (int)floor(pacing.refresh_hz / PACING_FLOOR_FPS));
+    pacing.backoff = 0;
+    pacing.window_work = 0;
+    pacing.window_ticks = 0;
+}
+
+double pacing_get_fps(void) {
+    return pacing.refresh_hz / current_divisor();
+}
+
+int pacing_get_interval_ms(void) {
+    return MAX(1, (int)(1000.0 / pacing_get_fps() + 0.5));
+}
+
+int pacing_get_divisor(void) {
+    return current_divisor();
+}
+
+double pacing_get_refresh_hz(void) {
+    return pacing.refresh_hz;
+}
+
+void pacing_add_work(gint64 work_us) {
+    if (pacing_enabled && work_us > 0) pacing.window_work += work_us;
+}
+
+gboolean pacing_tick(void) {
+    if (!pacing_enabled || ++pacing.window_ticks < PACING_WINDOW_TICKS) return FALSE;
+
+    double interval_us = G_USEC_PER_SEC / pacing_get_fps();
+    double work = (double)pacing.window_work / pacing.window_ticks;
+    pacing.window_work = 0;
+    pacing.window_ticks = 0;
+
+    int before = current_divisor();
+    if (work > PACING_BUDGET * interval_us && before < pacing.max_divisor) {
+        pacing.backoff++;
+    } else if (work < PACING_RECOVER * interval_us && pacing.backoff > 0) {
+        pacing.backoff--;
+    }
+
+    if (current_divisor() == before) return FALSE;
+    g_print("⏱️  Ritmo adaptativo: %.1f FPS (trabajo medio por frame %.1f ms)\n",
+            pacing_get_fps(), work / 1000.0);
+    return TRUE;
+}
+
+static void on_before_paint(G_GNUC_UNUSED GdkFrameClock *clock, G_GNUC_UNUSED gpointer user_data) {
+    if (pacing_enabled) pacing.paint_start = g_get_monotonic_time();
+}
+
+static void on_after_paint(G_GNUC_UNUSED GdkFrameClock *clock, G_GNUC_UNUSED gpointer user_data) {
+    if (!pacing_enabled || pacing.paint_start == 0) return;
+    pacing_add_work(g_get_monotonic_time() - pacing.paint_start);
+    pacing.paint_start = 0;
+}
+
+static void on_window_map(GtkWidget *window, G_GNUC_UNUSED gpointer user_data) {
+    GdkFrameClock *clock = gtk_widget_get_frame_clock(window);
+    if (!clock || clock == pacing.clock) return;
+
+    if (pacing.clock) {
+        g_signal_handlers_disconnect_by_data(pacing.clock, &pacing);
+        g_object_unref(pacing.clock);
+    }
+    pacing.clock = g_object_ref(clock);
+    g_signal_connect(clock, "before-paint", G_CALLBACK(on_before_paint), &pacing);
+    g_signal_connect(clock, "after-paint", G_CALLBACK(on_after_paint), &pacing);
+}
+
+void pacing_attach(GtkWidget *window) {
+    g_signal_connect(window, "map", G_CALLBACK(on_window_map), NULL);
+}
@@ -0,0 +1,34 @@
+#ifndef PACING_H
+#define PACING_H
+
+#include <gtk/gtk.h>
+
+// Ritmo adaptativo del scroll (--fps auto): la frecuencia de ticks más baja que mantiene
+// el paso por tick por debajo de un píxel de dispositivo, redondeada a un divisor del
+// refresco del monitor. Quien hace scroll avanza en uno de cada pacing_get_divisor()
+// frames del frame clock, así cada tick cae en el mismo vblank relativo. Si el
+// trabajo medido por frame (tick + layout/paint) se come el presupuesto, baja un escalón más.
+#define PACING_MAX_STEP_PX 1.0         // Paso máximo por tick, en píxeles de dispositivo
+#define PACING_MIN_FPS 20.0            // Suelo de suavidad aunque la velocidad permitiera menos
+#define PACING_FLOOR_FPS 10.0          // Límite del retroceso por carga
+#define PACING_BUDGET 0.5              // Trabajo por frame tolerado, fracción del intervalo
+#define PACING_RECOVER 0.2             // Por debajo se deshace un escalón de retroceso
+#define PACING_WINDOW_TICKS 60         // Ticks entre decisiones
+#define PACING_DEFAULT_REFRESH_HZ 60.0 // Si el monitor no informa de su refresco
+
+extern gboolean pacing_enabled;
+
+void pacing_set_enabled(gboolean enabled);
+// Mide layout + paint en el frame clock de la ventana (solo cuenta con pacing activo)
+void pacing_attach(GtkWidget *window);
+// refresh_hz <= 0: PACING_DEFAULT_REFRESH_HZ. max_fps <= 0: sin tope aparte del refresco
+void pacing_configure(double refresh_hz, double speed_per_second, double scale, double max_fps);
+double pacing_get_fps(void);
+int pacing_get_interval_ms(void);
+int pacing_get_divisor(void);
+double pacing_get_refresh_hz(void);
+void pacing_add_work(gint64 work_us);
+// Una vez por tick; TRUE si la frecuencia (el divisor) cambió
+gboolean pacing_tick(void);
+
+#endif // PACING_H
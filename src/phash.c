@@ -0,0 +1,148 @@
+#include "phash.h"
+#include "decode_budget.h"
+
+#define PHASH_GRID_WIDTH 9
+#define PHASH_GRID_HEIGHT 8
+#define PHASH_CHUNK_BITS (64 / PHASH_INDEX_CHUNKS)
+#define PHASH_BUCKETS (1 << PHASH_CHUNK_BITS)
+
+typedef struct {
+    PHash hash;
+    char *path;
+} PHashEntry;
+
+struct PHashIndex {
+    int max_distance;
+    GArray *entries;                          // PHashEntry
+    gint32 *heads[PHASH_INDEX_CHUNKS];        // Primer elemento de cada cubo (-1 = vacío)
+    GArray *next[PHASH_INDEX_CHUNKS];         // gint32, siguiente elemento del mismo cubo
+};
+
+// Luminancia media por celda de la rejilla 9x8 (promedio de área, no muestreo puntual,
+// para que el hash no dependa de qué píxel cae en cada celda). Sin detalle horizontal
+// suficiente, PHASH_FLAT (una imagen con detalle cuyo hash sea justo 0 también acaba ahí:
+// solo se pierde su deduplicación)
+PHash phash_compute_pixbuf(GdkPixbuf *pixbuf) {
+    int width = gdk_pixbuf_get_width(pixbuf);
+    int height = gdk_pixbuf_get_height(pixbuf);
+    int channels = gdk_pixbuf_get_n_channels(pixbuf);
+    int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+    const guchar *pixels = gdk_pixbuf_read_pixels(pixbuf);
+
+    double cells[PHASH_GRID_HEIGHT][PHASH_GRID_WIDTH] = {{0}};
+    int counts[PHASH_GRID_HEIGHT][PHASH_GRID_WIDTH] = {{0}};
+
+    for (int y = 0; y < height; y++) {
+        int cy = y * PHASH_GRID_HEIGHT / height;
+        const guchar *row = pixels + (gsize)y * rowstride;
+        for (int x = 0; x < width; x++) {
+            int cx = x * PHASH_GRID_WIDTH / width;
+            const guchar *pixel = row + x * channels;
+            cells[cy][cx] += 0.299 * pixel[0] + 0.587 * pixel[1] + 0.114 * pixel[2];
+            counts[cy][cx]++;
+        }
+    }
+
+    PHash hash = 0;
+    int detail = 0;
+    for (int cy = 0; cy < PHASH_GRID_HEIGHT; cy++) {
+        for (int cx = 0; cx < PHASH_GRID_WIDTH - 1; cx++) {
+            double left = counts[cy][cx] ? cells[cy][cx] / counts[cy][cx] : 0.0;
+            double right = counts[cy][cx + 1] ? cells[cy][cx + 1] / counts[cy][cx + 1] : 0.0;
+            hash = (hash << 1) | (left > right ? 1 : 0);
+            if (ABS(left - right) >= PHASH_DETAIL_DELTA) detail++;
+        }
+    }
+    return detail >= PHASH_MIN_DETAIL_BITS ? hash : PHASH_FLAT;
+}
+
+// Decodifica solo una miniatura (el loader JPEG reduce en el dominio DCT) y calcula el hash
+gboolean phash_compute_file(const char *path, PHash *out) {
+    GdkPixbuf *pixbuf = decode_budget_load_file_at_scale(path, PHASH_SAMPLE_SIZE, PHASH_SAMPLE_SIZE, FALSE, NULL);
+    if (!pixbuf) {
+        return FALSE;
+    }
+
+    *out = phash_compute_pixbuf(pixbuf);
+    g_object_unref(pixbuf);
+    return TRUE;
+}
+
+int phash_distance(PHash a, PHash b) {
+    return __builtin_popcountll(a ^ b);
+}
+
+gboolean phash_is_duplicate(PHash a, PHash b) {
+    return a != PHASH_FLAT && b != PHASH_FLAT && phash_distance(a, b) <= PHASH_DUPLICATE_DISTANCE;
+}
+
+static guint phash_chunk(PHash hash, int chunk) {
+    return (guint)((hash >> (chunk * PHASH_CHUNK_BITS)) & (PHASH_BUCKETS - 1));
+}
+
+PHashIndex *phash_index_new(int max_distance) {
+    PHashIndex *index = g_new0(PHashIndex, 1);
+    // Más allá de CHUNKS-1 el palomar no garantiza un trozo común
+    index->max_distance = CLAMP(max_distance, 0, PHASH_INDEX_CHUNKS - 1);
+    index->entries = g_array_new(FALSE, FALSE, sizeof(PHashEntry));
+
+    for (int c = 0; c < PHASH_INDEX_CHUNKS; c++) {
+        index->heads[c] = g_new(gint32, PHASH_BUCKETS);
+        for (int b = 0; b < PHASH_BUCKETS; b++) {
+            index->heads[c][b] = -1;
+        }
+        index->next[c] = g_array_new(FALSE, FALSE, sizeof(gint32));
+    }
+    return index;
+}
+
+// Devuelve la ruta de una imagen ya indexada a distancia <= max_distance, o NULL
+const char *phash_index_find(const PHashIndex *index, PHash hash) {
+    if (hash == PHASH_FLAT) return NULL;
+    for (int c = 0; c < PHASH_INDEX_CHUNKS; c++) {
+        gint32 i = index->heads[c][phash_chunk(hash, c)];
+        while (i >= 0) {
+            const PHashEntry *entry = &g_array_index(index->entries, PHashEntry, i);
+            if (phash_distance(entry->hash, hash) <= index->max_distance) {
+                return entry->path;
+            }
+            i = g_array_index(index->next[c], gint32, i);
+        }
+    }
+    return NULL;
+}
+
+void phash_index_add(PHashIndex *index, const char *path, PHash hash) {
+    gint32 position = (gint32)index->entries->len;
+    PHashEntry entry = { hash, g_strdup(path) };
+    g_array_append_val(index->entries, entry);
+
+    for (int c = 0; c < PHASH_INDEX_CHUNKS; c++) {
+        if (hash == PHASH_FLAT) {
+            gint32 none = -1;   // Fuera de los cubos: ningún hash casi nulo lo encuentra
+            g_array_append_val(index->next[c], none);
+            continue;
+        }
+        guint bucket = phash_chunk(hash, c);
+        g_array_append_val(index->next[c], index->heads[c][bucket]);
+        index->heads[c][bucket] = position;
+    }
+}
+
+guint phash_index_size(const PHashIndex *index) {
+    return index->entries->len;
+}
+
+void phash_index_free(PHashIndex *index) {
+    if (!index) return;
+
+    for (guint i = 0; i < index->entries->len; i++) {
+        g_free(g_array_index(index->entries, PHashEntry, i).path);
+    }
+    g_array_free(index->entries, TRUE);
+    for (int c = 0; c < PHASH_INDEX_CHUNKS; c++) {
+        g_free(index->heads[c]);
+        g_array_free(index->next[c], TRUE);
+    }
+    g_free(index);
+}
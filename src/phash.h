@@ -0,0 +1,41 @@
+#ifndef PHASH_H
+#define PHASH_H
+
+#include <glib.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+// Hash perceptual (dHash) de 64 bits: gradiente horizontal de luminancia en una rejilla 9x8
+typedef guint64 PHash;
+
+#define PHASH_SAMPLE_SIZE 64          // Lado de la miniatura que se decodifica para calcular el hash
+#define PHASH_DUPLICATE_DISTANCE 3    // Bits distintos tolerados (recompresión, reescalado, renombrado)
+#define PHASH_INDEX_CHUNKS 4          // Trozos de 16 bits del índice multi-hash
+
+// El dHash solo mira vecinos horizontales: un color liso o un degradado vertical da
+// (casi) todos los bits a 0 o a ruido, y dos fondos minimalistas distintos saldrían
+// "iguales". Con menos de PHASH_MIN_DETAIL_BITS diferencias claras (>= PHASH_DETAIL_DELTA
+// niveles de luminancia entre celdas vecinas) el hash es PHASH_FLAT y no se deduplica
+#define PHASH_FLAT ((PHash)0)
+#define PHASH_DETAIL_DELTA 2.0
+#define PHASH_MIN_DETAIL_BITS 8
+
+gboolean phash_compute_file(const char *path, PHash *out);
+PHash phash_compute_pixbuf(GdkPixbuf *pixbuf);
+int phash_distance(PHash a, PHash b);
+// Casi-duplicados a distancia <= PHASH_DUPLICATE_DISTANCE; nunca si alguno es PHASH_FLAT
+gboolean phash_is_duplicate(PHash a, PHash b);
+
+// Índice multi-hash (MIH) para buscar casi-duplicados: el hash se parte en
+// PHASH_INDEX_CHUNKS trozos y cada trozo indexa una tabla. Por el principio del
+// palomar, dos hashes a distancia < PHASH_INDEX_CHUNKS comparten al menos un
+// trozo exacto, así que solo se comparan los candidatos de esos cubos.
+typedef struct PHashIndex PHashIndex;
+
+// Los hashes PHASH_FLAT se cuentan pero no se indexan: nunca dan ni reciben un match
+PHashIndex *phash_index_new(int max_distance);
+const char *phash_index_find(const PHashIndex *index, PHash hash);
+void phash_index_add(PHashIndex *index, const char *path, PHash hash);
+guint phash_index_size(const PHashIndex *index);
+void phash_index_free(PHashIndex *index);
+
+#endif // PHASH_H
@@ -0,0 +1,210 @@
+#include "prefetch.h"
+#include "trace.h"
+#include "alloc_stats.h"
+#include <gio/gio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+typedef enum {
+    PREFETCH_LOADING,
+    PREFETCH_READY,
+    PREFETCH_FAILED
+} PrefetchState;
+
+typedef struct {
+    PrefetchState state;
+    GBytes *bytes;
+} PrefetchEntry;
+
+typedef struct {
+    char *path;
+    gboolean read;     // FALSE = solo WILLNEED
+} PrefetchJob;
+
+static struct {
+    GThreadPool *pool;
+    GMutex lock;
+    GCond ready;
+    GHashTable *entries;     // path -> PrefetchEntry
+    GQueue order;            // paths (propiedad de entries) en orden de llegada, para expulsar
+    gsize cached_bytes;
+    guint64 hits, waits, misses;
+} prefetch;
+
+static void free_entry(PrefetchEntry *entry) {
+    if (entry->bytes) g_bytes_unref(entry->bytes);
+    g_free(entry);
+}
+
+static GBytes *read_whole_file(const char *path, GError **error) {
+    char *contents = NULL;
+    gsize length = 0;
+    if (!g_file_get_contents(path, &contents, &length, error)) {
+        return NULL;
+    }
+    return g_bytes_new_take(contents, length);
+}
+
+static void hint_file(const char *path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+}
+
+// Quita una entrada de la tabla y de la cola de expulsión (con el lock tomado)
+static void forget_entry(const char *path) {
+    gpointer key;
+    if (g_hash_table_lookup_extended(prefetch.entries, path, &key, NULL)) {
+        g_queue_remove(&prefetch.order, key);   // La cola comparte la clave de la tabla
+        g_hash_table_remove(prefetch.entries, path);
+    }
+}
+
+// Expulsa lo más antiguo ya leído hasta volver al presupuesto (con el lock tomado)
+static void enforce_budget(void) {
+    GList *l = prefetch.order.head;
+    while (l && prefetch.cached_bytes > PREFETCH_BUDGET_BYTES) {
+        GList *next = l->next;
+        char *key = l->data;
+        PrefetchEntry *entry = g_hash_table_lookup(prefetch.entries, key);
+        if (entry && entry->state != PREFETCH_LOADING) {
+            if (entry->bytes) {
+                prefetch.cached_bytes -= g_bytes_get_size(entry->bytes);
+                ALLOC_STATS_SUB(ALLOC_DECODE, g_bytes_get_size(entry->bytes));
+            }
+            g_queue_delete_link(&prefetch.order, l);
+            g_hash_table_remove(prefetch.entries, key);
+        }
+        l = next;
+    }
+}
+
+static void prefetch_worker(gpointer data, G_GNUC_UNUSED gpointer user_data) {
+    PrefetchJob *job = data;
+    trace_set_thread_name("prefetch");
+
+    if (!job->read) {
+        TRACE_BEGIN(hint_start);
+        hint_file(job->path);
+        TRACE_END(hint_start, "readahead", job->path);
+        g_free(job->path);
+        g_free(job);
+        return;
+    }
+
+    TRACE_BEGIN(read_start);
+    GBytes *bytes = read_whole_file(job->path, NULL);
+    TRACE_END(read_start, "read", job->path);
+
+    g_mutex_lock(&prefetch.lock);
+    PrefetchEntry *entry = g_hash_table_lookup(prefetch.entries, job->path);
+    if (entry && entry->state == PREFETCH_LOADING) {
+        entry->state = bytes ? PREFETCH_READY : PREFETCH_FAILED;
+        entry->bytes = bytes;
+        if (bytes) {
+            prefetch.cached_bytes += g_bytes_get_size(bytes);
+            ALLOC_STATS_ADD(ALLOC_DECODE, g_bytes_get_size(bytes));
+        }
+        enforce_budget();
+    } else if (bytes) {
+        g_bytes_unref(bytes);   // Ya lo consumió (o lo leyó) el decodificador
+    }
+    g_cond_broadcast(&prefetch.ready);
+    g_mutex_unlock(&prefetch.lock);
+
+    g_free(job->path);
+    g_free(job);
+}
+
+void prefetch_init(void) {
+    if (prefetch.pool) return;
+
+    g_mutex_init(&prefetch.lock);
+    g_cond_init(&prefetch.ready);
+    prefetch.entries = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)free_entry);
+    g_queue_init(&prefetch.order);
+    prefetch.pool = g_thread_pool_new(prefetch_worker, NULL, PREFETCH_THREADS, FALSE, NULL);
+}
+
+static void push_job(const char *path, gboolean read) {
+    PrefetchJob *job = g_new(PrefetchJob, 1);
+    job->path = g_strdup(path);
+    job->read = read;
+    g_thread_pool_push(prefetch.pool, job, NULL);
+}
+
+void prefetch_request(const char *path) {
+    if (!prefetch.pool || !path) return;
+
+    g_mutex_lock(&prefetch.lock);
+    gboolean known = g_hash_table_contains(prefetch.entries, path);
+    if (!known) {
+        PrefetchEntry *entry = g_new0(PrefetchEntry, 1);
+        entry->state = PREFETCH_LOADING;
+        char *key = g_strdup(path);
+        g_hash_table_insert(prefetch.entries, key, entry);
+        g_queue_push_tail(&prefetch.order, key);
+    }
+    g_mutex_unlock(&prefetch.lock);
+
+    if (!known) push_job(path, TRUE);
+}
+
+void prefetch_hint(const char *path) {
+    if (!prefetch.pool || !path) return;
+    push_job(path, FALSE);
+}
+
+GBytes *prefetch_take(const char *path, GError **error) {
+    if (prefetch.pool) {
+        g_mutex_lock(&prefetch.lock);
+        PrefetchEntry *entry = g_hash_table_lookup(prefetch.entries, path);
+        if (entry) {
+            // Ya en camino: esperar es más barato que una segunda lectura en frío
+            if (entry->state == PREFETCH_LOADING) prefetch.waits++;
+            while (entry && entry->state == PREFETCH_LOADING) {
+                g_cond_wait(&prefetch.ready, &prefetch.lock);
+                entry = g_hash_table_lookup(prefetch.entries, path);
+            }
+        }
+        if (entry && entry->state == PREFETCH_READY) {
+            GBytes *bytes = g_bytes_ref(entry->bytes);
+            prefetch.cached_bytes -= g_bytes_get_size(bytes);
+            ALLOC_STATS_SUB(ALLOC_DECODE, g_bytes_get_size(bytes));   // Pasa al decodificador
+            prefetch.hits++;
+            forget_entry(path);
+            g_mutex_unlock(&prefetch.lock);
+            return bytes;
+        }
+        if (entry) {
+            // Falló en el hilo: se reintenta abajo para obtener el error real
+            forget_entry(path);
+        }
+        prefetch.misses++;
+        g_mutex_unlock(&prefetch.lock);
+    }
+
+    return read_whole_file(path, error);
+}
+
+void prefetch_shutdown(void) {
+    if (!prefetch.pool) return;
+
+    g_thread_pool_free(prefetch.pool, TRUE, TRUE);
+    prefetch.pool = NULL;
+
+    if (prefetch.hits + prefetch.misses > 0) {
+        g_print("📥 Prefetch: %" G_GUINT64_FORMAT " desde memoria (%" G_GUINT64_FORMAT " esperando la lectura), "
+                "%" G_GUINT64_FORMAT " leídos en el momento\n",
+                prefetch.hits, prefetch.waits, prefetch.misses);
+    }
+
+    g_queue_clear(&prefetch.order);
+    g_clear_pointer(&prefetch.entries, g_hash_table_destroy);
+    ALLOC_STATS_SUB(ALLOC_DECODE, prefetch.cached_bytes);
+    prefetch.cached_bytes = 0;
+    g_cond_clear(&prefetch.ready);
+    g_mutex_clear(&prefetch.lock);
+}
@@ -0,0 +1,21 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <glib.h>
+
+// Lectura anticipada de los archivos que el scroll va a necesitar. Un par de hilos
+// leen cada archivo completo a memoria (GBytes) y el decodificador lo recibe por
+// memoria, así que un decode nunca espera al disco. Para lo que está más lejos solo
+// se pide readahead al kernel (posix_fadvise WILLNEED).
+#define PREFETCH_THREADS 2
+#define PREFETCH_BUDGET_BYTES (64 * 1024 * 1024)   // Bytes leídos pendientes de consumir
+
+void prefetch_init(void);
+void prefetch_request(const char *path);     // Leer a memoria en segundo plano
+void prefetch_hint(const char *path);        // Solo readahead del kernel
+// Contenido del archivo: el ya leído, esperando si la lectura está en curso, o leído
+// aquí mismo si nunca se pidió. NULL si no se puede leer.
+GBytes *prefetch_take(const char *path, GError **error);
+void prefetch_shutdown(void);
+
+#endif // PREFETCH_H
@@ -0,0 +1,93 @@
+#include "sample_pool.h"
+
+typedef struct {
+    char *dir;
+    GPtrArray *paths;          // Barajadas según entran; se saca por el final
+} SampleFolder;
+
+struct SamplePool {
+    GRand *rand;
+    GHashTable *by_dir;        // dir -> SampleFolder (prestado de folders)
+    GPtrArray *folders;        // Orden de los turnos
+    guint cursor;              // Siguiente carpeta a la que le toca
+    guint size;
+};
+
+static void free_folder(SampleFolder *folder) {
+    g_free(folder->dir);
+    g_ptr_array_unref(folder->paths);
+    g_free(folder);
+}
+
+SamplePool *sample_pool_new(guint32 seed) {
+    SamplePool *pool = g_new0(SamplePool, 1);
+    pool->rand = g_rand_new_with_seed(seed);
+    pool->by_dir = g_hash_table_new(g_str_hash, g_str_equal);
+    pool->folders = g_ptr_array_new_with_free_func((GDestroyNotify)free_folder);
+    return pool;
+}
+
+void sample_pool_free(SamplePool *pool) {
+    if (!pool) return;
+    g_hash_table_destroy(pool->by_dir);
+    g_ptr_array_unref(pool->folders);
+    g_rand_free(pool->rand);
+    g_free(pool);
+}
+
+// Fisher-Yates "de dentro a fuera": cada ruta entra en una posición al azar, así la
+// carpeta queda barajada sin esperar a que termine el escaneo
+static void insert_shuffled(SamplePool *pool, SampleFolder *folder, char *path) {
+    g_ptr_array_add(folder->paths, path);
+    guint last = folder->paths->len - 1;
+    guint j = (guint)g_rand_int_range(pool->rand, 0, (gint32)last + 1);
+    folder->paths->pdata[last] = folder->paths->pdata[j];
+    folder->paths->pdata[j] = path;
+    pool->size++;
+}
+
+static void insert_path(SamplePool *pool, char *path) {
+    char *dir = g_path_get_dirname(path);
+    SampleFolder *folder = g_hash_table_lookup(pool->by_dir, dir);
+    if (!folder) {
+        folder = g_new0(SampleFolder, 1);
+        folder->dir = dir;
+        folder->paths = g_ptr_array_new_with_free_func(g_free);
+        g_ptr_array_add(pool->folders, folder);
+        g_hash_table_insert(pool->by_dir, folder->dir, folder);
+    } else {
+        g_free(dir);
+    }
+    insert_shuffled(pool, folder, path);
+}
+
+void sample_pool_add(SamplePool *pool, const char *path) {
+    insert_path(pool, g_strdup(path));
+}
+
+void sample_pool_return(SamplePool *pool, char *path) {
+    insert_path(pool, path);
+}
+
+char *sample_pool_take(SamplePool *pool) {
+    if (pool->size == 0) return NULL;
+
+    // Hay al menos una carpeta con algo: como mucho una vuelta completa
+    for (guint tried = 0; tried < pool->folders->len; tried++) {
+        SampleFolder *folder = g_ptr_array_index(pool->folders, pool->cursor);
+        pool->cursor = (pool->cursor + 1) % pool->folders->len;
+        if (folder->paths->len == 0) continue;
+
+        pool->size--;
+        return g_ptr_array_steal_index_fast(folder->paths, folder->paths->len - 1);
+    }
+    return NULL;
+}
+
+guint sample_pool_size(const SamplePool *pool) {
+    return pool ? pool->size : 0;
+}
+
+guint sample_pool_folders(const SamplePool *pool) {
+    return pool ? pool->folders->len : 0;
+}
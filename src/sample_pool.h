@@ -0,0 +1,29 @@
+#ifndef SAMPLE_POOL_H
+#define SAMPLE_POOL_H
+
+#include <glib.h>
+
+// Reserva de rutas para el modo muestreo (--sample K): con bibliotecas de decenas de
+// miles de archivos solo K imágenes están activas (layout, ingesta, texturas, widgets);
+// las demás esperan aquí como simples rutas y van entrando de una en una según los
+// tiles salen por arriba. La rotación va por turnos entre subcarpetas, así que una
+// carpeta enorme no tapa a las pequeñas, y dentro de cada una el orden es aleatorio
+// con semilla (misma semilla y mismos archivos = misma secuencia).
+#define SAMPLE_CANDIDATES 8           // Rutas que se miran para elegir la que mejor encaja en el hueco
+
+typedef struct SamplePool SamplePool;
+
+SamplePool *sample_pool_new(guint32 seed);
+void sample_pool_free(SamplePool *pool);
+
+// Apunta una ruta en la reserva de su subcarpeta (copia)
+void sample_pool_add(SamplePool *pool, const char *path);
+// Siguiente ruta por turno de subcarpeta (propiedad de quien llama), NULL si está vacía
+char *sample_pool_take(SamplePool *pool);
+// Devuelve una ruta a su subcarpeta en una posición aleatoria (toma la propiedad)
+void sample_pool_return(SamplePool *pool, char *path);
+
+guint sample_pool_size(const SamplePool *pool);
+guint sample_pool_folders(const SamplePool *pool);
+
+#endif // SAMPLE_POOL_H
@@ -0,0 +1,186 @@
+#include "scanner.h"
+#include <string.h>
+#include <strings.h>
+#include "alloc_stats.h"
+
+#define SCANNER_ATTRIBUTES G_FILE_ATTRIBUTE_STANDARD_NAME "," G_FILE_ATTRIBUTE_STANDARD_TYPE
+
+struct Scanner {
+    int ref_count;             // Dueño + una por cada operación asíncrona en curso
+    gboolean cancelled;
+    gboolean finished;
+    GCancellable *cancellable;
+    GQueue pending;            // GFile* de carpetas por enumerar
+    int active;                // Enumeraciones en curso
+    guint total;
+
+    ScannerBatchFunc on_batch;
+    ScannerDoneFunc on_done;
+    gpointer user_data;
+};
+
+// Mismo filtro que usaba el escaneo con readdir
+gboolean scanner_is_image_name(const char *name) {
+    const char *ext = strrchr(name, '.');
+    return ext && (strcasecmp(ext, ".jpg") == 0 ||
+                   strcasecmp(ext, ".jpeg") == 0 ||
+                   strcasecmp(ext, ".png") == 0);
+}
+
+static Scanner *scanner_ref(Scanner *scanner) {
+    scanner->ref_count++;
+    return scanner;
+}
+
+static void scanner_unref(Scanner *scanner) {
+    if (--scanner->ref_count > 0) return;
+
+    g_queue_clear_full(&scanner->pending, g_object_unref);
+    g_object_unref(scanner->cancellable);
+    g_free(scanner);
+}
+
+static void on_enumerate_ready(GObject *source, GAsyncResult *result, gpointer user_data);
+
+// Lanza enumeraciones hasta el límite de paralelismo y avisa cuando no queda nada
+static void scanner_pump(Scanner *scanner) {
+    while (!scanner->cancelled && scanner->active < SCANNER_PARALLEL_DIRS &&
+           !g_queue_is_empty(&scanner->pending)) {
+        GFile *dir = g_queue_pop_head(&scanner->pending);
+        scanner->active++;
+        // Sin seguir enlaces simbólicos: evita ciclos y recorrer dos veces el mismo árbol
+        g_file_enumerate_children_async(dir, SCANNER_ATTRIBUTES, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                        G_PRIORITY_LOW, scanner->cancellable,
+                                        on_enumerate_ready, scanner_ref(scanner));
+        g_object_unref(dir);
+    }
+
+    if (!scanner->cancelled && !scanner->finished && scanner->active == 0 &&
+        g_queue_is_empty(&scanner->pending)) {
+        scanner->finished = TRUE;
+        if (scanner->on_done) {
+            scanner->on_done(scanner->total, scanner->user_data);
+        }
+    }
+}
+
+static void finish_directory(Scanner *scanner) {
+    scanner->active--;
+    scanner_pump(scanner);
+    scanner_unref(scanner);
+}
+
+static void on_next_files_ready(GObject *source, GAsyncResult *result, gpointer user_data) {
+    GFileEnumerator *enumerator = G_FILE_ENUMERATOR(source);
+    Scanner *scanner = user_data;
+    GError *error = NULL;
+    GList *infos = g_file_enumerator_next_files_finish(enumerator, result, &error);
+
+    if (!infos || scanner->cancelled) {
+        if (error && !g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            char *path = g_file_get_path(g_file_enumerator_get_container(enumerator));
+            g_warning("Error leyendo %s: %s", path ? path : "(?)", error->message);
+            g_free(path);
+        }
+        g_clear_error(&error);
+        g_list_free_full(infos, g_object_unref);
+        g_object_unref(enumerator);
+        finish_directory(scanner);
+        return;
+    }
+
+    GPtrArray *batch = g_ptr_array_new_with_free_func(g_free);
+    gsize batch_bytes = 0;
+    for (GList *l = infos; l != NULL; l = l->next) {
+        GFileInfo *info = l->data;
+        const char *name = g_file_info_get_name(info);
+        if (!name || name[0] == '.') continue;   // Ocultos (.thumbnails, .git...)
+
+        GFileType type = g_file_info_get_file_type(info);
+        if (type == G_FILE_TYPE_DIRECTORY) {
+            g_queue_push_tail(&scanner->pending, g_file_enumerator_get_child(enumerator, info));
+        } else if (type == G_FILE_TYPE_REGULAR && scanner_is_image_name(name)) {
+            GFile *child = g_file_enumerator_get_child(enumerator, info);
+            char *path = g_file_get_path(child);   // NULL si no hay ruta local (ni FUSE)
+            if (path) {
+                g_ptr_array_add(batch, path);
+                batch_bytes += strlen(path) + 1;
+            }
+            g_object_unref(child);
+        }
+    }
+    g_list_free_full(infos, g_object_unref);
+
+    ALLOC_STATS_ADD(ALLOC_SCAN, batch_bytes);
+    if (batch->len > 0 && scanner->on_batch) {
+        scanner->total += batch->len;
+        scanner->on_batch(batch, scanner->user_data);
+    }
+    g_ptr_array_unref(batch);
+    ALLOC_STATS_SUB(ALLOC_SCAN, batch_bytes);   // Lo que robó el callback ya lo cuenta quien lo guarde
+
+    // El callback pudo cancelar el escaneo
+    if (scanner->cancelled) {
+        g_object_unref(enumerator);
+        finish_directory(scanner);
+        return;
+    }
+
+    scanner_pump(scanner);
+    g_file_enumerator_next_files_async(enumerator, SCANNER_BATCH_SIZE, G_PRIORITY_LOW,
+                                       scanner->cancellable, on_next_files_ready, scanner);
+}
+
+static void on_enumerate_ready(GObject *source, GAsyncResult *result, gpointer user_data) {
+    Scanner *scanner = user_data;
+    GError *error = NULL;
+    GFileEnumerator *enumerator = g_file_enumerate_children_finish(G_FILE(source), result, &error);
+
+    if (!enumerator) {
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            char *path = g_file_get_path(G_FILE(source));
+            g_print("Error opening directory: %s (%s)\n", path ? path : "(?)", error->message);
+            g_free(path);
+        }
+        g_clear_error(&error);
+        finish_directory(scanner);
+        return;
+    }
+
+    if (scanner->cancelled) {
+        g_object_unref(enumerator);
+        finish_directory(scanner);
+        return;
+    }
+
+    g_file_enumerator_next_files_async(enumerator, SCANNER_BATCH_SIZE, G_PRIORITY_LOW,
+                                       scanner->cancellable, on_next_files_ready, scanner);
+}
+
+Scanner *scanner_start(const char * const *roots, ScannerBatchFunc on_batch,
+                       ScannerDoneFunc on_done, gpointer user_data) {
+    Scanner *scanner = g_new0(Scanner, 1);
+    scanner->ref_count = 1;
+    scanner->cancellable = g_cancellable_new();
+    g_queue_init(&scanner->pending);
+    scanner->on_batch = on_batch;
+    scanner->on_done = on_done;
+    scanner->user_data = user_data;
+
+    for (const char * const *root = roots; root && *root; root++) {
+        if ((*root)[0]) {
+            g_queue_push_tail(&scanner->pending, g_file_new_for_path(*root));
+        }
+    }
+
+    scanner_pump(scanner);
+    return scanner;
+}
+
+void scanner_stop(Scanner *scanner) {
+    if (!scanner) return;
+
+    scanner->cancelled = TRUE;
+    g_cancellable_cancel(scanner->cancellable);
+    scanner_unref(scanner);
+}
@@ -0,0 +1,25 @@
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <gio/gio.h>
+
+// Escaneo asíncrono y recursivo de varias carpetas raíz. La enumeración la hace GIO
+// (el tipo de cada entrada sale de stat, no de d_type) y los resultados llegan por
+// lotes en el main loop, así que ni un NAS con 100k archivos bloquea el primer frame.
+#define SCANNER_BATCH_SIZE 256        // Entradas pedidas por llamada a next_files
+#define SCANNER_PARALLEL_DIRS 4       // Carpetas enumerándose a la vez
+
+typedef struct Scanner Scanner;
+
+// paths: rutas absolutas (char*) de imágenes nuevas; el array es del scanner,
+// se pueden robar elementos con g_ptr_array_steal_index
+typedef void (*ScannerBatchFunc)(GPtrArray *paths, gpointer user_data);
+typedef void (*ScannerDoneFunc)(guint total, gpointer user_data);
+
+Scanner *scanner_start(const char * const *roots, ScannerBatchFunc on_batch,
+                       ScannerDoneFunc on_done, gpointer user_data);
+// Cancela si sigue en marcha (no habrá más callbacks) y suelta la referencia del llamador
+void scanner_stop(Scanner *scanner);
+gboolean scanner_is_image_name(const char *name);
+
+#endif // SCANNER_H
@@ -0,0 +1,651 @@
+#include "scroll_strip.h"
+#include "prefetch.h"
+#include "tile_render.h"
+#include "alloc_stats.h"
+#include <math.h>
+
+typedef struct {
+    char *path;
+    float y;                   // Posición dentro del periodo (coordenadas lógicas)
+    float height;
+} StripTile;
+
+struct _ScrollStrip {
+    GtkWidget parent_instance;
+
+    ScrollStripRequestFunc request;
+    GtkAdjustment *adjustment;
+    gboolean follower;         // El adjustment es de otra franja (ver scroll_strip_follow)
+
+    // Trozo del lienzo que muestra esta franja (ver scroll_strip_set_canvas)
+    int canvas_width;          // 0 = el ancho del propio widget
+    int offset_x;
+    int offset_y;
+
+    GArray **columns;          // Un GArray de StripTile por columna, ordenado por y
+    int num_columns;
+    int column_width;
+    double scale;
+    double period;             // Alto de la franja antes de repetirse (incluye el hueco final)
+    int segments_per_column;
+
+    GHashTable *segments;      // (columna << 16 | segmento) -> GdkTexture compuesta
+    GHashTable *tile_textures; // path -> GdkTexture (NULL = ilegible) llegada para los segmentos por componer
+    GHashTable *requested;     // path -> TILE_SIZE_KEY pedido y aún sin llegar
+    guint prerender_id;
+
+    // Hover: tile dibujado en vivo encima de los segmentos
+    double pointer_x, pointer_y;
+    gboolean pointer_inside;
+    int hover_column;
+    int hover_index;           // -1 = ninguno
+    double hover_base;         // Inicio del periodo (en coordenadas de la franja) del tile bajo el puntero
+    GdkTexture *hover_texture;
+};
+
+G_DEFINE_TYPE(ScrollStrip, scroll_strip, GTK_TYPE_WIDGET)
+
+static const GdkRGBA strip_background = { 0x12 / 255.0f, 0x12 / 255.0f, 0x12 / 255.0f, 1.0f };
+
+#define SEGMENT_KEY(column, segment) GUINT_TO_POINTER(((guint)(column) << 16) | (guint)(segment))
+#define TILE_SIZE_KEY(width, height) GUINT_TO_POINTER(((guint)(width) << 16) | (guint)(height))
+
+// Un tile dentro de un segmento: y relativa al borde superior del segmento
+typedef struct {
+    const StripTile *tile;
+    double y;
+} SegmentTile;
+
+// === Geometría ===
+
+static double column_pitch(ScrollStrip *self) {
+    return self->column_width + TILE_CSS_CHROME + IMAGE_SPACING;
+}
+
+// Misma colocación horizontal que el modo normal: columnas centradas con el chrome del CSS
+// (sobre el lienzo completo, en coordenadas de este widget)
+static double column_x(ScrollStrip *self, int column) {
+    double canvas = self->canvas_width > 0 ? self->canvas_width : gtk_widget_get_width(GTK_WIDGET(self));
+    double total = self->num_columns * column_pitch(self) - IMAGE_SPACING;
+    double x0 = (canvas - total) / 2.0 - self->offset_x;
+    return x0 + column * column_pitch(self) + TILE_CSS_CHROME / 2.0;
+}
+
+// Columnas de otros monitores: ni se componen ni se dibujan
+static gboolean column_visible(ScrollStrip *self, int column) {
+    double x = column_x(self, column) - STRIP_SHADOW_PAD;
+    return x < gtk_widget_get_width(GTK_WIDGET(self)) && x + self->column_width + 2 * STRIP_SHADOW_PAD > 0;
+}
+
+// Desplazamiento vertical de lo que se ve: el scroll común más la altura del monitor en el lienzo
+static double scroll_offset(ScrollStrip *self) {
+    return gtk_adjustment_get_value(self->adjustment) + self->offset_y;
+}
+
+static double segment_height(ScrollStrip *self, int segment) {
+    return MIN(STRIP_SEGMENT_HEIGHT, self->period - (double)segment * STRIP_SEGMENT_HEIGHT);
+}
+
+// Primer tile de la columna cuyo borde inferior queda por debajo de y
+static guint first_tile_below(GArray *tiles, double y) {
+    guint low = 0, high = tiles->len;
+    while (low < high) {
+        guint mid = (low + high) / 2;
+        StripTile *tile = &g_array_index(tiles, StripTile, mid);
+        if (tile->y + tile->height < y) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static int tile_device_width(ScrollStrip *self) {
+    return (int)ceil(self->column_width * self->scale);
+}
+
+static int tile_device_height(ScrollStrip *self, const StripTile *tile) {
+    return (int)ceil(tile->height * self->scale);
+}
+
+// Píxeles lógicos desde el borde inferior de lo visible hasta el segmento (0 = ya a la vista)
+static double segment_distance(ScrollStrip *self, int segment) {
+    double top = (double)segment * STRIP_SEGMENT_HEIGHT - fmod(scroll_offset(self), self->period);
+    if (top + segment_height(self, segment) < 0) top += self->period;
+    return MAX(0.0, top - gtk_widget_get_height(GTK_WIDGET(self)));
+}
+
+// Tiles que tocan el segmento, sombra incluida. Los del final del periodo también
+// proyectan sombra al principio (y viceversa)
+static GArray *segment_tiles(ScrollStrip *self, int column, int segment) {
+    GArray *out = g_array_new(FALSE, FALSE, sizeof(SegmentTile));
+    GArray *tiles = self->columns[column];
+    double top = (double)segment * STRIP_SEGMENT_HEIGHT;
+    double height = segment_height(self, segment);
+
+    for (int wrap = -1; wrap <= 1; wrap++) {
+        double shift = wrap * self->period;
+        for (guint i = first_tile_below(tiles, top - shift - STRIP_SHADOW_PAD); i < tiles->len; i++) {
+            SegmentTile entry = { &g_array_index(tiles, StripTile, i), 0.0 };
+            entry.y = entry.tile->y + shift - top;
+            if (entry.y - STRIP_SHADOW_PAD > height) break;
+            g_array_append_val(out, entry);
+        }
+    }
+    return out;
+}
+
+static void release_texture(gpointer texture) {
+    if (texture) g_object_unref(texture);
+}
+
+// === Segmentos pre-compuestos ===
+
+// Leer ya los archivos del segmento que sigue a `segment`, que será el próximo en componerse
+static void prefetch_next_segment(ScrollStrip *self, int column, int segment) {
+    GArray *tiles = self->columns[column];
+    int next = (segment + 1) % self->segments_per_column;
+    double top = (double)next * STRIP_SEGMENT_HEIGHT;
+    double bottom = top + segment_height(self, next);
+
+    for (guint i = first_tile_below(tiles, top); i < tiles->len; i++) {
+        StripTile *tile = &g_array_index(tiles, StripTile, i);
+        if (tile->y > bottom) break;
+        // Los que empiezan antes cruzan el borde: su textura sigue en tile_textures (ver release_tile_textures)
+        if (tile->y >= top) {
+            prefetch_request(tile->path);
+        }
+    }
+}
+
+// Pide las texturas que le faltan al segmento (una vez por tile, ver scroll_strip_offer_texture).
+// TRUE si ya las tiene todas y se puede componer sin decodificar nada
+static gboolean request_segment(ScrollStrip *self, int column, int segment) {
+    GArray *tiles = segment_tiles(self, column, segment);
+    double distance = segment_distance(self, segment);
+    gboolean ready = TRUE;
+
+    for (guint i = 0; i < tiles->len; i++) {
+        const StripTile *tile = g_array_index(tiles, SegmentTile, i).tile;
+        if (g_hash_table_contains(self->tile_textures, tile->path)) continue;
+        if (g_hash_table_contains(self->requested, tile->path)) {
+            ready = FALSE;
+            continue;
+        }
+
+        int width = tile_device_width(self);
+        int height = tile_device_height(self, tile);
+        GdkTexture *texture = self->request(tile->path, width, height, distance);
+        if (texture) {
+            // Ya decodificada (p. ej. la primera pantalla de un cambio de colección)
+            g_hash_table_replace(self->tile_textures, g_strdup(tile->path), texture);
+            continue;
+        }
+        g_hash_table_replace(self->requested, g_strdup(tile->path), TILE_SIZE_KEY(width, height));
+        ready = FALSE;
+    }
+    g_array_free(tiles, TRUE);
+    return ready;
+}
+
+// Solo compone: todas las texturas del segmento ya llegaron (ver request_segment)
+static gboolean compose_segment(ScrollStrip *self, int column, int segment) {
+    GtkNative *native = gtk_widget_get_native(GTK_WIDGET(self));
+    GskRenderer *renderer = native ? gtk_native_get_renderer(native) : NULL;
+    if (!renderer) return FALSE;
+
+    double height = segment_height(self, segment);
+    double width = self->column_width + 2 * STRIP_SHADOW_PAD;
+
+    GtkSnapshot *snapshot = gtk_snapshot_new();
+    gtk_snapshot_scale(snapshot, self->scale, self->scale);
+    gtk_snapshot_push_clip(snapshot, &GRAPHENE_RECT_INIT(0, 0, width, height));
+    // Fondo opaco: la textura resultante se compone sin blending
+    gtk_snapshot_append_color(snapshot, &strip_background, &GRAPHENE_RECT_INIT(0, 0, width, height));
+
+    prefetch_next_segment(self, column, segment);
+
+    GArray *tiles = segment_tiles(self, column, segment);
+    for (guint i = 0; i < tiles->len; i++) {
+        SegmentTile *entry = &g_array_index(tiles, SegmentTile, i);
+        tile_render_append(snapshot, g_hash_table_lookup(self->tile_textures, entry->tile->path),
+                           &GRAPHENE_RECT_INIT(STRIP_SHADOW_PAD, entry->y, self->column_width, entry->tile->height),
+                           TILE_RENDER_CSS);
+    }
+    g_array_free(tiles, TRUE);
+
+    gtk_snapshot_pop(snapshot);
+    GskRenderNode *node = gtk_snapshot_free_to_node(snapshot);
+    GdkTexture *result = NULL;
+    if (node) {
+        result = gsk_renderer_render_texture(renderer, node,
+                                             &GRAPHENE_RECT_INIT(0, 0, ceil(width * self->scale), ceil(height * self->scale)));
+        gsk_render_node_unref(node);
+        if (result) {
+            ALLOC_STATS_TRACK(ALLOC_TEXTURES, result,
+                              (gsize)gdk_texture_get_width(result) * gdk_texture_get_height(result) * 4);
+        }
+    }
+    if (!result) return FALSE;
+
+    g_hash_table_insert(self->segments, SEGMENT_KEY(column, segment), result);
+    return TRUE;
+}
+
+// Segmentos visibles más `ahead` por debajo (el contenido sube al avanzar el scroll)
+static gboolean segment_within(ScrollStrip *self, int segment, int ahead) {
+    int n = self->segments_per_column;
+    if (n <= 2 + ahead) return TRUE;
+
+    double offset = fmod(scroll_offset(self), self->period);
+    int first = (int)(offset / STRIP_SEGMENT_HEIGHT);
+    int last = (int)((offset + gtk_widget_get_height(GTK_WIDGET(self))) / STRIP_SEGMENT_HEIGHT) + ahead;
+    int distance = ((segment - first) % n + n) % n;
+    return distance <= last - first;
+}
+
+// Los visibles más uno: se componen por adelantado
+static gboolean segment_wanted(ScrollStrip *self, int segment) {
+    return segment_within(self, segment, 1);
+}
+
+// Solo se conservan las texturas de tiles de segmentos aún sin componer, hasta uno más
+// allá de los que se quieren: así los tiles que cruzan el borde no se decodifican dos veces
+static void release_tile_textures(ScrollStrip *self) {
+    GHashTable *needed = g_hash_table_new(g_str_hash, g_str_equal);
+    for (int segment = 0; segment < self->segments_per_column; segment++) {
+        if (!segment_within(self, segment, 2)) continue;
+        for (int column = 0; column < self->num_columns; column++) {
+            if (!column_visible(self, column)) continue;
+            if (g_hash_table_contains(self->segments, SEGMENT_KEY(column, segment))) continue;
+            GArray *tiles = segment_tiles(self, column, segment);
+            for (guint i = 0; i < tiles->len; i++) {
+                g_hash_table_add(needed, g_array_index(tiles, SegmentTile, i).tile->path);
+            }
+            g_array_free(tiles, TRUE);
+        }
+    }
+    // El tile bajo el puntero espera su textura aunque su segmento ya esté compuesto
+    if (self->hover_index >= 0 && !self->hover_texture) {
+        g_hash_table_add(needed, g_array_index(self->columns[self->hover_column], StripTile, self->hover_index).path);
+    }
+
+    GHashTable *tables[] = { self->tile_textures, self->requested };
+    for (guint t = 0; t < G_N_ELEMENTS(tables); t++) {
+        GHashTableIter iter;
+        gpointer path;
+        g_hash_table_iter_init(&iter, tables[t]);
+        while (g_hash_table_iter_next(&iter, &path, NULL)) {
+            if (!g_hash_table_contains(needed, path)) g_hash_table_iter_remove(&iter);
+        }
+    }
+    g_hash_table_destroy(needed);
+}
+
+static gboolean prerender_step(gpointer user_data) {
+    ScrollStrip *self = WALLPIN_SCROLL_STRIP(user_data);
+
+    // Liberar lo que ya quedó atrás
+    GHashTableIter iter;
+    gpointer key;
+    g_hash_table_iter_init(&iter, self->segments);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+        if (!segment_wanted(self, GPOINTER_TO_UINT(key) & 0xffff)) {
+            g_hash_table_iter_remove(&iter);
+        }
+    }
+
+    // Componer como mucho un segmento por iteración para no bloquear frames; los que
+    // aún esperan texturas solo las piden y se saltan
+    for (int segment = 0; segment < self->segments_per_column; segment++) {
+        if (!segment_wanted(self, segment)) continue;
+        for (int column = 0; column < self->num_columns; column++) {
+            if (!column_visible(self, column)) continue;
+            if (g_hash_table_contains(self->segments, SEGMENT_KEY(column, segment))) continue;
+            if (!request_segment(self, column, segment)) continue;
+            if (!compose_segment(self, column, segment)) goto done;
+            return G_SOURCE_CONTINUE;
+        }
+    }
+
+done:
+    // Todo compuesto o esperando: scroll_strip_offer_texture lo vuelve a poner en marcha
+    release_tile_textures(self);
+    self->prerender_id = 0;
+    return G_SOURCE_REMOVE;
+}
+
+static void schedule_prerender(ScrollStrip *self) {
+    if (self->prerender_id == 0 && self->num_columns > 0 && gtk_widget_get_realized(GTK_WIDGET(self))) {
+        self->prerender_id = g_idle_add_full(G_PRIORITY_LOW, prerender_step, self, NULL);
+    }
+}
+
+// === Hover ===
+
+// Nada de decodificar en un evento del puntero: la textura que ya esté a mano o, si no,
+// se pide y el tile se eleva cuando llega (ver scroll_strip_offer_texture)
+static GdkTexture *hover_texture_for(ScrollStrip *self, const StripTile *tile) {
+    GdkTexture *texture = g_hash_table_lookup(self->tile_textures, tile->path);
+    if (texture) return g_object_ref(texture);
+    if (g_hash_table_contains(self->tile_textures, tile->path) ||
+        g_hash_table_contains(self->requested, tile->path)) {
+        return NULL;
+    }
+
+    int width = tile_device_width(self);
+    int height = tile_device_height(self, tile);
+    texture = self->request(tile->path, width, height, 0.0);
+    if (!texture) g_hash_table_replace(self->requested, g_strdup(tile->path), TILE_SIZE_KEY(width, height));
+    return texture;
+}
+
+static void update_hover(ScrollStrip *self) {
+    int column = -1, index = -1;
+    double base = 0.0;
+
+    if (self->pointer_inside && self->num_columns > 0 && self->period > 0) {
+        double rel = self->pointer_x - column_x(self, 0);
+        int c = (int)floor(rel / column_pitch(self));
+        if (c >= 0 && c < self->num_columns && rel - c * column_pitch(self) < self->column_width) {
+            double absolute = scroll_offset(self) + self->pointer_y;
+            base = floor(absolute / self->period) * self->period;
+            double y = absolute - base;
+
+            GArray *tiles = self->columns[c];
+            guint i = first_tile_below(tiles, y);
+            if (i < tiles->len && g_array_index(tiles, StripTile, i).y <= y) {
+                column = c;
+                index = (int)i;
+            }
+        }
+    }
+
+    if (column != self->hover_column || index != self->hover_index) {
+        self->hover_column = column;
+        self->hover_index = index;
+        g_clear_object(&self->hover_texture);
+        if (index >= 0) {
+            self->hover_texture = hover_texture_for(self, &g_array_index(self->columns[column], StripTile, index));
+        }
+        gtk_widget_queue_draw(GTK_WIDGET(self));
+    }
+    self->hover_base = base;
+}
+
+static void on_motion(GtkEventControllerMotion *controller, double x, double y, gpointer user_data) {
+    (void)controller;
+    ScrollStrip *self = WALLPIN_SCROLL_STRIP(user_data);
+    self->pointer_x = x;
+    self->pointer_y = y;
+    self->pointer_inside = TRUE;
+    update_hover(self);
+}
+
+static void on_leave(GtkEventControllerMotion *controller, gpointer user_data) {
+    (void)controller;
+    ScrollStrip *self = WALLPIN_SCROLL_STRIP(user_data);
+    self->pointer_inside = FALSE;
+    update_hover(self);
+}
+
+// === Widget ===
+
+static void on_value_changed(GtkAdjustment *adjustment, gpointer user_data) {
+    (void)adjustment;
+    ScrollStrip *self = WALLPIN_SCROLL_STRIP(user_data);
+
+    // Solo cambia el desplazamiento: nada de relayout ni de re-snapshot de tiles
+    gtk_widget_queue_draw(GTK_WIDGET(self));
+    if (self->pointer_inside) update_hover(self);
+    schedule_prerender(self);
+}
+
+static void update_adjustment(ScrollStrip *self) {
+    if (self->follower) return;   // Lo configura la franja que lleva el scroll
+    double page = gtk_widget_get_height(GTK_WIDGET(self));
+    gtk_adjustment_configure(self->adjustment,
+                             gtk_adjustment_get_value(self->adjustment),
+                             0.0, self->period + page, 1.0, page, page);
+}
+
+static void scroll_strip_snapshot(GtkWidget *widget, GtkSnapshot *snapshot) {
+    ScrollStrip *self = WALLPIN_SCROLL_STRIP(widget);
+    double width = gtk_widget_get_width(widget);
+    double height = gtk_widget_get_height(widget);
+
+    gtk_snapshot_append_color(snapshot, &strip_background, &GRAPHENE_RECT_INIT(0, 0, width, height));
+    if (self->num_columns == 0 || self->period <= 0) return;
+
+    double offset = scroll_offset(self);
+    double cycle = floor(offset / self->period);
+    int first_segment = (int)((offset - cycle * self->period) / STRIP_SEGMENT_HEIGHT);
+
+    for (int column = 0; column < self->num_columns; column++) {
+        if (!column_visible(self, column)) continue;
+        double x = column_x(self, column) - STRIP_SHADOW_PAD;
+        double segment_width = self->column_width + 2 * STRIP_SHADOW_PAD;
+        double c = cycle;
+        int segment = first_segment;
+
+        for (double top = c * self->period + (double)segment * STRIP_SEGMENT_HEIGHT - offset;
+             top < height;
+             top = c * self->period + (double)segment * STRIP_SEGMENT_HEIGHT - offset) {
+            // Sin componer todavía: se ve el fondo hasta que lleguen sus texturas
+            GdkTexture *texture = g_hash_table_lookup(self->segments, SEGMENT_KEY(column, segment));
+            if (texture) {
+                gtk_snapshot_append_texture(snapshot, texture,
+                                            &GRAPHENE_RECT_INIT(x, top, segment_width, segment_height(self, segment)));
+            }
+            if (++segment == self->segments_per_column) {
+                segment = 0;
+                c += 1.0;
+            }
+        }
+    }
+
+    // Tile bajo el puntero: se tapa la versión estática y se dibuja elevado, como :hover
+    if (self->hover_index >= 0 && self->hover_texture) {
+        StripTile *tile = &g_array_index(self->columns[self->hover_column], StripTile, self->hover_index);
+        double x = column_x(self, self->hover_column);
+        double y = self->hover_base + tile->y - offset;
+
+        gtk_snapshot_append_color(snapshot, &strip_background,
+                                  &GRAPHENE_RECT_INIT(x - STRIP_SHADOW_PAD, y - STRIP_SHADOW_PAD,
+                                                      self->column_width + 2 * STRIP_SHADOW_PAD,
+                                                      tile->height + 2 * STRIP_SHADOW_PAD));
+        tile_render_append(snapshot, self->hover_texture,
+                           &GRAPHENE_RECT_INIT(x, y - 4, self->column_width, tile->height),
+                           TILE_RENDER_CSS | TILE_RENDER_HOVER);
+    }
+}
+
+static void scroll_strip_size_allocate(GtkWidget *widget, int width, int height, int baseline) {
+    (void)width;
+    (void)height;
+    (void)baseline;
+    ScrollStrip *self = WALLPIN_SCROLL_STRIP(widget);
+    update_adjustment(self);
+    schedule_prerender(self);
+}
+
+static void clear_columns(ScrollStrip *self) {
+    for (int c = 0; c < self->num_columns; c++) {
+        GArray *tiles = self->columns[c];
+        for (guint i = 0; i < tiles->len; i++) {
+            g_free(g_array_index(tiles, StripTile, i).path);
+        }
+        g_array_free(tiles, TRUE);
+    }
+    g_clear_pointer(&self->columns, g_free);
+    self->num_columns = 0;
+}
+
+static void scroll_strip_dispose(GObject *object) {
+    ScrollStrip *self = WALLPIN_SCROLL_STRIP(object);
+
+    if (self->prerender_id) {
+        g_source_remove(self->prerender_id);
+        self->prerender_id = 0;
+    }
+    g_clear_pointer(&self->segments, g_hash_table_destroy);
+    g_clear_pointer(&self->tile_textures, g_hash_table_destroy);
+    g_clear_pointer(&self->requested, g_hash_table_destroy);
+    g_clear_object(&self->hover_texture);
+    if (self->adjustment) {
+        g_signal_handlers_disconnect_by_data(self->adjustment, self);
+        g_clear_object(&self->adjustment);
+    }
+    clear_columns(self);
+
+    G_OBJECT_CLASS(scroll_strip_parent_class)->dispose(object);
+}
+
+static void scroll_strip_class_init(ScrollStripClass *klass) {
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    GtkWidgetClass *widget_class = GTK_WIDGET_CLASS(klass);
+
+    object_class->dispose = scroll_strip_dispose;
+    widget_class->snapshot = scroll_strip_snapshot;
+    widget_class->size_allocate = scroll_strip_size_allocate;
+}
+
+static void scroll_strip_init(ScrollStrip *self) {
+    self->hover_column = -1;
+    self->hover_index = -1;
+    self->scale = 1.0;
+    self->segments = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_object_unref);
+    self->tile_textures = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, release_texture);
+    self->requested = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+    self->adjustment = g_object_ref_sink(gtk_adjustment_new(0.0, 0.0, 0.0, 1.0, 0.0, 0.0));
+    g_signal_connect(self->adjustment, "value-changed", G_CALLBACK(on_value_changed), self);
+
+    GtkEventController *motion = gtk_event_controller_motion_new();
+    g_signal_connect(motion, "motion", G_CALLBACK(on_motion), self);
+    g_signal_connect(motion, "leave", G_CALLBACK(on_leave), self);
+    gtk_widget_add_controller(GTK_WIDGET(self), motion);
+
+    gtk_widget_set_hexpand(GTK_WIDGET(self), TRUE);
+    gtk_widget_set_vexpand(GTK_WIDGET(self), TRUE);
+}
+
+GtkWidget *scroll_strip_new(ScrollStripRequestFunc request) {
+    ScrollStrip *self = g_object_new(WALLPIN_TYPE_SCROLL_STRIP, NULL);
+    self->request = request;
+    return GTK_WIDGET(self);
+}
+
+// Copia la colocación calculada por masonry_layout_calculate y descarta lo ya compuesto
+void scroll_strip_set_layout(ScrollStrip *self, const MasonryLayout *layout) {
+    g_hash_table_remove_all(self->segments);
+    g_hash_table_remove_all(self->tile_textures);
+    g_hash_table_remove_all(self->requested);
+    g_clear_object(&self->hover_texture);
+    clear_columns(self);
+    self->hover_column = -1;
+    self->hover_index = -1;
+
+    self->num_columns = MAX(layout->num_columns, 1);
+    self->column_width = layout->column_width;
+    self->scale = layout->scale;
+    self->columns = g_new(GArray *, self->num_columns);
+    for (int c = 0; c < self->num_columns; c++) {
+        self->columns[c] = g_array_new(FALSE, FALSE, sizeof(StripTile));
+    }
+
+    // layout->images va en orden de colocación, así que cada columna queda ordenada por y
+    for (GList *l = layout->images; l != NULL; l = l->next) {
+        ImageInfo *info = l->data;
+        StripTile tile = { g_strdup(info->path), info->y, info->target_height };
+        g_array_append_val(self->columns[CLAMP(info->column, 0, self->num_columns - 1)], tile);
+    }
+
+    // Columnas balanceadas: el periodo es el alto común más el hueco antes de repetir
+    self->period = layout->images ? layout->content_height + TILE_VERTICAL_GAP : 0;
+    self->segments_per_column = (int)ceil(self->period / STRIP_SEGMENT_HEIGHT);
+
+    g_print("🧱 Strip pre-compuesto: %d columnas × %d segmentos de %dpx (escala %.2f)\n",
+            self->num_columns, self->segments_per_column, STRIP_SEGMENT_HEIGHT, self->scale);
+
+    update_adjustment(self);
+    schedule_prerender(self);
+    gtk_widget_queue_draw(GTK_WIDGET(self));
+}
+
+GtkAdjustment *scroll_strip_get_adjustment(ScrollStrip *self) {
+    return self->adjustment;
+}
+
+void scroll_strip_replace_tile(ScrollStrip *self, const char *old_path, const char *new_path) {
+    for (int c = 0; c < self->num_columns; c++) {
+        GArray *tiles = self->columns[c];
+        for (guint i = 0; i < tiles->len; i++) {
+            StripTile *tile = &g_array_index(tiles, StripTile, i);
+            if (!g_str_equal(tile->path, old_path)) continue;
+
+            g_hash_table_remove(self->tile_textures, tile->path);
+            g_hash_table_remove(self->requested, tile->path);
+            g_free(tile->path);
+            tile->path = g_strdup(new_path);
+
+            int first = (int)(tile->y / STRIP_SEGMENT_HEIGHT);
+            int last = (int)((tile->y + tile->height + STRIP_SHADOW_PAD) / STRIP_SEGMENT_HEIGHT);
+            for (int segment = MAX(first - 1, 0); segment <= last; segment++) {
+                g_hash_table_remove(self->segments, SEGMENT_KEY(c, segment % MAX(self->segments_per_column, 1)));
+            }
+
+            if (self->hover_column == c && self->hover_index == (int)i) {
+                self->hover_column = -1;
+                self->hover_index = -1;
+                update_hover(self);
+            }
+            schedule_prerender(self);
+            gtk_widget_queue_draw(GTK_WIDGET(self));
+            return;
+        }
+    }
+}
+
+void scroll_strip_offer_texture(ScrollStrip *self, const char *path, GdkTexture *texture) {
+    gpointer size = g_hash_table_lookup(self->requested, path);
+    if (!size) return;   // No la pidió esta franja, o ya no le hace falta
+
+    // Un relayout pudo cambiar el tamaño mientras se decodificaba: la próxima pasada la vuelve a pedir
+    if (texture && TILE_SIZE_KEY(gdk_texture_get_width(texture), gdk_texture_get_height(texture)) != size) {
+        g_hash_table_remove(self->requested, path);
+        schedule_prerender(self);
+        return;
+    }
+
+    g_hash_table_remove(self->requested, path);
+    g_hash_table_replace(self->tile_textures, g_strdup(path), texture ? g_object_ref(texture) : NULL);
+
+    if (texture && self->hover_index >= 0 && !self->hover_texture &&
+        g_str_equal(g_array_index(self->columns[self->hover_column], StripTile, self->hover_index).path, path)) {
+        self->hover_texture = g_object_ref(texture);
+        gtk_widget_queue_draw(GTK_WIDGET(self));
+    }
+    schedule_prerender(self);
+}
+
+void scroll_strip_set_canvas(ScrollStrip *self, int canvas_width, int offset_x, int offset_y) {
+    if (self->canvas_width == canvas_width && self->offset_x == offset_x && self->offset_y == offset_y) return;
+
+    self->canvas_width = MAX(canvas_width, 0);
+    self->offset_x = offset_x;
+    self->offset_y = offset_y;
+    g_hash_table_remove_all(self->segments);   // Otras columnas a la vista
+    schedule_prerender(self);
+    gtk_widget_queue_draw(GTK_WIDGET(self));
+}
+
+void scroll_strip_follow(ScrollStrip *self, ScrollStrip *leader) {
+    g_signal_handlers_disconnect_by_data(self->adjustment, self);
+    g_object_unref(self->adjustment);
+
+    self->adjustment = g_object_ref(leader->adjustment);
+    self->follower = TRUE;
+    g_signal_connect(self->adjustment, "value-changed", G_CALLBACK(on_value_changed), self);
+}
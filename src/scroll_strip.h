@@ -0,0 +1,40 @@
+#ifndef SCROLL_STRIP_H
+#define SCROLL_STRIP_H
+
+#include <gtk/gtk.h>
+#include "layout.h"
+
+// Modo de bajo consumo: cada columna se compone una sola vez (bordes redondeados y
+// sombras incluidos) en texturas offscreen de STRIP_SEGMENT_HEIGHT de alto, y cada
+// frame solo las desplaza. Solo el tile bajo el puntero se dibuja "en vivo".
+// Aquí no se decodifica nada: las texturas de los tiles se piden y un segmento se
+// compone cuando han llegado todas las suyas; hasta entonces se ve el fondo.
+#define STRIP_SEGMENT_HEIGHT 1024     // Alto lógico de cada segmento pre-compuesto
+#define STRIP_SHADOW_PAD 12           // Margen lateral del segmento para que quepa la sombra
+
+#define WALLPIN_TYPE_SCROLL_STRIP (scroll_strip_get_type())
+G_DECLARE_FINAL_TYPE(ScrollStrip, scroll_strip, WALLPIN, SCROLL_STRIP, GtkWidget)
+
+// Pide la textura de path al tamaño exacto en píxeles de dispositivo; distance son los
+// píxeles lógicos que faltan para que se vea (0 = ya visible). Si ya hay una decodificada
+// de ese tamaño la devuelve (referencia nueva); si no, NULL y llegará por scroll_strip_offer_texture
+typedef GdkTexture *(*ScrollStripRequestFunc)(const char *path, int device_width, int device_height, double distance);
+
+GtkWidget *scroll_strip_new(ScrollStripRequestFunc request);
+void scroll_strip_set_layout(ScrollStrip *strip, const MasonryLayout *layout);
+// value = desplazamiento; el rango útil es [0, periodo), con upper - page_size = periodo
+GtkAdjustment *scroll_strip_get_adjustment(ScrollStrip *strip);
+// Otra imagen en el hueco de old_path (modo --sample): solo se recomponen sus segmentos
+void scroll_strip_replace_tile(ScrollStrip *strip, const char *old_path, const char *new_path);
+// Entrega de lo pedido (texture NULL = no se pudo decodificar: el tile queda vacío).
+// Lo que la franja no pidió se ignora
+void scroll_strip_offer_texture(ScrollStrip *strip, const char *path, GdkTexture *texture);
+
+// Lienzo continuo entre monitores (--span): todas las franjas reciben el mismo layout,
+// calculado para canvas_width, y cada una muestra el trozo cuya esquina superior
+// izquierda es (offset_x, offset_y). Solo se componen las columnas que caen en él
+void scroll_strip_set_canvas(ScrollStrip *strip, int canvas_width, int offset_x, int offset_y);
+// Usa el adjustment de leader en vez del propio: un solo reloj de scroll para todas
+void scroll_strip_follow(ScrollStrip *strip, ScrollStrip *leader);
+
+#endif // SCROLL_STRIP_H
@@ -0,0 +1,38 @@
+#include "shard.h"
+#include <stdlib.h>
+
+gboolean shard_parse(const char *spec, Shard *out) {
+    if (!spec) return FALSE;
+
+    char *end = NULL;
+    long index = strtol(spec, &end, 10);
+    if (end == spec || *end != '/') return FALSE;
+
+    const char *count_start = end + 1;
+    long count = strtol(count_start, &end, 10);
+    if (end == count_start || *end != '\0') return FALSE;
+    if (count < 1 || count > 64 || index < 0 || index >= count) return FALSE;
+
+    out->index = (int)index;
+    out->count = (int)count;
+    return TRUE;
+}
+
+// FNV-1a de 64 bits con mezcla final: nombres casi iguales (img001, img002...) no
+// deben caer en fragmentos correlacionados
+static guint64 path_hash(const char *path) {
+    guint64 hash = 0xcbf29ce484222325ULL;
+    for (const guchar *p = (const guchar *)path; *p; p++) {
+        hash ^= *p;
+        hash *= 0x100000001b3ULL;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+gboolean shard_owns(Shard shard, const char *path) {
+    if (shard.count <= 1) return TRUE;
+    return (int)(path_hash(path) % (guint64)shard.count) == shard.index;
+}
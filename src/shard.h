@@ -0,0 +1,22 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <glib.h>
+
+// Reparto de la colección entre monitores (--shard i/n): cada instancia se queda solo
+// con las rutas cuyo hash cae en su fragmento. Depende solo de la ruta, así que todas
+// las instancias coinciden sin hablarse y sin importar el orden en que llegue el escaneo;
+// y como el hash no tiene relación con el formato ni con el color, cada fragmento recibe
+// en promedio la misma mezcla de proporciones y grupos de color que la colección entera.
+typedef struct {
+    int index;    // 0..count-1
+    int count;    // 1 = sin reparto
+} Shard;
+
+#define SHARD_NONE ((Shard){ 0, 1 })
+
+// Acepta "i/n" con 0 <= i < n
+gboolean shard_parse(const char *spec, Shard *out);
+gboolean shard_owns(Shard shard, const char *path);
+
+#endif // SHARD_H
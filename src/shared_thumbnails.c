@@ -0,0 +1,297 @@
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include "shared_thumbnails.h"
+#include "trace.h"
+
+typedef struct {
+    const char *dir;
+    int size;                  // Lado máximo de la miniatura
+} ThumbnailClass;
+
+static const ThumbnailClass thumbnail_classes[] = {
+    { "normal", 128 },
+    { "large", 256 },
+    { "x-large", 512 },
+    { "xx-large", 1024 },
+};
+
+typedef struct {
+    char *path;
+    GdkPixbuf *pixbuf;
+    int source_width;
+    int source_height;
+} StoreJob;
+
+static struct {
+    gboolean disabled;
+    GMutex lock;
+    GThreadPool *writer;
+    guint reserved;            // Huecos de la cola apartados por decodes aún en curso
+    GHashTable *known;         // Rutas con miniatura válida ya vista
+    guint hits, misses, written;
+} shared;
+
+void shared_thumbnails_set_enabled(gboolean enabled) {
+    shared.disabled = !enabled;
+}
+
+gboolean shared_thumbnails_enabled(void) {
+    return !shared.disabled;
+}
+
+// URI del estándar: ruta absoluta, sin resolver enlaces
+static char *thumbnail_uri(const char *path) {
+    char *absolute = g_canonicalize_filename(path, NULL);
+    char *uri = g_filename_to_uri(absolute, NULL, NULL);
+    g_free(absolute);
+    return uri;
+}
+
+static char *thumbnail_file(const ThumbnailClass *class, const char *uri) {
+    char *md5 = g_compute_checksum_for_string(G_CHECKSUM_MD5, uri, -1);
+    char *name = g_strconcat(md5, ".png", NULL);
+    char *file = g_build_filename(g_get_user_cache_dir(), "thumbnails", class->dir, name, NULL);
+    g_free(name);
+    g_free(md5);
+    return file;
+}
+
+static gboolean read_mtime(const char *path, gint64 *mtime) {
+    GStatBuf st;
+    if (g_stat(path, &st) != 0) return FALSE;
+    *mtime = (gint64)st.st_mtime;
+    return TRUE;
+}
+
+static int option_int(GdkPixbuf *pixbuf, const char *key) {
+    const char *value = gdk_pixbuf_get_option(pixbuf, key);
+    return value ? atoi(value) : 0;
+}
+
+// Dimensiones del original: las del PNG si las trae, si no la cabecera del archivo.
+// Los gestores de archivos orientan la miniatura según EXIF; la cabecera no, así que se
+// giran si la proporción no coincide
+static gboolean source_size(GdkPixbuf *thumbnail, const char *path, int *width, int *height) {
+    *width = option_int(thumbnail, "tEXt::Thumb::Image::Width");
+    *height = option_int(thumbnail, "tEXt::Thumb::Image::Height");
+    if ((*width <= 0 || *height <= 0) && !gdk_pixbuf_get_file_info(path, width, height)) return FALSE;
+    if (*width <= 0 || *height <= 0) return FALSE;
+
+    int thumb_width = gdk_pixbuf_get_width(thumbnail);
+    int thumb_height = gdk_pixbuf_get_height(thumbnail);
+    if ((gint64)(thumb_width - thumb_height) * (*width - *height) < 0) {
+        int swap = *width;
+        *width = *height;
+        *height = swap;
+    }
+    return TRUE;
+}
+
+GdkPixbuf *shared_thumbnail_lookup(const char *path, int min_width, int min_height,
+                                   int *source_width, int *source_height) {
+    if (shared.disabled || !path) return NULL;
+
+    gint64 mtime;
+    char *uri = read_mtime(path, &mtime) ? thumbnail_uri(path) : NULL;
+    if (!uri) return NULL;
+
+    TRACE_BEGIN(lookup_start);
+    char *expected_mtime = g_strdup_printf("%" G_GINT64_FORMAT, mtime);
+    GdkPixbuf *found = NULL;
+    int width = 0, height = 0;
+
+    // De la clase más pequeña que puede bastar hacia arriba
+    for (guint i = 0; !found && i < G_N_ELEMENTS(thumbnail_classes); i++) {
+        const ThumbnailClass *class = &thumbnail_classes[i];
+        if (i + 1 < G_N_ELEMENTS(thumbnail_classes) && class->size < MAX(min_width, min_height)) continue;
+
+        char *file = thumbnail_file(class, uri);
+        GdkPixbuf *thumbnail = g_file_test(file, G_FILE_TEST_IS_REGULAR) ? gdk_pixbuf_new_from_file(file, NULL) : NULL;
+        g_free(file);
+        if (!thumbnail) continue;
+
+        // Miniatura de otro archivo (colisión) o de una versión anterior de este
+        if (g_strcmp0(gdk_pixbuf_get_option(thumbnail, "tEXt::Thumb::URI"), uri) != 0 ||
+            g_strcmp0(gdk_pixbuf_get_option(thumbnail, "tEXt::Thumb::MTime"), expected_mtime) != 0 ||
+            !source_size(thumbnail, path, &width, &height)) {
+            g_object_unref(thumbnail);
+            continue;
+        }
+
+        int thumb_width = gdk_pixbuf_get_width(thumbnail);
+        int thumb_height = gdk_pixbuf_get_height(thumbnail);
+        if ((thumb_width >= min_width || thumb_width >= width) && (thumb_height >= min_height || thumb_height >= height)) {
+            found = thumbnail;
+        } else {
+            g_object_unref(thumbnail);
+        }
+    }
+    TRACE_END(lookup_start, "shared_thumbnail", path);
+
+    g_mutex_lock(&shared.lock);
+    if (found) {
+        shared.hits++;
+        if (!shared.known) shared.known = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+        g_hash_table_add(shared.known, g_strdup(path));
+    } else {
+        shared.misses++;
+    }
+    g_mutex_unlock(&shared.lock);
+
+    if (found) {
+        if (source_width) *source_width = width;
+        if (source_height) *source_height = height;
+    }
+    g_free(expected_mtime);
+    g_free(uri);
+    return found;
+}
+
+gboolean shared_thumbnail_known(const char *path) {
+    g_mutex_lock(&shared.lock);
+    gboolean known = shared.known && g_hash_table_contains(shared.known, path);
+    g_mutex_unlock(&shared.lock);
+    return known;
+}
+
+// Como pide el estándar: a un temporal en el mismo directorio (0600) y rename, para
+// que ningún lector vea un PNG a medias
+static gboolean write_thumbnail(GdkPixbuf *pixbuf, const char *file, const char *uri, gint64 mtime,
+                                int source_width, int source_height) {
+    char *dir = g_path_get_dirname(file);
+    gboolean ok = g_mkdir_with_parents(dir, 0700) == 0;
+    g_free(dir);
+    if (!ok) return FALSE;
+
+    char *temp = g_strconcat(file, ".XXXXXX", NULL);
+    int fd = g_mkstemp_full(temp, O_WRONLY, 0600);
+    if (fd < 0) {
+        g_free(temp);
+        return FALSE;
+    }
+    close(fd);
+
+    char *mtime_text = g_strdup_printf("%" G_GINT64_FORMAT, mtime);
+    char *width_text = g_strdup_printf("%d", source_width);
+    char *height_text = g_strdup_printf("%d", source_height);
+    ok = gdk_pixbuf_save(pixbuf, temp, "png", NULL,
+                         "tEXt::Thumb::URI", uri,
+                         "tEXt::Thumb::MTime", mtime_text,
+                         "tEXt::Thumb::Image::Width", width_text,
+                         "tEXt::Thumb::Image::Height", height_text,
+                         "tEXt::Software", "WallPin",
+                         NULL) &&
+         g_rename(temp, file) == 0;
+    if (!ok) g_unlink(temp);
+
+    g_free(height_text);
+    g_free(width_text);
+    g_free(mtime_text);
+    g_free(temp);
+    return ok;
+}
+
+static void store_worker(gpointer data, G_GNUC_UNUSED gpointer user_data) {
+    StoreJob *job = data;
+    trace_set_thread_name("thumbnails");
+
+    gint64 mtime;
+    char *uri = read_mtime(job->path, &mtime) ? thumbnail_uri(job->path) : NULL;
+    int width = gdk_pixbuf_get_width(job->pixbuf);
+    int height = gdk_pixbuf_get_height(job->pixbuf);
+    int longest = MAX(width, height);
+
+    for (guint i = 0; uri && i < G_N_ELEMENTS(thumbnail_classes); i++) {
+        const ThumbnailClass *class = &thumbnail_classes[i];
+        // Nunca mayor que el original, y sin ampliar lo que se decodificó
+        int target = MIN(class->size, MAX(job->source_width, job->source_height));
+        if (longest < target) continue;
+
+        char *file = thumbnail_file(class, uri);
+        gint64 existing;
+        if (read_mtime(file, &existing) && existing >= mtime) {
+            g_free(file);   // Ya está (de otra app o de un arranque anterior)
+            continue;
+        }
+
+        TRACE_BEGIN(write_start);
+        double scale = (double)target / longest;
+        int scaled_width = MAX(1, (int)(width * scale + 0.5));
+        int scaled_height = MAX(1, (int)(height * scale + 0.5));
+        GdkPixbuf *scaled = scaled_width == width && scaled_height == height
+            ? g_object_ref(job->pixbuf)
+            : gdk_pixbuf_scale_simple(job->pixbuf, scaled_width, scaled_height, GDK_INTERP_BILINEAR);
+        if (write_thumbnail(scaled, file, uri, mtime, job->source_width, job->source_height)) {
+            g_mutex_lock(&shared.lock);
+            shared.written++;
+            g_mutex_unlock(&shared.lock);
+        }
+        g_object_unref(scaled);
+        TRACE_END(write_start, "thumbnail_write", job->path);
+        g_free(file);
+    }
+
+    g_free(uri);
+    g_object_unref(job->pixbuf);
+    g_free(job->path);
+    g_free(job);
+}
+
+gboolean shared_thumbnail_reserve(const char *path) {
+    if (shared.disabled || !path) return FALSE;
+
+    // Lo que ya vive dentro de la caché de miniaturas no se vuelve a miniaturizar
+    char *absolute = g_canonicalize_filename(path, NULL);
+    char *root = g_build_filename(g_get_user_cache_dir(), "thumbnails", NULL);
+    gboolean inside = g_str_has_prefix(absolute, root);
+    g_free(root);
+    g_free(absolute);
+    if (inside) return FALSE;
+
+    g_mutex_lock(&shared.lock);
+    if (!shared.writer) {
+        shared.writer = g_thread_pool_new(store_worker, NULL, 1, FALSE, NULL);
+    }
+    // Lo apartado cuenta como encolado: con la cola llena nadie decodifica a tamaño x-large
+    gboolean reserved = g_thread_pool_unprocessed(shared.writer) + shared.reserved < SHARED_THUMBNAIL_WRITE_QUEUE;
+    if (reserved) shared.reserved++;
+    g_mutex_unlock(&shared.lock);
+    return reserved;
+}
+
+void shared_thumbnail_release(void) {
+    g_mutex_lock(&shared.lock);
+    if (shared.reserved > 0) shared.reserved--;
+    g_mutex_unlock(&shared.lock);
+}
+
+void shared_thumbnail_store(const char *path, GdkPixbuf *pixbuf, int source_width, int source_height) {
+    g_mutex_lock(&shared.lock);
+    if (shared.reserved > 0) shared.reserved--;
+    if (shared.writer && path && pixbuf && source_width > 0 && source_height > 0) {
+        StoreJob *job = g_new(StoreJob, 1);
+        job->path = g_strdup(path);
+        job->pixbuf = g_object_ref(pixbuf);
+        job->source_width = source_width;
+        job->source_height = source_height;
+        g_thread_pool_push(shared.writer, job, NULL);
+    }
+    g_mutex_unlock(&shared.lock);
+}
+
+void shared_thumbnails_shutdown(void) {
+    g_mutex_lock(&shared.lock);
+    GThreadPool *writer = g_steal_pointer(&shared.writer);
+    g_mutex_unlock(&shared.lock);
+    if (writer) g_thread_pool_free(writer, FALSE, TRUE);
+
+    if (shared.hits + shared.misses + shared.written > 0) {
+        g_print("🗂️  Miniaturas compartidas: %u usadas, %u sin miniatura válida, %u escritas\n",
+                shared.hits, shared.misses, shared.written);
+    }
+    g_clear_pointer(&shared.known, g_hash_table_destroy);
+    shared.hits = shared.misses = shared.written = 0;
+    shared.reserved = 0;
+}
@@ -0,0 +1,41 @@
+#ifndef SHARED_THUMBNAILS_H
+#define SHARED_THUMBNAILS_H
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+// Miniaturas compartidas del estándar freedesktop (~/.cache/thumbnails/{normal,large,
+// x-large,xx-large}/<md5 de la URI>.png), las mismas que generan los gestores de
+// archivos. Una miniatura vale si su Thumb::URI es la del archivo y su Thumb::MTime
+// coincide con el mtime actual. Si cubre el tamaño pedido, la ingesta y los tiles salen
+// de ella sin abrir el original; lo que sí se decodifica se escribe de vuelta (en un
+// hilo aparte, con escritura atómica) para el siguiente arranque y para otras apps.
+#define SHARED_THUMBNAIL_STORE_SIZE 512     // x-large: con esta la ingesta del próximo arranque ya no decodifica
+#define SHARED_THUMBNAIL_WRITE_QUEUE 32     // Escrituras pendientes como mucho; el resto se omite
+
+// Antes de la primera ingesta. Desactivado = ni se leen ni se escriben
+void shared_thumbnails_set_enabled(gboolean enabled);
+gboolean shared_thumbnails_enabled(void);
+
+// Miniatura válida, ya orientada, que cubre min_width × min_height (o que es la imagen
+// entera, si el original es más pequeño); referencia nueva o NULL. source_width/height
+// (opcionales): dimensiones del original, orientadas como la miniatura
+GdkPixbuf *shared_thumbnail_lookup(const char *path, int min_width, int min_height,
+                                   int *source_width, int *source_height);
+// TRUE si path ya tuvo una miniatura compartida válida: su primer decode no lee el archivo
+gboolean shared_thumbnail_known(const char *path);
+
+// Aparta un hueco en la cola de escritura antes de decodificar para escribir; FALSE si
+// está llena (o path no se escribe), y entonces no merece la pena decodificar a más
+// tamaño. Cada TRUE se cierra con shared_thumbnail_store o shared_thumbnail_release
+gboolean shared_thumbnail_reserve(const char *path);
+void shared_thumbnail_release(void);
+
+// Encola, en el hueco apartado, la escritura en segundo plano de las miniaturas del
+// estándar que pixbuf (la imagen entera, orientada) llega a cubrir sin ampliar y que aún
+// no existen
+void shared_thumbnail_store(const char *path, GdkPixbuf *pixbuf, int source_width, int source_height);
+
+// Espera a las escrituras pendientes
+void shared_thumbnails_shutdown(void);
+
+#endif // SHARED_THUMBNAILS_H
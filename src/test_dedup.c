@@ -0,0 +1,73 @@
+// WallPin - Regresiones de la deduplicación por hash perceptual (sin display ni disco)
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <stdio.h>
+#include "phash.h"
+
+// Imagen sintética de 256x256: degradado vertical de top a bottom y, si textured, bloques
+// de 32 px de luminancia variable (más brightness) para el control positivo
+static GdkPixbuf *dedup_case(const guchar top[3], const guchar bottom[3], gboolean textured, int brightness) {
+    GdkPixbuf *pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, 256, 256);
+    int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
+    guchar *pixels = gdk_pixbuf_get_pixels(pixbuf);
+    for (int y = 0; y < 256; y++) {
+        for (int x = 0; x < 256; x++) {
+            int block = textured ? ((x / 32) * 37 + (y / 32) * 91) % 160 - 80 : 0;
+            for (int c = 0; c < 3; c++) {
+                int v = top[c] + (bottom[c] - top[c]) * y / 255 + block + brightness;
+                pixels[(gsize)y * rowstride + x * 3 + c] = CLAMP(v, 0, 255);
+            }
+        }
+    }
+    return pixbuf;
+}
+
+// Regresión de la deduplicación: fondos lisos y degradados verticales distintos no son
+// duplicados entre sí (el dHash horizontal les da a todos el mismo hash), y una imagen
+// con detalle sigue emparejándose con su copia un poco más clara. FALSE si algo falla
+static gboolean check_dedup_regressions(void) {
+    static const guchar flat_cases[][2][3] = {
+        { {   0,   0,   0 }, {   0,   0,   0 } },   // Negro liso
+        { { 255, 255, 255 }, { 255, 255, 255 } },   // Blanco liso
+        { {  40,  60, 120 }, {  40,  60, 120 } },   // Azul liso
+        { { 200,  80,  40 }, { 200,  80,  40 } },   // Naranja liso
+        { {  10,  20,  60 }, { 240, 150,  90 } },   // Atardecer
+        { { 255, 255, 255 }, {   0,   0,   0 } },   // Blanco a negro
+        { {  30, 120,  60 }, {  30,  40, 160 } },   // Verde a azul
+    };
+    gboolean ok = TRUE;
+    PHashIndex *index = phash_index_new(PHASH_DUPLICATE_DISTANCE);
+
+    for (guint i = 0; i < G_N_ELEMENTS(flat_cases); i++) {
+        GdkPixbuf *pixbuf = dedup_case(flat_cases[i][0], flat_cases[i][1], FALSE, 0);
+        PHash hash = phash_compute_pixbuf(pixbuf);
+        g_object_unref(pixbuf);
+
+        char name[32];
+        snprintf(name, sizeof(name), "liso/degradado %u", i);
+        const char *match = phash_index_find(index, hash);
+        if (match) {
+            g_printerr("❌ Dedup: %s tomado por duplicado de %s\n", name, match);
+            ok = FALSE;
+        }
+        phash_index_add(index, name, hash);
+    }
+    phash_index_free(index);
+
+    const guchar gray[3] = { 128, 128, 128 };
+    GdkPixbuf *original = dedup_case(gray, gray, TRUE, 0);
+    GdkPixbuf *brighter = dedup_case(gray, gray, TRUE, 6);
+    if (!phash_is_duplicate(phash_compute_pixbuf(original), phash_compute_pixbuf(brighter))) {
+        g_printerr("❌ Dedup: una imagen con detalle ya no se empareja con su copia más clara\n");
+        ok = FALSE;
+    }
+    g_object_unref(original);
+    g_object_unref(brighter);
+    return ok;
+}
+
+int main(void) {
+    if (!check_dedup_regressions()) return 1;
+    g_print("✅ Dedup: sin regresiones\n");
+    return 0;
+}
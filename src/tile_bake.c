@@ -0,0 +1,217 @@
+#include <math.h>
+#include <string.h>
+#include "tile_bake.h"
+
+#define CORNER_SUBSAMPLES 4            // Muestras por eje para el antialiasing de las esquinas
+#define SHADOW_BOX_PASSES 3            // Tres cajas seguidas ≈ gaussiana
+
+int tile_bake_padding(double scale) {
+    return (int)round(TILE_BAKE_PADDING * scale);
+}
+
+// Cobertura (0-255) de la esquina superior izquierda, size × size píxeles, de un
+// cuarto de círculo de radio radius. Se espeja para las otras tres esquinas
+static guint8 *corner_coverage(double radius, int size) {
+    const int samples = CORNER_SUBSAMPLES * CORNER_SUBSAMPLES;
+    guint8 *table = g_malloc((gsize)MAX(size, 1) * MAX(size, 1));
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int inside = 0;
+            for (int sy = 0; sy < CORNER_SUBSAMPLES; sy++) {
+                double dy = radius - (y + (sy + 0.5) / CORNER_SUBSAMPLES);
+                for (int sx = 0; sx < CORNER_SUBSAMPLES; sx++) {
+                    double dx = radius - (x + (sx + 0.5) / CORNER_SUBSAMPLES);
+                    if (dx <= 0 || dy <= 0 || dx * dx + dy * dy <= radius * radius) inside++;
+                }
+            }
+            table[y * size + x] = (guint8)((inside * 255 + samples / 2) / samples);
+        }
+    }
+    return table;
+}
+
+// Fila y de la máscara de un rectángulo redondeado de width × height
+static void rounded_row(guint8 *row, int y, int width, int height, const guint8 *corner, int size) {
+    memset(row, 255, width);
+    int cy = y < size ? y : height - 1 - y;
+    if (cy >= size) return;
+
+    const guint8 *coverage = corner + cy * size;
+    for (int x = 0; x < size; x++) {
+        row[x] = coverage[x];
+        row[width - 1 - x] = coverage[x];
+    }
+}
+
+// Media móvil de 2·radius + 1 muestras (fuera del buffer cuenta como 0) sobre count
+// líneas de length muestras; step separa muestras y line_step líneas
+static void box_blur(const guint8 *src, guint8 *dst, int length, int step, int count, int line_step,
+                     int radius) {
+    int window = 2 * radius + 1;
+    for (int line = 0; line < count; line++) {
+        const guint8 *in = src + (gsize)line * line_step;
+        guint8 *out = dst + (gsize)line * line_step;
+        int sum = 0;
+        for (int i = 0; i < MIN(radius, length); i++) sum += in[(gsize)i * step];
+        for (int i = 0; i < length; i++) {
+            if (i + radius < length) sum += in[(gsize)(i + radius) * step];
+            if (i - radius - 1 >= 0) sum -= in[(gsize)(i - radius - 1) * step];
+            out[(gsize)i * step] = (guint8)((sum + window / 2) / window);
+        }
+    }
+}
+
+// Alfa de la sombra en todo el tile horneado: la silueta del tile desplazada y
+// difuminada con sigma = blur / 2, igual que el blur radius del box-shadow del CSS
+static guint8 *shadow_mask(int width, int height, int cover_width, int cover_height, int pad,
+                           const guint8 *corner, int size, double scale) {
+    gsize n = (gsize)width * height;
+    guint8 *mask = g_malloc0(n);
+    guint8 *scratch = g_malloc(n);
+
+    int offset = (int)round(TILE_BAKE_SHADOW_OFFSET * scale);
+    for (int y = 0; y < cover_height && pad + offset + y < height; y++) {
+        rounded_row(mask + (gsize)(pad + offset + y) * width + pad, y, cover_width, cover_height, corner, size);
+    }
+
+    double sigma = TILE_BAKE_SHADOW_BLUR * scale / 2.0;
+    int radius = MAX(1, (int)round((sqrt(12.0 * sigma * sigma / SHADOW_BOX_PASSES + 1.0) - 1.0) / 2.0));
+    for (int pass = 0; pass < SHADOW_BOX_PASSES; pass++) {
+        box_blur(mask, scratch, width, 1, height, width, radius);
+        box_blur(scratch, mask, height, width, width, 1, radius);
+    }
+
+    g_free(scratch);
+    return mask;
+}
+
+// alpha = a + s·(1 - a), con a la cobertura de la imagen y s la de la sombra. Filas
+// contiguas, solo aritmética entera y sin ramas: con -O2 -ftree-vectorize (ver el
+// Makefile) el compilador lo vectoriza; las divisiones entre 255 son por constante
+static void composite_alpha(const guint8 *restrict cover, const guint8 *restrict shadow,
+                            guint8 *restrict alpha, int length) {
+    for (int x = 0; x < length; x++) {
+        unsigned a = cover[x];
+        unsigned s = (shadow[x] * TILE_BAKE_SHADOW_ALPHA + 127) / 255;
+        alpha[x] = (guint8)(a + (s * (255 - a) + 127) / 255);
+    }
+}
+
+// recip[v] = ⌈65536 / v⌉: a / alpha en 16.16 con una multiplicación en vez de una
+// división por pixel. Como a ≤ alpha, a · recip[alpha] ≤ 65536 + alpha y, con a == alpha,
+// (in · a · recip[alpha]) >> 16 es exactamente in
+static const guint32 *reciprocal_table(void) {
+    static guint32 recip[256];
+    static gsize ready = 0;
+
+    if (g_once_init_enter(&ready)) {
+        recip[0] = 0;   // alpha 0 solo con a 0: queda negro
+        for (guint32 v = 1; v < 256; v++) recip[v] = (65536 + v - 1) / v;
+        g_once_init_leave(&ready, 1);
+    }
+    return recip;
+}
+
+// Borde antialiasado de la imagen: el color se reparte entre imagen y sombra (negra),
+// in · a / alpha, sin ramas ni divisiones
+static void composite_color(const guchar *restrict in, int channels, const guint8 *restrict coverage,
+                            const guint8 *restrict alpha, const guint32 *restrict recip,
+                            guchar *restrict out, int length) {
+    for (int x = 0; x < length; x++) {
+        guint32 ratio = coverage[x] * recip[alpha[x]];
+        out[x * 4 + 0] = (guchar)((in[x * channels + 0] * ratio) >> 16);
+        out[x * 4 + 1] = (guchar)((in[x * channels + 1] * ratio) >> 16);
+        out[x * 4 + 2] = (guchar)((in[x * channels + 2] * ratio) >> 16);
+        out[x * 4 + 3] = alpha[x];
+    }
+}
+
+// Cobertura completa: alpha también lo es y el color se copia tal cual
+static void copy_opaque(const guchar *restrict in, int channels, guchar *restrict out, int length) {
+    for (int x = 0; x < length; x++) {
+        out[x * 4 + 0] = in[x * channels + 0];
+        out[x * 4 + 1] = in[x * channels + 1];
+        out[x * 4 + 2] = in[x * channels + 2];
+        out[x * 4 + 3] = 255;
+    }
+}
+
+// Fuera de la imagen solo queda la sombra
+static void shadow_only(const guint8 *restrict alpha, guchar *restrict out, int length) {
+    for (int x = 0; x < length; x++) {
+        out[x * 4 + 0] = out[x * 4 + 1] = out[x * 4 + 2] = 0;
+        out[x * 4 + 3] = alpha[x];
+    }
+}
+
+GdkPixbuf *tile_bake(GdkPixbuf *cover, double scale) {
+    int cover_width = gdk_pixbuf_get_width(cover);
+    int cover_height = gdk_pixbuf_get_height(cover);
+    int pad = tile_bake_padding(scale);
+    int width = cover_width + 2 * pad;
+    int height = cover_height + 2 * pad;
+
+    GdkPixbuf *baked = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, width, height);
+    if (!baked) return NULL;
+
+    double radius = MIN(TILE_CORNER_RADIUS * scale, MIN(cover_width, cover_height) / 2.0);
+    int size = (int)ceil(radius);
+    guint8 *corner = corner_coverage(radius, size);
+    guint8 *shadow = shadow_mask(width, height, cover_width, cover_height, pad, corner, size, scale);
+    guint8 *coverage = g_malloc(width);
+    guint8 *alpha = g_malloc(width);
+    const guint32 *recip = reciprocal_table();
+
+    const guchar *src_pixels = gdk_pixbuf_read_pixels(cover);
+    int src_stride = gdk_pixbuf_get_rowstride(cover);
+    int channels = gdk_pixbuf_get_n_channels(cover);
+    gboolean src_alpha = gdk_pixbuf_get_has_alpha(cover);
+    guchar *dst_pixels = gdk_pixbuf_get_pixels(baked);
+    int dst_stride = gdk_pixbuf_get_rowstride(baked);
+
+    for (int y = 0; y < height; y++) {
+        int iy = y - pad;
+        const guchar *src = iy >= 0 && iy < cover_height ? src_pixels + (gsize)iy * src_stride : NULL;
+
+        memset(coverage, 0, width);
+        if (src) {
+            rounded_row(coverage + pad, iy, cover_width, cover_height, corner, size);
+            if (src_alpha) {
+                for (int x = 0; x < cover_width; x++) {
+                    coverage[pad + x] = (guint8)((coverage[pad + x] * src[x * channels + 3] + 127) / 255);
+                }
+            }
+        }
+        composite_alpha(coverage, shadow + (gsize)y * width, alpha, width);
+
+        // Una rama por tramo, no por pixel: sombra a los lados, bordes antialiasados por
+        // composite_color y el interior opaco copiado. Sin alfa propio la cobertura solo
+        // es parcial en las filas de las esquinas, en sus size primeros y últimos pixeles
+        guchar *dst = dst_pixels + (gsize)y * dst_stride;
+        if (!src) {
+            shadow_only(alpha, dst, width);
+            continue;
+        }
+        shadow_only(alpha, dst, pad);
+        shadow_only(alpha + pad + cover_width, dst + (gsize)(pad + cover_width) * 4, width - pad - cover_width);
+
+        int edge = cover_width;
+        if (!src_alpha) {
+            int cy = iy < size ? iy : cover_height - 1 - iy;
+            edge = cy < size ? MIN(size, (cover_width + 1) / 2) : 0;
+        }
+        int right = MAX(edge, cover_width - edge);
+        guchar *out = dst + (gsize)pad * 4;
+        composite_color(src, channels, coverage + pad, alpha + pad, recip, out, edge);
+        copy_opaque(src + (gsize)edge * channels, channels, out + (gsize)edge * 4, right - edge);
+        composite_color(src + (gsize)right * channels, channels, coverage + pad + right, alpha + pad + right,
+                        recip, out + (gsize)right * 4, cover_width - right);
+    }
+
+    g_free(alpha);
+    g_free(coverage);
+    g_free(shadow);
+    g_free(corner);
+    return baked;
+}
@@ -0,0 +1,24 @@
+#ifndef TILE_BAKE_H
+#define TILE_BAKE_H
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include "tile_render.h"
+
+// Tiles "horneados" (--baked-tiles): las esquinas redondeadas y la sombra de .image-card
+// se componen en los píxeles del tile al decodificarlo, en los hilos de decodificación.
+// Cada frame dibuja entonces solo texturas, sin clips redondeados ni nodos de sombra.
+// La sombra ocupa el margen de .rounded, así que el tile horneado mide lo mismo que el
+// tile con su margin y el layout no cambia.
+#define TILE_BAKE_PADDING 8            // Margen lógico por lado (= margin de .rounded)
+#define TILE_BAKE_SHADOW_OFFSET 2      // box-shadow: 0 2px 8px rgba(0,0,0,0.2)
+#define TILE_BAKE_SHADOW_BLUR 8
+#define TILE_BAKE_SHADOW_ALPHA 51      // 0.2 × 255
+
+// Margen en píxeles de dispositivo para un factor de escala
+int tile_bake_padding(double scale);
+
+// Devuelve un pixbuf RGBA nuevo de (ancho + 2·padding) × (alto + 2·padding) con la
+// imagen recortada a esquinas redondeadas sobre su sombra. cover no se modifica
+GdkPixbuf *tile_bake(GdkPixbuf *cover, double scale);
+
+#endif // TILE_BAKE_H
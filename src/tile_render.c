@@ -0,0 +1,31 @@
+#include "tile_render.h"
+
+static const GdkRGBA tile_background = { 0x2c / 255.0f, 0x2c / 255.0f, 0x2c / 255.0f, 1.0f };
+static const GdkRGBA tile_shadow = { 0, 0, 0, 0.2f };
+static const GdkRGBA hover_shadow = { 0, 0, 0, 0.4f };
+
+void tile_render_append(GtkSnapshot *snapshot, GdkTexture *texture, const graphene_rect_t *rect,
+                        TileRenderFlags flags) {
+    GskRoundedRect outline;
+    gsk_rounded_rect_init_from_rect(&outline, rect, (flags & TILE_RENDER_ROUNDED) ? TILE_CORNER_RADIUS : 0);
+
+    // Equivalente a .image-card y .image-card:hover
+    if (flags & TILE_RENDER_HOVER) {
+        gtk_snapshot_append_outset_shadow(snapshot, &outline, &hover_shadow, 0, 12, 0, 24);
+    } else if (flags & TILE_RENDER_SHADOW) {
+        gtk_snapshot_append_outset_shadow(snapshot, &outline, &tile_shadow, 0, 2, 0, 8);
+    }
+
+    if (flags & TILE_RENDER_ROUNDED) {
+        gtk_snapshot_push_rounded_clip(snapshot, &outline);
+        gtk_snapshot_append_color(snapshot, &tile_background, rect);
+    } else if (!texture) {
+        gtk_snapshot_append_color(snapshot, &tile_background, rect);
+    }
+    if (texture) {
+        gtk_snapshot_append_texture(snapshot, texture, rect);
+    }
+    if (flags & TILE_RENDER_ROUNDED) {
+        gtk_snapshot_pop(snapshot);
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef TILE_RENDER_H
+#define TILE_RENDER_H
+
+#include <gtk/gtk.h>
+
+// Dibujo de un tile como render nodes, equivalente a .rounded + .image-card del CSS.
+// Lo usan el strip pre-compuesto y el benchmark de render (cada efecto se puede
+// desactivar para medir lo que cuesta).
+#define TILE_CORNER_RADIUS 16          // Igual que .rounded en el CSS
+
+typedef enum {
+    TILE_RENDER_SHADOW  = 1 << 0,      // box-shadow de .image-card
+    TILE_RENDER_ROUNDED = 1 << 1,      // border-radius + overflow: hidden
+    TILE_RENDER_HOVER   = 1 << 2,      // Sombra de .image-card:hover
+} TileRenderFlags;
+
+#define TILE_RENDER_CSS (TILE_RENDER_SHADOW | TILE_RENDER_ROUNDED)
+
+void tile_render_append(GtkSnapshot *snapshot, GdkTexture *texture, const graphene_rect_t *rect,
+                        TileRenderFlags flags);
+
+#endif // TILE_RENDER_H
@@ -0,0 +1,171 @@
+#include "trace.h"
+#include <string.h>
+#include <unistd.h>
+
+#define TRACE_CHUNK_EVENTS 1024
+
+typedef struct {
+    const char *name;
+    char *detail;
+    gint64 start;
+    gint64 duration;
+} TraceEvent;
+
+typedef struct TraceChunk {
+    struct TraceChunk *next;
+    int count;                 // Publicado con g_atomic_int_set tras escribir el evento
+    TraceEvent events[TRACE_CHUNK_EVENTS];
+} TraceChunk;
+
+// Solo el hilo dueño escribe en su buffer; el volcado lee hasta el último count publicado
+typedef struct TraceBuffer {
+    struct TraceBuffer *next;
+    int tid;
+    const char *thread_name;
+    TraceChunk *head;
+    TraceChunk *tail;
+} TraceBuffer;
+
+gboolean trace_enabled = FALSE;
+
+static struct {
+    char *path;
+    gint64 origin;
+    TraceBuffer *buffers;      // Lista enlazada; se inserta con compare-and-exchange
+    int next_tid;
+    GMutex write_lock;         // Solo serializa volcados entre sí
+} trace;
+
+static GPrivate local_buffer;
+
+static TraceBuffer *get_local_buffer(void) {
+    TraceBuffer *buffer = g_private_get(&local_buffer);
+    if (buffer) return buffer;
+
+    buffer = g_new0(TraceBuffer, 1);
+    buffer->tid = g_atomic_int_add(&trace.next_tid, 1) + 1;
+    buffer->head = buffer->tail = g_new0(TraceChunk, 1);
+    g_private_set(&local_buffer, buffer);
+
+    TraceBuffer *head;
+    do {
+        head = g_atomic_pointer_get(&trace.buffers);
+        buffer->next = head;
+    } while (!g_atomic_pointer_compare_and_exchange(&trace.buffers, head, buffer));
+    return buffer;
+}
+
+void trace_enable(const char *path) {
+    if (trace_enabled || !path) return;
+
+    trace.path = g_strdup(path);
+    trace.origin = g_get_monotonic_time();
+    g_mutex_init(&trace.write_lock);
+    trace_enabled = TRUE;
+    trace_set_thread_name("main");
+}
+
+void trace_set_thread_name(const char *name) {
+    if (!trace_enabled) return;
+
+    TraceBuffer *buffer = get_local_buffer();
+    if (!buffer->thread_name) buffer->thread_name = name;
+}
+
+void trace_record(const char *name, gint64 start_us, const char *detail) {
+    if (!trace_enabled) return;
+
+    gint64 now = g_get_monotonic_time();
+    TraceBuffer *buffer = get_local_buffer();
+    TraceChunk *chunk = buffer->tail;
+    if (chunk->count == TRACE_CHUNK_EVENTS) {
+        TraceChunk *next = g_new0(TraceChunk, 1);
+        g_atomic_pointer_set(&chunk->next, next);
+        buffer->tail = chunk = next;
+    }
+
+    TraceEvent *event = &chunk->events[chunk->count];
+    event->name = name;
+    event->detail = g_strdup(detail);
+    event->start = start_us;
+    event->duration = now - start_us;
+    g_atomic_int_set(&chunk->count, chunk->count + 1);
+}
+
+void trace_append_json_string(GString *out, const char *text) {
+    g_string_append_c(out, '"');
+    for (const char *p = text; *p; p++) {
+        switch (*p) {
+        case '"': g_string_append(out, "\\\""); break;
+        case '\\': g_string_append(out, "\\\\"); break;
+        case '\n': g_string_append(out, "\\n"); break;
+        case '\t': g_string_append(out, "\\t"); break;
+        default:
+            if ((guchar)*p < 0x20) {
+                g_string_append_printf(out, "\\u%04x", (guchar)*p);
+            } else {
+                g_string_append_c(out, *p);
+            }
+        }
+    }
+    g_string_append_c(out, '"');
+}
+
+// Los spans en curso en otros hilos no se pierden: quedan para el siguiente volcado
+void trace_write(void) {
+    if (!trace_enabled) return;
+
+    g_mutex_lock(&trace.write_lock);
+    GString *json = g_string_new("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    int pid = getpid();
+    guint events = 0;
+    gboolean first = TRUE;
+
+    for (TraceBuffer *buffer = g_atomic_pointer_get(&trace.buffers); buffer; buffer = buffer->next) {
+        if (buffer->thread_name) {
+            g_string_append_printf(json, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                                   "\"args\":{\"name\":\"%s\"}}",
+                                   first ? "" : ",\n", pid, buffer->tid, buffer->thread_name);
+            first = FALSE;
+        }
+        for (TraceChunk *chunk = buffer->head; chunk; chunk = g_atomic_pointer_get(&chunk->next)) {
+            int count = g_atomic_int_get(&chunk->count);
+            for (int i = 0; i < count; i++) {
+                TraceEvent *event = &chunk->events[i];
+                g_string_append_printf(json, "%s{\"name\":\"%s\",\"cat\":\"wallpin\",\"ph\":\"X\","
+                                       "\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT
+                                       ",\"pid\":%d,\"tid\":%d",
+                                       first ? "" : ",\n", event->name, event->start - trace.origin,
+                                       event->duration, pid, buffer->tid);
+                if (event->detail) {
+                    g_string_append(json, ",\"args\":{\"detail\":");
+                    trace_append_json_string(json, event->detail);
+                    g_string_append_c(json, '}');
+                }
+                g_string_append_c(json, '}');
+                first = FALSE;
+                events++;
+            }
+        }
+    }
+    g_string_append(json, "\n]}\n");
+
+    GError *error = NULL;
+    if (g_file_set_contents(trace.path, json->str, json->len, &error)) {
+        g_print("📝 Traza escrita en %s (%u spans)\n", trace.path, events);
+    } else {
+        g_warning("No se pudo escribir la traza %s: %s", trace.path, error->message);
+        g_clear_error(&error);
+    }
+    g_string_free(json, TRUE);
+    g_mutex_unlock(&trace.write_lock);
+}
+
+// Escribe la traza final y deja de grabar (más spans ya no se guardan). Los buffers no se liberan: otros hilos (pools ya detenidos
+// o no) pueden conservar el puntero en su GPrivate hasta que termina el proceso
+void trace_shutdown(void) {
+    if (!trace_enabled) return;
+
+    trace_write();
+    trace_enabled = FALSE;
+}
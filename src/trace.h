@@ -0,0 +1,28 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <glib.h>
+
+// Trazas de arranque en formato Chrome trace (chrome://tracing, ui.perfetto.dev).
+// Cada hilo escribe sus spans en su propio buffer, sin locks; el volcado los recorre
+// todos. Desactivada por defecto (--trace <archivo>).
+extern gboolean trace_enabled;
+
+// Único coste en el camino caliente cuando está desactivada: una rama
+#define TRACE_BEGIN(start) \
+    gint64 start = G_UNLIKELY(trace_enabled) ? g_get_monotonic_time() : 0
+#define TRACE_END(start, name, detail) \
+    do { if (G_UNLIKELY(trace_enabled)) trace_record((name), (start), (detail)); } while (0)
+
+void trace_enable(const char *path);
+// Nombre del hilo actual en la traza (cadena estática; solo cuenta la primera vez)
+void trace_set_thread_name(const char *name);
+// Span desde start_us (g_get_monotonic_time) hasta ahora; name debe ser estático, detail se copia
+void trace_record(const char *name, gint64 start_us, const char *detail);
+void trace_write(void);
+// text como cadena JSON entre comillas, con el escapado necesario (también lo usa el benchmark)
+void trace_append_json_string(GString *out, const char *text);
+// Último volcado; a partir de aquí TRACE_* no graba nada
+void trace_shutdown(void);
+
+#endif // TRACE_H
@@ -33,6 +33,22 @@ void apply_css_to_window(GtkWidget *window) {
         "    box-shadow: 0 12px 24px rgba(0,0,0,0.4);"
         "    z-index: 10;"
         "}"
+        // --baked-tiles: esquinas y sombra vienen en la textura (ver tile_bake.h); el
+        // margen de .rounded ya está dentro del tile y el hover solo lo desplaza
+        ".baked {"
+        "    margin: 0;"
+        "    border: none;"
+        "    border-radius: 0;"
+        "    background: none;"
+        "    box-shadow: none;"
+        "}"
+        ".baked:hover {"
+        "    box-shadow: none;"
+        "}"
+        ".baked picture {"
+        "    background: none;"
+        "    border-radius: 0;"
+        "}"
         ".duplicate-separator {"
         "    background-color: transparent;"
         "    min-height: 1px;"